@@ -7,12 +7,36 @@
 extern "C" {
 #endif
 
+typedef struct
+{
+	unsigned long long timestamp; // Nanoseconds on the seconds_monotonic() clock
+	unsigned long seq; // Counts reads, so each sample has its own
+	short x;
+	short y;
+	short z;
+} accel_sample;
+
 EXPORT_SYM short accel_x();
 EXPORT_SYM short accel_y();
 EXPORT_SYM short accel_z();
 
 EXPORT_SYM int accel_calibrate();
 
+// Reads all three axes from the same conversion. Returns 1 on success.
+EXPORT_SYM int accel_read(accel_sample *sample);
+
+// Starts sampling in the background at hz into a buffer holding
+// capacity samples. Returns 1 on success.
+EXPORT_SYM int accel_sampler_start(int hz, int capacity);
+EXPORT_SYM void accel_sampler_stop();
+
+// Moves up to max of the oldest buffered samples into samples.
+// Returns the number copied.
+EXPORT_SYM int accel_read_block(accel_sample *samples, int max);
+
+// Returns the number of samples lost because the buffer was full.
+EXPORT_SYM unsigned long accel_sampler_dropped();
+
 #ifdef __cplusplus
 }
 #endif
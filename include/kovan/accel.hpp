@@ -3,6 +3,12 @@
 
 #include "export.h"
 #include "sensor.hpp"
+#include "accel.h"
+
+#include <cstddef>
+
+// The accelerometer's output data rate in measurement mode
+#define ACCEL_DEFAULT_RATE 125
 
 class Acceleration
 {
@@ -11,6 +17,19 @@ public:
 	static short y();
 	static short z();
 	static bool calibrate();
+	
+	// Reads all three axes in one bus transaction
+	static bool read(accel_sample &sample);
+	
+	// Samples in the background on the shared PeriodicExecutor
+	static bool startSampler(const unsigned hz = ACCEL_DEFAULT_RATE, const size_t capacity = 256);
+	static void stopSampler();
+	static bool isSampling();
+	
+	// Pops up to max of the oldest buffered samples
+	static size_t readBlock(accel_sample *const samples, const size_t max);
+	static unsigned long dropped();
+	
 private:
 	static void setupI2C();
 	static bool s_setup;
@@ -20,18 +39,21 @@ class AccelX : public Sensor<short>
 {
 public:
 	virtual short value() const;
+	virtual Sample<short> sample() const;
 };
 
 class AccelY : public Sensor<short>
 {
 public:
 	virtual short value() const;
+	virtual Sample<short> sample() const;
 };
 
 class AccelZ : public Sensor<short>
 {
 public:
 	virtual short value() const;
+	virtual Sample<short> sample() const;
 };
 
 #endif
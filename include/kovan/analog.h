@@ -22,6 +22,7 @@
 #define _ANALOG_H_
 
 #include "export.h"
+#include "sensor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +46,16 @@ EXPORT_SYM int analog10(int port);
  */
 EXPORT_SYM int analog(int port);
 
+/*!
+ * Gets the 10-bit analog value of a port along with when it was read.
+ * \param[in] port A value between 0 and 7 specifying the sensor to read from.
+ * \param[out] sample Set to the value, timestamp and refresh sequence number.
+ * \return 1 on success, 0 on failure.
+ * \see analog10
+ * \ingroup sensor
+ */
+EXPORT_SYM int analog10_sample(int port, sensor_sample *sample);
+
 EXPORT_SYM void set_analog_pullup(int port, int pullup);
 EXPORT_SYM int get_analog_pullup(int port);
 
@@ -48,6 +48,11 @@ public:
 	
 	virtual unsigned short value() const;
 	
+	/*!
+	 * \return value() stamped with the Kovan state it was read from
+	 */
+	virtual Sample<unsigned short> sample() const;
+	
 	virtual void setPullup(bool pullup);
 	virtual bool pullup() const;
 	
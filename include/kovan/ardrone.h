@@ -21,6 +21,8 @@
 #ifndef _ARDRONE_H_
 #define _ARDRONE_H_
 
+#include "camera.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -200,6 +202,15 @@ void drone_set_ultrasound_channel(int channel);
  */
 void drone_set_detection(int detectType);
 
+/**
+ * \brief Opens the drone's video feed as a camera handle, so it can be updated
+ * alongside USB cameras with camera_update_all()
+ * \param which 0 for the front facing camera, 1 for the downward facing camera
+ * \pre drone_connect must have been previously called to establish a connection to the drone.
+ * \return A handle to release with camera_close_handle(). Its data is 0 on failure.
+ */
+EXPORT_SYM camera drone_camera_open_handle(int which);
+
 #ifdef __cplusplus
 }
 #endif
@@ -68,6 +68,7 @@ private:
 	ARDrone();
 	
 	DroneController *m_controller;
+	bool m_controllerRunning;
 	Camera m_activeCamera;
 };
 
@@ -42,6 +42,19 @@ EXPORT_SYM int battery_charging();
  */
 EXPORT_SYM float power_level();
 
+/*!
+ * Scales motor PWM so motors keep the speed they had when compensation was turned
+ * on, even as the battery drains. The battery reading is filtered in the background
+ * from data the Kovan already sends, so this costs no extra communication.
+ * \param on 1 to turn compensation on, 0 to turn it off
+ */
+EXPORT_SYM void set_battery_compensation(int on);
+
+/*!
+ * \return The factor motor PWM is currently multiplied by, 1.0 when compensation is off
+ */
+EXPORT_SYM float get_battery_compensation();
+
 #ifdef __cplusplus
 }
 #endif
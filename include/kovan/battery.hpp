@@ -39,6 +39,19 @@ class EXPORT_SYM Battery
 public:
 	static bool isCharging();
 	static float powerLevel();
+	
+	/*!
+	 * Scales motor PWM so motors keep the speed they had when compensation was
+	 * turned on, even as the battery drains. The battery reading is filtered in
+	 * the background from data the Kovan already sends.
+	 */
+	static void setCompensation(const bool on);
+	static bool compensation();
+	
+	/*!
+	 * \return The factor motor PWM is currently multiplied by, 1.0 when compensation is off
+	 */
+	static float compensationFactor();
 };
 
 #endif
@@ -0,0 +1,95 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file board.h
+ * \brief Functions for driving several Kovans from one program
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup board Boards
+ */
+
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+	void *data;
+} board;
+
+/*!
+ * Connects to the Kovan daemon on another board. Each board has its own
+ * queue of writes and its own copy of the registers, separate from the
+ * local Kovan that the other functions use.
+ * \param address The board's address or name, optionally followed by ":port"
+ * \return A handle for the other board functions. Its data is 0 if the
+ * address can't be resolved or the board didn't respond.
+ * \ingroup board
+ */
+EXPORT_SYM board board_open(const char *address);
+
+/*!
+ * Disconnects from the board and frees the handle.
+ * \ingroup board
+ */
+EXPORT_SYM void board_close(board b);
+
+/*!
+ * Queues a register write. It is sent by the next board_publish() or boards_publish().
+ * \param reg A Kovan register number
+ * \param value The register's new value, 0 to 65535
+ * \ingroup board
+ */
+EXPORT_SYM void board_set_register(board b, int reg, int value);
+
+/*!
+ * \param reg A Kovan register number
+ * \return The register's value as of the last publish, or its last written value
+ * \ingroup board
+ */
+EXPORT_SYM int board_get_register(board b, int reg);
+
+/*!
+ * Sends the board's queued writes and waits for its registers.
+ * \return 1 on success, 0 if the board didn't respond
+ * \blocks
+ * \ingroup board
+ */
+EXPORT_SYM int board_publish(board b);
+
+/*!
+ * Publishes every open board at once. All packets are sent before any reply is
+ * awaited, so this takes about as long as publishing a single board.
+ * \return The number of boards that responded
+ * \blocks
+ * \ingroup board
+ */
+EXPORT_SYM int boards_publish();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -89,6 +89,18 @@ EXPORT_SYM void set_camera_height(int height);
  */
 EXPORT_SYM int camera_update();
 
+/**
+ * \return When the image from the last successful camera_update() was pulled.
+ * Nanoseconds on the seconds_monotonic() clock.
+ */
+EXPORT_SYM unsigned long long get_camera_frame_timestamp();
+
+/**
+ * \return The number of images camera_update() has pulled. Object results
+ * don't change until this does.
+ */
+EXPORT_SYM unsigned long get_camera_frame_seq();
+
 /**
  * \param p The point at which the pixel lies.
  * \return The rgb value of the pixel located at point p.
@@ -110,6 +122,26 @@ EXPORT_SYM int get_channel_count();
  */
 EXPORT_SYM int get_object_count(int channel);
 
+/**
+ * Counts the pixels inside rect that match a channel, without finding its
+ * objects. Each count takes constant time once the channel's mask has been
+ * summed, which happens on the first call after each camera_update().
+ * \param channel The channel to count. Only HSV channels have a mask.
+ * \param rect The region to count. Parts outside the image are ignored.
+ * \return The number of matching pixels, -1 if the channel doesn't exist or has no mask.
+ */
+EXPORT_SYM int get_channel_area_in_rect(int channel, rectangle rect);
+
+/**
+ * Splits the image into a columns x rows grid and gives the fraction,
+ * 0.0 to 1.0, of each cell that matches a channel. Useful for coarse
+ * checks of where a color is.
+ * \param cells Filled row by row with columns * rows values.
+ * \return 1 on success, 0 if the channel doesn't exist or has no mask.
+ * \see get_channel_area_in_rect
+ */
+EXPORT_SYM int get_channel_occupancy(int channel, int columns, int rows, double *cells);
+
 /**
  * \return The string data associated with a given object on a given channel.
  * If there is no data associated, 0 is returned.
@@ -165,6 +197,63 @@ EXPORT_SYM point2 get_object_center(int channel, int object);
  */
 EXPORT_SYM void camera_close();
 
+/**
+ * A camera opened with camera_open_handle(). Any number can be open at
+ * once, each with its own configuration and results.
+ */
+typedef struct
+{
+	void *data;
+} camera;
+
+/**
+ * Opens a camera separately from the default one.
+ * \param number The camera's id. 0 is the first camera, 1 is the second camera, etc.
+ * \param res The resolution the camera should operate at.
+ * \return A handle to release with camera_close_handle(). Its data is 0 on failure.
+ * \see camera_open_device
+ */
+EXPORT_SYM camera camera_open_handle(int number, enum Resolution res);
+
+/**
+ * Closes the camera and releases its handle.
+ */
+EXPORT_SYM void camera_close_handle(camera c);
+
+/**
+ * Pulls new images from several cameras and finds the objects on all of
+ * their channels. Each camera is captured and processed on the shared
+ * worker pool at the same time as the others, so updating n cameras takes
+ * about as long as updating the slowest one.
+ * \return The number of cameras updated successfully.
+ * \blocks
+ * \see task_set_worker_count
+ */
+EXPORT_SYM int camera_update_all(const camera *cameras, int count);
+
+/**
+ * These are the default camera's functions for a camera handle.
+ * camera_update_h() is camera_update_all() with one camera.
+ */
+EXPORT_SYM int camera_load_config_h(camera c, const char *name);
+EXPORT_SYM void set_camera_width_h(camera c, int width);
+EXPORT_SYM void set_camera_height_h(camera c, int height);
+EXPORT_SYM int camera_update_h(camera c);
+EXPORT_SYM unsigned long long get_camera_frame_timestamp_h(camera c);
+EXPORT_SYM unsigned long get_camera_frame_seq_h(camera c);
+EXPORT_SYM int get_channel_count_h(camera c);
+EXPORT_SYM int get_object_count_h(camera c, int channel);
+EXPORT_SYM int get_channel_area_in_rect_h(camera c, int channel, rectangle rect);
+EXPORT_SYM int get_channel_occupancy_h(camera c, int channel, int columns, int rows, double *cells);
+EXPORT_SYM const char *get_object_data_h(camera c, int channel, int object);
+EXPORT_SYM int get_code_num_h(camera c, int channel, int object);
+EXPORT_SYM int get_object_data_length_h(camera c, int channel, int object);
+EXPORT_SYM double get_object_confidence_h(camera c, int channel, int object);
+EXPORT_SYM int get_object_area_h(camera c, int channel, int object);
+EXPORT_SYM rectangle get_object_bbox_h(camera c, int channel, int object);
+EXPORT_SYM point2 get_object_centroid_h(camera c, int channel, int object);
+EXPORT_SYM point2 get_object_center_h(camera c, int channel, int object);
+
 #ifdef __cplusplus
 }
 #endif
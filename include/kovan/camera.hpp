@@ -88,9 +88,14 @@ namespace Camera
 		void setImage(const cv::Mat &image);
 		ObjectVector objects(const Config &config);
 		
+		// Sets mask to 255 where the image matches config and 0 elsewhere.
+		// Returns false if this type of channel has no mask.
+		bool mask(const Config &config, cv::Mat &mask);
+		
 	protected:
 		virtual void update(const cv::Mat &image) = 0;
 		virtual ObjectVector findObjects(const Config &config) = 0;
+		virtual bool findMask(const Config &config, cv::Mat &mask);
 		
 	private:
 		bool m_dirty;
@@ -128,6 +133,21 @@ namespace Camera
 		
 		const ObjectVector *objects() const;
 		
+		// The channel's mask for the current frame, or 0 if its type has
+		// none. Computed on first use each frame.
+		const cv::Mat *mask() const;
+		
+		// The number of pixels in rect that match this channel, in constant
+		// time from an integral image of the mask. The integral image is
+		// only computed, once per frame, when this or occupancy() is used.
+		// Returns -1 if the channel's type has no mask.
+		int areaInRect(const Rectangle<unsigned> &rect) const;
+		
+		// Splits the image into a columns x rows grid and sets cells, row
+		// by row, to the fraction of each cell that matches this channel
+		bool occupancy(const unsigned columns, const unsigned rows,
+			std::vector<double> &cells) const;
+		
 		Device *device() const;
 		
 		/**
@@ -141,6 +161,13 @@ namespace Camera
 		mutable ObjectVector m_objects;
 		ChannelImpl *m_impl;
 		mutable bool m_valid;
+		
+		bool updateIntegral() const;
+		
+		mutable cv::Mat m_mask;
+		mutable cv::Mat m_integral;
+		mutable bool m_maskValid;
+		mutable bool m_integralValid;
 	};
 	
 	typedef std::vector<Channel *> ChannelPtrVector;
@@ -200,6 +227,12 @@ namespace Camera
 		bool close();
 		bool update();
 		
+		// Pulls a new frame from every device and finds the objects in
+		// all of their channels, one ThreadPool task per device, so the
+		// devices capture and process concurrently. Returns the number
+		// of devices updated.
+		static unsigned updateAll(Device *const *const devices, const unsigned count);
+		
 		void setWidth(const unsigned width);
 		void setHeight(const unsigned height);
 		
@@ -208,6 +241,11 @@ namespace Camera
 		InputProvider *inputProvider() const;
 		const cv::Mat &rawImage() const;
 		
+		// The number of frames update() has pulled, and when the latest
+		// was pulled on the Time::now() clock
+		unsigned long frameSeq() const;
+		unsigned long long frameTimestamp() const;
+		
 		void setConfig(const Config &config);
 		const Config &config() const;
 		
@@ -217,12 +255,18 @@ namespace Camera
 	private:
 		void updateConfig();
 		
+		// The default configuration is read on first use rather than at
+		// construction, and not at all if setConfig comes first.
+		void loadDefaultConfig();
+		
 		InputProvider *const m_inputProvider;
+		bool m_configLoaded;
 		Config m_config;
 		ChannelPtrVector m_channels;
 		ChannelImplManager *m_channelImplManager;
 		cv::Mat m_image;
-		timeval m_lastUpdate;
+		unsigned long m_frameSeq;
+		unsigned long long m_frameTimestamp;
 	};
 }
 
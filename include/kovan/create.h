@@ -30,6 +30,7 @@
 #define _CREATE_H_
 
 #include "export.h"
+#include "sensor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -88,6 +89,15 @@ EXPORT_SYM int get_create_total_angle();
 EXPORT_SYM void set_create_total_angle(int angle);
 EXPORT_SYM int get_create_distance();
 EXPORT_SYM void set_create_distance(int dist);
+
+/*!
+ * Like get_create_total_angle() and get_create_distance(), but also give
+ * when the sensor packet they come from was read, and how many times it
+ * has been read. Return 1 on success.
+ */
+EXPORT_SYM int get_create_total_angle_sample(sensor_sample *sample);
+EXPORT_SYM int get_create_distance_sample(sensor_sample *sample);
+
 EXPORT_SYM int get_create_battery_charging_state();
 EXPORT_SYM int get_create_battery_voltage();
 EXPORT_SYM int get_create_battery_current();
@@ -37,7 +37,6 @@
 #include <cstdio>
 #include <cstdlib>
 #include <vector>
-#include <sys/time.h>
 
 #ifndef WIN32
 #include <termios.h>
@@ -47,6 +46,7 @@ typedef unsigned int speed_t;
 #endif
 
 #include "sensor.hpp"
+#include "util.hpp"
 #include "button.hpp"
 #include "export.h"
 
@@ -84,7 +84,7 @@ private:
  */
 struct CreateState
 {
-	timeval timestamp;
+	unsigned long long timestamp; //!< Monotonic nanoseconds, see Time::now()
 
 	int distance;
 	int angle;
@@ -394,6 +394,18 @@ public:
 	const CreatePackets::_4 *sensorPacket4();
 	const CreatePackets::_5 *sensorPacket5();
 	
+	/*!
+	 * \param packet A sensor packet number, 1 through 5
+	 * \return When the packet was last read from the Create. Monotonic nanoseconds, see Time::now()
+	 */
+	unsigned long long packetTimestamp(const unsigned char packet) const;
+	
+	/*!
+	 * \param packet A sensor packet number, 1 through 5
+	 * \return The number of times the packet has been read from the Create
+	 */
+	unsigned long packetSeq(const unsigned char packet) const;
+	
 	inline void beginAtomicOperation()
 	{
 	#ifndef WIN32
@@ -426,29 +438,9 @@ private:
 		if(ptr) delete ptr;
 	}
 	
-	inline timeval timeOfDay() const
-	{
-		timeval ret;
-		gettimeofday(&ret, NULL);
-		return ret;
-	}
-	
-	inline bool hasRequiredTimePassed(const timeval& timestamp) const
-	{
-	#ifndef WIN32
-		timeval current = timeOfDay();
-		timeval result;
-		timersub(&current, &timestamp, &result);
-		const long msecs = result.tv_sec * 1000 + result.tv_usec / 1000;
-		return msecs > m_refreshRate;
-	#else
-		#warning Create library not yet implemented for Windows
-	#endif
-	}
-
-	inline double timevalToFloat(const timeval& tv)
+	inline bool hasRequiredTimePassed(const unsigned long long timestamp) const
 	{
-		return ((double)tv.tv_sec) + ((double)tv.tv_usec / 1000000.0);
+		return Time::msecsSince(timestamp) > m_refreshRate;
 	}
 
 	inline float deg2rad(const float& deg)
@@ -473,7 +465,8 @@ private:
 	CreatePackets::_3 m_3;
 	CreatePackets::_4 m_4;
 	CreatePackets::_5 m_5;
-	timeval timestamps[5];
+	unsigned long long timestamps[5];
+	unsigned long m_packetSeqs[5];
 
 
 	// These are all marked mutable because they
@@ -30,6 +30,7 @@
 #define _DIGITAL_H_
 
 #include "export.h"
+#include "sensor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +54,14 @@ EXPORT_SYM void set_digital_value(int port, int value);
  */
 EXPORT_SYM int get_digital_value(int port);
 
+/*!
+ * Gets the current value of the digital port along with when it was read.
+ * \param[out] sample Set to the value, timestamp and refresh sequence number.
+ * \return 1 on success, 0 on failure.
+ * \see get_digital_value
+ */
+EXPORT_SYM int get_digital_value_sample(int port, sensor_sample *sample);
+
 /*!
  * Sets the digital mode.
  * \param port The port to modify.
@@ -50,6 +50,11 @@ public:
 	 */
 	virtual bool value() const;
 	
+	/*!
+	 * \return value() stamped with the Kovan state it was read from
+	 */
+	virtual Sample<bool> sample() const;
+	
 	virtual void setOutput(const bool& output);
 	virtual bool isOutput() const;
 	
@@ -0,0 +1,130 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file drive.h
+ * \brief Functions for driving a two-wheeled robot by distance and angle
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup drive Drive
+ */
+
+#ifndef _DRIVE_H_
+#define _DRIVE_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DRIVE_RUNNING 0
+#define DRIVE_DONE 1
+#define DRIVE_TIMED_OUT 2
+#define DRIVE_CANCELLED 3
+#define DRIVE_STALLED 4
+#define DRIVE_UNSETTLED 5
+
+typedef struct
+{
+	void *data;
+} drive_move;
+
+/*!
+ * Describes the robot. Must be called before any other drive function.
+ * Positive motor commands must move each wheel forward.
+ * Calling it again cancels the current move; existing handles stay valid.
+ * \param left_motor The left wheel's motor port
+ * \param right_motor The right wheel's motor port
+ * \param wheel_diameter The wheels' diameter in mm
+ * \param wheel_base The distance between the wheels' centers in mm
+ * \param ticks_per_revolution Back EMF ticks per wheel revolution
+ * \ingroup drive
+ */
+EXPORT_SYM void drive_set_geometry(int left_motor, int right_motor, double wheel_diameter,
+	double wheel_base, double ticks_per_revolution);
+
+/*!
+ * \param max_speed The fastest any wheel may go, in mm/s
+ * \param acceleration The largest change in wheel speed, in mm/s^2
+ * \ingroup drive
+ */
+EXPORT_SYM void drive_set_limits(double max_speed, double acceleration);
+
+/*!
+ * Starts driving straight and returns right away. Negative distances drive backward.
+ * Starting a move cancels the previous one.
+ * \param distance The distance in mm
+ * \param speed The cruising speed in mm/s
+ * \param deadline_ms Milliseconds until the move gives up, or 0 for none
+ * \return A handle for drive_status(), drive_wait() and drive_free()
+ * \ingroup drive
+ */
+EXPORT_SYM drive_move drive_distance(double distance, double speed, int deadline_ms);
+
+/*!
+ * Starts driving along a circle. A positive radius curves left and a negative one right.
+ * \param radius The radius of the robot's center's path in mm
+ * \param degrees How far around the circle to go. Negative drives backward.
+ * \param speed The outer wheel's cruising speed in mm/s
+ * \param deadline_ms Milliseconds until the move gives up, or 0 for none
+ * \ingroup drive
+ */
+EXPORT_SYM drive_move drive_arc(double radius, double degrees, double speed, int deadline_ms);
+
+/*!
+ * Starts turning in place. Positive angles turn left.
+ * \param speed The wheels' cruising speed in mm/s
+ * \param deadline_ms Milliseconds until the move gives up, or 0 for none
+ * \ingroup drive
+ */
+EXPORT_SYM drive_move turn_angle(double degrees, double speed, int deadline_ms);
+
+/*!
+ * \return DRIVE_RUNNING, DRIVE_DONE, DRIVE_TIMED_OUT, DRIVE_CANCELLED, DRIVE_STALLED
+ * or DRIVE_UNSETTLED
+ * \ingroup drive
+ */
+EXPORT_SYM int drive_status(drive_move move);
+
+/*!
+ * Waits until the move ends.
+ * \return The move's final status
+ * \blocks
+ * \ingroup drive
+ */
+EXPORT_SYM int drive_wait(drive_move move);
+
+/*!
+ * Frees the handle, cancelling the move if it is still running.
+ * \ingroup drive
+ */
+EXPORT_SYM void drive_free(drive_move move);
+
+/*!
+ * Cancels the current move and stops both wheels.
+ * \ingroup drive
+ */
+EXPORT_SYM void drive_stop();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file drive.hpp
+ * \brief Classes for driving a two-wheeled robot by distance and angle
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup drive Drive
+ */
+
+#ifndef _DRIVE_HPP_
+#define _DRIVE_HPP_
+
+#include "periodic.hpp"
+#include "thread.hpp"
+#include "port.hpp"
+#include "export.h"
+
+#include <vector>
+
+#define DRIVE_PERIOD 20000 // us
+
+class DriveController;
+
+/*!
+ * \struct DriveGeometry
+ * \brief Describes a differential drive robot
+ * \details Distances are in millimeters. Positive motor commands must move
+ * each wheel forward.
+ * \ingroup drive
+ */
+struct EXPORT_SYM DriveGeometry
+{
+	DriveGeometry();
+	
+	port_t leftMotor;
+	port_t rightMotor;
+	double wheelDiameter;
+	double wheelBase; //!< The distance between the wheels' centers
+	double ticksPerRevolution; //!< Back EMF ticks per wheel revolution
+};
+
+/*!
+ * \class DriveMove
+ * \brief A command given to a DriveController, and how it ended
+ * \ingroup drive
+ */
+class EXPORT_SYM DriveMove
+{
+public:
+	enum Status {
+		Running = 0,
+		Done,
+		TimedOut, //!< The deadline passed first
+		Cancelled, //!< Replaced by a newer move or stopped
+		Stalled, //!< A wheel stalled
+		Unsettled //!< The profile finished but a wheel never reached its target
+	};
+	
+	/*!
+	 * Cancels the move if it is still running.
+	 */
+	~DriveMove();
+	
+	Status status() const;
+	
+	/*!
+	 * Waits until the move ends.
+	 * \blocks
+	 */
+	Status wait() const;
+	
+private:
+	DriveMove(DriveController *const controller, const double left, const double right,
+		const double speed, const unsigned long deadline);
+	DriveMove(const DriveMove &rhs);
+	DriveMove &operator=(const DriveMove &rhs);
+	
+	friend class DriveController;
+	
+	DriveController *m_controller; // 0 once the controller is deleted
+	Status m_status;
+	double m_left; // mm
+	double m_right;
+	double m_speed;
+	unsigned long long m_deadline; // 0 for none
+	
+	double m_distance;
+	double m_velocity;
+	int m_leftStart;
+	int m_rightStart;
+	unsigned long long m_lastTick;
+	unsigned long long m_settleStart;
+};
+
+/*!
+ * \class DriveController
+ * \brief Drives a two-wheeled robot along straight lines, arcs and turns
+ * \details Moves run in the background on the periodic thread. Every
+ * period, both wheels follow a trapezoidal speed profile with the configured
+ * acceleration, corrected by their back EMF position, and both setpoints go
+ * out in a single packet. Starting a move cancels the previous one.
+ * \ingroup drive
+ */
+class EXPORT_SYM DriveController : public PeriodicTask
+{
+public:
+	DriveController(const DriveGeometry &geometry);
+	
+	/*!
+	 * Cancels the current move. Moves that haven't been deleted yet stay
+	 * valid and report Cancelled if they were still running.
+	 */
+	~DriveController();
+	
+	const DriveGeometry &geometry() const;
+	
+	/*!
+	 * \param maxSpeed The fastest any wheel may go, in mm/s
+	 * \param acceleration The largest change in wheel speed, in mm/s^2
+	 */
+	void setLimits(const double maxSpeed, const double acceleration);
+	
+	/*!
+	 * Drives straight. Negative distances drive backward.
+	 * \param speed The cruising speed in mm/s
+	 * \param deadline Milliseconds until the move gives up, or 0 for none
+	 * \return The move, which the caller must delete
+	 */
+	DriveMove *driveDistance(const double distance, const double speed, const unsigned long deadline = 0);
+	
+	/*!
+	 * Drives along a circle. A positive radius curves left and a negative one right.
+	 * \param radius The radius of the robot's center's path in mm
+	 * \param degrees How far around the circle to go. Negative drives backward.
+	 * \param speed The outer wheel's cruising speed in mm/s
+	 */
+	DriveMove *driveArc(const double radius, const double degrees, const double speed,
+		const unsigned long deadline = 0);
+	
+	/*!
+	 * Turns in place. Positive angles turn left.
+	 * \param speed The wheels' cruising speed in mm/s
+	 */
+	DriveMove *turnAngle(const double degrees, const double speed, const unsigned long deadline = 0);
+	
+	/*!
+	 * Cancels the current move and stops both wheels.
+	 */
+	void stop();
+	
+	virtual void run();
+	
+private:
+	friend class DriveMove;
+	
+	DriveMove *start(const double left, const double right, const double speed, const unsigned long deadline);
+	void finish(const DriveMove::Status status);
+	
+	// Steps move's profile to now and computes the wheel speeds in ticks/s
+	DriveMove::Status advance(DriveMove *const move, const unsigned long long now,
+		const int left, const int right, double &leftVelocity, double &rightVelocity);
+	
+	DriveGeometry m_geometry;
+	double m_maxSpeed;
+	double m_acceleration;
+	
+	mutable Mutex m_mutex;
+	mutable ConditionVariable m_condition;
+	DriveMove *m_move;
+	bool m_stopPending;
+	std::vector<DriveMove *> m_moves; // Every undeleted move
+	unsigned m_waiters;
+};
+
+#endif
@@ -0,0 +1,143 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file event_loop.hpp
+ * \brief Single-threaded dispatch of socket, timer and notifier events
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup event Event Loop
+ */
+
+#ifndef _EVENT_LOOP_HPP_
+#define _EVENT_LOOP_HPP_
+
+#include <map>
+
+#include "thread.hpp"
+#include "export.h"
+
+class EventLoop;
+class Socket;
+
+/*!
+ * \class EventHandler
+ * \brief Receives callbacks from an EventLoop
+ * \ingroup event
+ */
+class EXPORT_SYM EventHandler
+{
+public:
+	virtual ~EventHandler();
+	
+	/*!
+	 * Called on the loop's thread when fd is ready.
+	 * \param events A combination of EventLoop::Events
+	 */
+	virtual void event(EventLoop *const loop, const int fd, const unsigned events) = 0;
+};
+
+/*!
+ * \class EventLoop
+ * \brief Waits on many file descriptors at once and dispatches them to EventHandlers
+ * \details Sockets, timers and notifiers can be added and removed from any thread.
+ * Handlers always run on the thread calling run() or runOnce(), so a loop never
+ * sleeps between polls and idles without using CPU.
+ * \ingroup event
+ */
+class EXPORT_SYM EventLoop
+{
+public:
+	enum Events {
+		Readable = 0x1,
+		Writable = 0x2,
+		Hangup = 0x4
+	};
+	
+	EventLoop();
+	~EventLoop();
+	
+	bool isValid() const;
+	
+	/*!
+	 * Watches an existing file descriptor. The loop does not take ownership of it.
+	 * \param events A combination of Readable and Writable
+	 */
+	bool add(const int fd, const unsigned events, EventHandler *const handler);
+	bool add(const Socket &socket, EventHandler *const handler);
+	bool modify(const int fd, const unsigned events);
+	
+	/*!
+	 * Stops watching fd. Timers and notifiers created by the loop are also closed.
+	 */
+	bool remove(const int fd);
+	
+	/*!
+	 * Creates a timer that fires after intervalNs nanoseconds, and then every
+	 * intervalNs nanoseconds if repeat is true.
+	 * \return The timer's file descriptor, or -1 on failure
+	 */
+	int addTimer(const unsigned long long intervalNs, EventHandler *const handler, const bool repeat = true);
+	
+	/*!
+	 * Creates a notifier that other threads can trigger with notify().
+	 * \return The notifier's file descriptor, or -1 on failure
+	 */
+	int addNotifier(EventHandler *const handler);
+	bool notify(const int notifier);
+	
+	/*!
+	 * Waits up to timeoutMs milliseconds (forever if negative) and dispatches
+	 * whatever is ready.
+	 * \return The number of handlers called, or -1 on error
+	 */
+	int runOnce(const int timeoutMs = -1);
+	
+	/*!
+	 * Dispatches events until quit() is called.
+	 * \blocks
+	 */
+	void run();
+	
+	/*!
+	 * Makes run() return. Safe to call from any thread or handler.
+	 */
+	void quit();
+	
+private:
+	EventLoop(const EventLoop &rhs);
+	EventLoop &operator=(const EventLoop &rhs);
+	
+	struct Entry
+	{
+		EventHandler *handler;
+		bool owned;
+		bool counter;
+	};
+	
+	bool insert(const int fd, const unsigned events, const Entry &entry);
+	
+	int m_epoll;
+	int m_wake;
+	volatile bool m_quit;
+	Mutex m_mutex;
+	std::map<int, Entry> m_entries;
+};
+
+#endif
@@ -53,9 +53,80 @@ EXPORT_SYM void set_auto_publish(int on);
  */
 EXPORT_SYM void publish();
 
+/*!
+ * \brief Lets publish() return before the system has answered
+ * \details With a window of 1, the default, every publish waits for the system to
+ * acknowledge it. A larger window lets that many publishes be in flight at once, and
+ * publish() only waits when the window is full. Use this to stream writes faster than
+ * one per round trip.
+ * \param[in] window The number of publishes that may be in flight, 1 to 64
+ * \return 1 on success, 0 if window is out of range or the system is a kovan-bridge
+ * \note Sensor values may then be up to window publishes old. Call publish_and_wait()
+ * before a read that must be current.
+ * \ingroup general
+ */
+EXPORT_SYM int set_publish_window(int window);
+
+/*!
+ * \return The number of publishes that may be in flight at once
+ * \see set_publish_window
+ * \ingroup general
+ */
+EXPORT_SYM int get_publish_window();
+
+/*!
+ * \brief Publishes and waits until the system has acknowledged every publish
+ * \see set_publish_window
+ * \ingroup general
+ */
+EXPORT_SYM void publish_and_wait();
+
+/*!
+ * \brief Has the system push sensor changes instead of being asked for them
+ * \details Normally every sensor read asks the system for its state. After this call,
+ * the system sends updates on its own whenever a value changes, and reads are answered
+ * from the latest update. A program that isn't reading or writing generates no traffic.
+ * \param[in] max_rate The most updates per second, 1 to 1000
+ * \param[in] changes_only 1 to send updates only when something changed, 0 to send
+ * one at every opportunity
+ * \return 1 on success, 0 if the system didn't respond or is a kovan-bridge
+ * \ingroup general
+ */
+EXPORT_SYM int subscribe_state(int max_rate, int changes_only);
+
+/*!
+ * \brief Goes back to asking for the state on every read
+ * \see subscribe_state
+ * \ingroup general
+ */
+EXPORT_SYM void unsubscribe_state();
+
+/*!
+ * \brief Controls a Kovan over the network
+ * \details Sends hardware commands to kovan-bridge running on another board instead of
+ * the local one. The KOVAN_BRIDGE environment variable does the same.
+ * \param[in] host The board's address or name, optionally followed by ":port"
+ * \return 1 on success, 0 if host can't be resolved or hardware was already used
+ * \note Must be called before any other hardware function.
+ * \ingroup general
+ */
+EXPORT_SYM int set_kovan_bridge(const char *host);
+
+/*!
+ * \brief Stops motors and servos and puts every port into a safe state
+ * \details Like freeze_halt(), but also disables the servos.
+ * \ingroup general
+ */
 EXPORT_SYM void halt();
 
-void freeze_halt();
+/*!
+ * \brief Stops motors and the Create and puts every port into a safe state
+ * \details Digital ports become pulled-up inputs and analog pullups are enabled.
+ * Everything is sent immediately in a single packet, ahead of any unpublished
+ * commands.
+ * \ingroup general
+ */
+EXPORT_SYM void freeze_halt();
 
 #ifdef __cplusplus
 }
@@ -36,6 +36,7 @@
 #include "camera.h"
 #include "create.h"
 #include "analog.h"
+#include "sensor.h"
 #include "ir.h"
 #include "wifi.h"
 #include "draw.h"
@@ -47,6 +48,13 @@
 #include "datalog.h"
 #include "accel.h"
 #include "thread.h"
+#include "task.h"
+#include "trace.h"
+#include "metrics.h"
+#include "log.h"
+#include "periodic.h"
+#include "board.h"
+#include "drive.h"
 #include "botball.h"
 
 #endif
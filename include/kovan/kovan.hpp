@@ -41,13 +41,11 @@
 #define _KOVAN_HPP_
 
 #include "motors.hpp"
-#include "ardrone.hpp"
 #include "servo.hpp"
 #include "analog.hpp"
 #include "digital.hpp"
 #include "sensor_logic.hpp"
 #include "button.hpp"
-#include "camera.hpp"
 #include "ir.hpp"
 #include "wifi.hpp"
 #include "draw.hpp"
@@ -60,5 +58,18 @@
 #include "config.hpp"
 #include "accel.hpp"
 #include "thread.hpp"
+#include "task.hpp"
+#include "periodic.hpp"
+#include "drive.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "log.hpp"
+#include "build_config.h"
+
+// Built without OpenCV, libkovan only provides kovan-core
+#ifndef KOVAN_NO_VISION
+#include "camera.hpp"
+#include "ardrone.hpp"
+#endif
 
 #endif
@@ -0,0 +1,82 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file log.h
+ * \brief Functions for leveled logging written by a background thread
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup log Logging
+ */
+
+#ifndef _LOG_H_
+#define _LOG_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+/*!
+ * Sets the lowest level of message that is written.
+ * \ingroup log
+ */
+EXPORT_SYM void log_set_level(int level);
+EXPORT_SYM int log_get_level();
+
+/*!
+ * Appends log output to the file at path instead of stderr.
+ * \return 1 on success, 0 otherwise
+ * \ingroup log
+ */
+EXPORT_SYM int log_set_file(const char *path);
+
+/*!
+ * Queues a printf-style message. It is written by a background thread, so
+ * this returns without waiting on the console.
+ * \ingroup log
+ */
+EXPORT_SYM void log_message(int level, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+/*!
+ * Waits until every queued message has been written.
+ * \blocks
+ * \ingroup log
+ */
+EXPORT_SYM void log_flush();
+
+/*!
+ * \return The number of messages lost because the queue was full
+ * \ingroup log
+ */
+EXPORT_SYM unsigned long log_dropped();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
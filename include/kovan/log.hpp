@@ -0,0 +1,140 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file log.hpp
+ * \brief Leveled, rate-limited logging written by a background thread
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup log Logging
+ */
+
+#ifndef _LOG_HPP_
+#define _LOG_HPP_
+
+#include <cstdio>
+
+#include "export.h"
+
+#define LOG_RATE_LIMIT 10
+
+/*!
+ * \class Log
+ * \brief Asynchronous diagnostics output
+ * \details write() copies the formatted message into a fixed-size slot of a
+ * lock-free ring and returns. A background thread moves messages from the ring
+ * to the output, so slow consoles never stall the caller. If the ring is full,
+ * the message is counted as dropped instead of blocking.
+ * Messages below level() are discarded before they are formatted.
+ * \ingroup log
+ */
+class EXPORT_SYM Log
+{
+public:
+	enum Level {
+		Debug = 0,
+		Info,
+		Warning,
+		Error,
+		Off
+	};
+	
+	/*!
+	 * Sets the lowest level that is written. The default is Info, or the
+	 * value of the KOVAN_LOG_LEVEL environment variable (0 - 4).
+	 */
+	static void setLevel(const Level level);
+	static Level level();
+	
+	static bool isEnabled(const Level level)
+	{
+		return level >= s_level;
+	}
+	
+	/*!
+	 * Sends messages to fp (stderr by default). The caller keeps ownership.
+	 */
+	static void setOutput(FILE *const fp);
+	
+	/*!
+	 * Appends messages to the file at path.
+	 */
+	static bool setFile(const char *const path);
+	
+	/*!
+	 * \param where The origin of the message, such as __PRETTY_FUNCTION__.
+	 * Must stay valid until the message is written.
+	 */
+	static void write(const Level level, const char *const where, const char *const format, ...)
+		__attribute__((format(printf, 3, 4)));
+	
+	/*!
+	 * Waits until every queued message has been written.
+	 * \blocks
+	 */
+	static void flush();
+	
+	/*!
+	 * \return The number of messages lost because the ring was full
+	 */
+	static unsigned long dropped();
+	
+private:
+	static volatile int s_level;
+};
+
+/*!
+ * \class LogLimiter
+ * \brief Allows a burst of messages per second from one call site
+ * \ingroup log
+ */
+class EXPORT_SYM LogLimiter
+{
+public:
+	LogLimiter();
+	
+	/*!
+	 * \return true if another message may be written. The first message after a
+	 * quiet period reports how many were suppressed in between.
+	 */
+	bool allow(unsigned long &suppressed);
+	
+private:
+	unsigned long long m_windowStart;
+	unsigned long m_count;
+	unsigned long m_suppressed;
+};
+
+/*!
+ * Logs a message at level from the current function, limited to
+ * LOG_RATE_LIMIT messages per second from this line.
+ * \ingroup log
+ */
+#define KOVAN_LOG(level, format, ...) \
+	do { \
+		if(!Log::isEnabled(level)) break; \
+		static LogLimiter __kovanLogLimiter; \
+		unsigned long __kovanLogSuppressed = 0; \
+		if(!__kovanLogLimiter.allow(__kovanLogSuppressed)) break; \
+		if(__kovanLogSuppressed) Log::write(level, __PRETTY_FUNCTION__, \
+			"%lu similar messages suppressed", __kovanLogSuppressed); \
+		Log::write(level, __PRETTY_FUNCTION__, format, ##__VA_ARGS__); \
+	} while(0)
+
+#endif
@@ -0,0 +1,123 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file metrics.h
+ * \brief Functions for reading the library's counters, gauges and histograms
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup metrics Metrics
+ */
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRIC_COUNTER 0
+#define METRIC_GAUGE 1
+#define METRIC_HISTOGRAM 2
+
+/*!
+ * \return The number of registered metrics. Indices run from 0 to this minus one.
+ * \ingroup metrics
+ */
+EXPORT_SYM int metrics_count();
+
+/*!
+ * \return The name of metric i, or 0 if there is none
+ * \ingroup metrics
+ */
+EXPORT_SYM const char *metric_name(int i);
+
+/*!
+ * \return METRIC_COUNTER, METRIC_GAUGE or METRIC_HISTOGRAM, or -1 if there is no metric i
+ * \ingroup metrics
+ */
+EXPORT_SYM int metric_type(int i);
+
+/*!
+ * \return The value of a counter or gauge, or the number of observations in a histogram
+ * \ingroup metrics
+ */
+EXPORT_SYM double metric_value(int i);
+
+/*!
+ * \return The value of the named metric, or 0 if it does not exist
+ * \ingroup metrics
+ */
+EXPORT_SYM double metric_value_by_name(const char *name);
+
+/*!
+ * \return The number of buckets in histogram i, including the overflow bucket
+ * \ingroup metrics
+ */
+EXPORT_SYM int metric_histogram_buckets(int i);
+
+/*!
+ * \return The inclusive upper bound of a bucket in histogram i
+ * \ingroup metrics
+ */
+EXPORT_SYM double metric_histogram_bound(int i, int bucket);
+
+/*!
+ * \return The number of observations in a bucket of histogram i
+ * \ingroup metrics
+ */
+EXPORT_SYM unsigned long metric_histogram_count(int i, int bucket);
+
+/*!
+ * \return The sum of all observations in histogram i
+ * \ingroup metrics
+ */
+EXPORT_SYM double metric_histogram_sum(int i);
+
+/*!
+ * Writes every metric to path, or to stdout if path is 0 or "-".
+ * \param json 1 for a JSON object, 0 for "name value" lines
+ * \return 1 on success, 0 otherwise
+ * \ingroup metrics
+ */
+EXPORT_SYM int metrics_dump(const char *path, int json);
+
+/*!
+ * Rewrites path (or stdout) every msecs milliseconds in the background.
+ * \return 1 on success, 0 otherwise
+ * \ingroup metrics
+ */
+EXPORT_SYM int metrics_start_dump(const char *path, int json, unsigned long msecs);
+EXPORT_SYM void metrics_stop_dump();
+
+/*!
+ * Prints how long each subsystem took to initialize, in microseconds.
+ * Subsystems are initialized on first use, so only those used so far
+ * have a time.
+ * \ingroup metrics
+ */
+EXPORT_SYM void print_startup_profile();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,201 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file metrics.hpp
+ * \brief Named counters, gauges and histograms for reporting library health
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup metrics Metrics
+ */
+
+#ifndef _METRICS_HPP_
+#define _METRICS_HPP_
+
+#include <cstdio>
+#include <vector>
+
+#include "thread.hpp"
+#include "export.h"
+
+#define METRICS_MAX_BUCKETS 16
+
+class MetricsDumper;
+
+/*!
+ * \class Metric
+ * \brief A named value in the MetricsRegistry
+ * \details Metrics register themselves on construction and unregister on
+ * destruction, so they are usually declared as statics next to the code they
+ * measure. Updates are lock-free.
+ * \ingroup metrics
+ */
+class EXPORT_SYM Metric
+{
+public:
+	enum Type {
+		CounterType = 0,
+		GaugeType,
+		HistogramType
+	};
+	
+	virtual ~Metric();
+	
+	const char *name() const;
+	Type type() const;
+	
+	/*!
+	 * \return The counter or gauge value, or the number of histogram observations
+	 */
+	virtual double value() const = 0;
+	
+protected:
+	Metric(const char *const name, const Type type);
+	
+private:
+	Metric(const Metric &rhs);
+	Metric &operator=(const Metric &rhs);
+	
+	const char *m_name;
+	Type m_type;
+};
+
+/*!
+ * \class Counter
+ * \brief A monotonically increasing count
+ * \ingroup metrics
+ */
+class EXPORT_SYM Counter : public Metric
+{
+public:
+	Counter(const char *const name);
+	
+	void increment(const unsigned long long amount = 1)
+	{
+		__atomic_fetch_add(&m_count, amount, __ATOMIC_RELAXED);
+	}
+	
+	unsigned long long count() const;
+	double value() const;
+	
+private:
+	unsigned long long m_count;
+};
+
+/*!
+ * \class Gauge
+ * \brief A value that can go up and down
+ * \ingroup metrics
+ */
+class EXPORT_SYM Gauge : public Metric
+{
+public:
+	Gauge(const char *const name);
+	
+	void set(const double value);
+	double value() const;
+	
+private:
+	unsigned long long m_bits;
+};
+
+/*!
+ * \class Histogram
+ * \brief Counts observations in fixed buckets
+ * \ingroup metrics
+ */
+class EXPORT_SYM Histogram : public Metric
+{
+public:
+	/*!
+	 * \param bounds Ascending inclusive upper bounds of the buckets. An extra
+	 * bucket catches everything above the last bound.
+	 * \param count The number of bounds, at most METRICS_MAX_BUCKETS - 1
+	 */
+	Histogram(const char *const name, const double *const bounds, const unsigned count);
+	
+	void observe(const double value);
+	
+	unsigned buckets() const;
+	
+	/*!
+	 * \return The upper bound of bucket i. The last bucket's bound is infinite.
+	 */
+	double bound(const unsigned i) const;
+	unsigned long long bucketCount(const unsigned i) const;
+	
+	double sum() const;
+	double value() const;
+	
+private:
+	double m_bounds[METRICS_MAX_BUCKETS];
+	unsigned m_buckets;
+	unsigned long long m_counts[METRICS_MAX_BUCKETS];
+	unsigned long long m_total;
+	unsigned long long m_sumBits;
+};
+
+/*!
+ * \class MetricsRegistry
+ * \brief Every live Metric, for enumeration and reporting
+ * \ingroup metrics
+ */
+class EXPORT_SYM MetricsRegistry
+{
+public:
+	~MetricsRegistry();
+	
+	/*!
+	 * \return A snapshot of every registered metric
+	 */
+	std::vector<Metric *> metrics() const;
+	Metric *find(const char *const name) const;
+	
+	/*!
+	 * Writes every metric as "name value" lines, or as one JSON object.
+	 * \param prefix If not 0, only metrics whose names start with prefix
+	 */
+	void dump(FILE *const fp, const bool json, const char *const prefix = 0) const;
+	bool dump(const char *const path, const bool json) const;
+	
+	/*!
+	 * Rewrites path every msecs milliseconds on the shared PeriodicExecutor.
+	 * A path of 0 or "-" writes to stdout instead.
+	 */
+	bool startDumping(const char *const path, const bool json, const unsigned long msecs);
+	void stopDumping();
+	
+	static MetricsRegistry *instance();
+	
+private:
+	MetricsRegistry();
+	MetricsRegistry(const MetricsRegistry &rhs);
+	MetricsRegistry &operator=(const MetricsRegistry &rhs);
+	
+	friend class Metric;
+	
+	void add(Metric *const metric);
+	void remove(Metric *const metric);
+	
+	std::vector<Metric *> m_metrics;
+	mutable Mutex m_mutex;
+	MetricsDumper *m_dumper;
+};
+
+#endif
@@ -30,6 +30,7 @@
 #define _MOTORS_H_
 
 #include "export.h"
+#include "sensor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,14 @@ extern "C" {
  */
 int get_motor_position_counter(int motor);
 
+/*!
+ * Gets a motor's position counter along with when it was read.
+ * \param sample Set to the value, timestamp and refresh sequence number.
+ * \return 1 on success, 0 on failure.
+ * \ingroup motor
+ */
+int get_motor_position_counter_sample(int motor, sensor_sample *sample);
+
 /*!
  * \ingroup motor
  */
@@ -93,6 +102,8 @@ int freeze(int motor);
 int get_motor_done(int motor);
 
 /*!
+ * Waits until the motor has reached its goal position, or until it stalls.
+ * \see get_motor_stalled
  * \ingroup motor
  */
 void block_motor_done(int motor);
@@ -103,6 +114,29 @@ void block_motor_done(int motor);
  */
 void bmd(int motor);
 
+/*!
+ * A motor is stalled when it is told to move but its position counter has barely
+ * changed for the stall time. Stalled motors are turned off, unless that was
+ * disabled with set_motor_stall_stop().
+ * \return 1 if the motor stalled since it was last commanded, 0 otherwise
+ * \see set_motor_stall_time
+ * \ingroup motor
+ */
+int get_motor_stalled(int motor);
+
+/*!
+ * Sets how long a motor must be stuck before it counts as stalled.
+ * \param msecs The stall time in milliseconds, 500 by default. 0 disables stall detection.
+ * \ingroup motor
+ */
+void set_motor_stall_time(int motor, int msecs);
+
+/*!
+ * \param on 1 to turn stalled motors off (the default), 0 to only flag them
+ * \ingroup motor
+ */
+void set_motor_stall_stop(int on);
+
 /*!
  * \ingroup motor
  */
@@ -148,6 +182,8 @@ void alloff();
 
 /*!
  * Turns all motors off.
+ * \details The stop is sent immediately in a single packet, ahead of any
+ * unpublished commands, even when automatic publishing is off.
  * \ingroup motor
  */
 void ao();
@@ -68,9 +68,15 @@ public:
 	/*!
 	 * Waits until the motor has reached its target position.
 	 * \see getMotorDone
-	 * \blocksuntil the motor has reached its target position.
+	 * \blocksuntil the motor has reached its target position or stalled.
 	 */
 	void blockMotorDone() const;
+	
+	/*!
+	 * \return true if the motor stalled since it was last commanded
+	 * \see get_motor_stalled
+	 */
+	bool isStalled() const;
 
 	/*!
 	 * Move the motor forward at full speed using PWM control.
@@ -117,6 +123,7 @@ class EXPORT_SYM BackEMF : public Sensor<int>
 public:
 	BackEMF(const unsigned char& port);
 	virtual int value() const;
+	virtual Sample<int> sample() const;
 	unsigned char port() const;
 	
 private:
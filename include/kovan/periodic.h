@@ -0,0 +1,110 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file periodic.h
+ * \brief Functions for running code at a fixed rate without drift
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup periodic Periodic Tasks
+ */
+
+#ifndef _PERIODIC_H_
+#define _PERIODIC_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+	void *data;
+} periodic;
+
+typedef void (*periodic_function)();
+
+/*!
+ * Calls func every msecs milliseconds on the shared periodic thread.
+ * Deadlines are absolute, so time spent inside func does not cause drift.
+ * \param msecs The period in milliseconds
+ * \param func The function to call
+ * \return A handle for periodic_stop and the statistics functions
+ * \ingroup periodic
+ */
+EXPORT_SYM periodic run_every(unsigned long msecs, periodic_function func);
+
+/*!
+ * Like run_every, but the period is given in microseconds.
+ * \ingroup periodic
+ */
+EXPORT_SYM periodic run_every_us(unsigned long usecs, periodic_function func);
+
+/*!
+ * Stops calling the function and frees the handle. It may be called from
+ * inside the function itself.
+ * \blocks
+ * \ingroup periodic
+ */
+EXPORT_SYM void periodic_stop(periodic p);
+
+/*!
+ * \return The number of times the function has been called
+ * \ingroup periodic
+ */
+EXPORT_SYM unsigned long periodic_runs(periodic p);
+
+/*!
+ * \return The number of periods that were skipped because the function was still running
+ * \ingroup periodic
+ */
+EXPORT_SYM unsigned long periodic_overruns(periodic p);
+
+/*!
+ * \return The largest delay between a deadline and the call, in milliseconds
+ * \ingroup periodic
+ */
+EXPORT_SYM double periodic_max_latency(periodic p);
+
+/*!
+ * \return The mean delay between a deadline and the call, in milliseconds
+ * \ingroup periodic
+ */
+EXPORT_SYM double periodic_mean_latency(periodic p);
+
+/*!
+ * Prints the run count, overruns and the latency histogram.
+ * \ingroup periodic
+ */
+EXPORT_SYM void periodic_print_stats(periodic p);
+
+/*!
+ * Sets the scheduling policy and priority of the shared periodic thread.
+ * \param policy One of THREAD_POLICY_DEFAULT, THREAD_POLICY_FIFO or THREAD_POLICY_RR
+ * \return 1 on success, 0 otherwise
+ * \ingroup periodic
+ */
+EXPORT_SYM int periodic_set_priority(int policy, int priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,176 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file periodic.hpp
+ * \brief Classes for running code at a fixed rate without drift
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup periodic Periodic Tasks
+ */
+
+#ifndef _PERIODIC_HPP_
+#define _PERIODIC_HPP_
+
+#include <vector>
+
+#include "thread.hpp"
+#include "export.h"
+
+#define PERIODIC_HISTOGRAM_BUCKETS 8
+
+class PeriodicExecutor;
+
+/*!
+ * \struct PeriodicStats
+ * \brief Timing statistics for a PeriodicTask
+ * \details Latency is the time between a task's deadline and the moment
+ * it actually started running. histogram[i] counts runs whose latency was
+ * below PeriodicStats::bucketLimit(i).
+ * \ingroup periodic
+ */
+struct EXPORT_SYM PeriodicStats
+{
+	PeriodicStats();
+	
+	unsigned long runs;
+	unsigned long overruns;
+	unsigned long long maxLatency;
+	unsigned long long totalLatency;
+	unsigned long histogram[PERIODIC_HISTOGRAM_BUCKETS];
+	
+	double meanLatency() const;
+	
+	/*!
+	 * \return The exclusive upper bound of histogram bucket i in nanoseconds.
+	 * The last bucket is unbounded.
+	 */
+	static unsigned long long bucketLimit(const unsigned i);
+};
+
+/*!
+ * \class PeriodicTask
+ * \brief Code to be run at a fixed rate by a PeriodicExecutor
+ * \warning A scheduled subclass must call PeriodicExecutor::remove from its own
+ * destructor. ~PeriodicTask runs after the subclass is destroyed, while the
+ * executor could still be calling run().
+ * \ingroup periodic
+ */
+class EXPORT_SYM PeriodicTask
+{
+public:
+	PeriodicTask();
+	virtual ~PeriodicTask();
+	
+	virtual void run() = 0;
+	
+	/*!
+	 * \return The period in microseconds, or 0 if the task is not scheduled.
+	 */
+	unsigned long period() const;
+	
+	/*!
+	 * \return A snapshot of this task's timing statistics.
+	 */
+	PeriodicStats stats() const;
+	void resetStats();
+	
+private:
+	PeriodicTask(const PeriodicTask &rhs);
+	PeriodicTask &operator=(const PeriodicTask &rhs);
+	
+	friend class PeriodicExecutor;
+	
+	PeriodicExecutor *m_executor;
+	unsigned long long m_period;
+	unsigned long long m_deadline;
+	bool m_removed;
+	bool m_dispose;
+	PeriodicStats m_stats;
+};
+
+/*!
+ * \class PeriodicExecutor
+ * \brief Runs PeriodicTasks on a dedicated thread against absolute deadlines
+ * \details Every task's next deadline is its previous deadline plus its period,
+ * so the time spent in run() never accumulates as drift. A task that is still
+ * running when one or more of its deadlines pass skips those periods, and each
+ * one is counted as an overrun.
+ * The executor is a Thread, so Thread::setPriority can be used to give it
+ * real-time priority.
+ * \ingroup periodic
+ */
+class EXPORT_SYM PeriodicExecutor : public Thread
+{
+public:
+	PeriodicExecutor();
+	~PeriodicExecutor();
+	
+	/*!
+	 * Schedules task every periodUs microseconds. The first run happens
+	 * one period from now. The executor thread is started if needed.
+	 * \return false if the task is already scheduled or periodUs is 0
+	 */
+	bool add(PeriodicTask *const task, const unsigned long periodUs);
+	
+	/*!
+	 * Unschedules task. If the task is running on another thread, this waits for it
+	 * to return. It is safe for a task to remove itself from inside run().
+	 * \blocks
+	 */
+	void remove(PeriodicTask *const task);
+	
+	/*!
+	 * Unschedules and deletes task. From inside task's own run(), the task is
+	 * deleted by the executor once run() returns.
+	 * \blocks
+	 */
+	void dispose(PeriodicTask *const task);
+	
+	/*!
+	 * Stops the executor thread. Scheduled tasks are kept.
+	 * \blocks
+	 */
+	void stop();
+	
+	virtual void run();
+	
+	static PeriodicExecutor *instance();
+	
+private:
+	PeriodicExecutor(const PeriodicExecutor &rhs);
+	PeriodicExecutor &operator=(const PeriodicExecutor &rhs);
+	
+	friend class PeriodicTask;
+	
+	void wake();
+	void finish(PeriodicTask *const task, const unsigned long long started,
+		const unsigned long long finished);
+	
+	std::vector<PeriodicTask *> m_tasks;
+	PeriodicTask *m_current;
+	mutable Mutex m_mutex;
+	ConditionVariable m_idle;
+	bool m_started;
+	volatile bool m_stop;
+	int m_timer;
+	int m_event;
+};
+
+#endif
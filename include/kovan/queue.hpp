@@ -0,0 +1,232 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file queue.hpp
+ * \brief Bounded lock-free queues for passing data between threads
+ * \copyright KISS Institute for Practical Robotics
+ */
+
+#ifndef _QUEUE_HPP_
+#define _QUEUE_HPP_
+
+#include <cstddef>
+
+#include "export.h"
+
+#define QUEUE_CACHE_LINE 64
+
+namespace Private
+{
+	inline size_t queueCapacity(const size_t requested)
+	{
+		size_t ret = 2;
+		while(ret < requested) ret <<= 1;
+		return ret;
+	}
+}
+
+/*!
+ * \class SpscQueue
+ * \brief A bounded, wait-free queue for exactly one producer and one consumer thread
+ * \details The capacity is rounded up to the next power of two.
+ * \tparam T The element type. Must be copyable.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+	SpscQueue(const size_t capacity)
+		: m_capacity(Private::queueCapacity(capacity)),
+		m_mask(m_capacity - 1),
+		m_buffer(new T[m_capacity]),
+		m_head(0),
+		m_tail(0)
+	{
+	}
+	
+	~SpscQueue()
+	{
+		delete[] m_buffer;
+	}
+	
+	/*!
+	 * Called by the producer.
+	 * \return false if the queue is full
+	 */
+	bool push(const T &value)
+	{
+		const size_t tail = m_tail;
+		if(tail - __atomic_load_n(&m_head, __ATOMIC_ACQUIRE) >= m_capacity) return false;
+		m_buffer[tail & m_mask] = value;
+		__atomic_store_n(&m_tail, tail + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+	
+	/*!
+	 * Called by the consumer.
+	 * \return false if the queue is empty
+	 */
+	bool pop(T &value)
+	{
+		const size_t head = m_head;
+		if(head == __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE)) return false;
+		value = m_buffer[head & m_mask];
+		__atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+	
+	size_t size() const
+	{
+		return __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+	}
+	
+	bool isEmpty() const
+	{
+		return size() == 0;
+	}
+	
+	size_t capacity() const
+	{
+		return m_capacity;
+	}
+	
+private:
+	SpscQueue(const SpscQueue &rhs);
+	SpscQueue &operator=(const SpscQueue &rhs);
+	
+	const size_t m_capacity;
+	const size_t m_mask;
+	T *const m_buffer;
+	
+	// Keep the consumer and producer indices on separate cache lines
+	char m_pad0[QUEUE_CACHE_LINE];
+	size_t m_head;
+	char m_pad1[QUEUE_CACHE_LINE];
+	size_t m_tail;
+	char m_pad2[QUEUE_CACHE_LINE];
+};
+
+/*!
+ * \class MpscQueue
+ * \brief A bounded, lock-free queue for any number of producers and one consumer thread
+ * \details Each slot carries a sequence number that tells producers and the consumer
+ * whose turn it is, so producers only contend on a single compare-and-swap.
+ * The capacity is rounded up to the next power of two.
+ * \tparam T The element type. Must be copyable.
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+	MpscQueue(const size_t capacity)
+		: m_capacity(Private::queueCapacity(capacity)),
+		m_mask(m_capacity - 1),
+		m_cells(new Cell[m_capacity]),
+		m_head(0),
+		m_tail(0)
+	{
+		for(size_t i = 0; i < m_capacity; ++i) m_cells[i].sequence = i;
+	}
+	
+	~MpscQueue()
+	{
+		delete[] m_cells;
+	}
+	
+	/*!
+	 * May be called by any thread.
+	 * \return false if the queue is full
+	 */
+	bool push(const T &value)
+	{
+		size_t tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+		Cell *cell = 0;
+		for(;;) {
+			cell = &m_cells[tail & m_mask];
+			const size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+			const long diff = (long)sequence - (long)tail;
+			if(diff == 0) {
+				if(__atomic_compare_exchange_n(&m_tail, &tail, tail + 1, true,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+			} else if(diff < 0) return false;
+			else tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+		}
+		
+		cell->value = value;
+		__atomic_store_n(&cell->sequence, tail + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+	
+	/*!
+	 * Called by the consumer.
+	 * \return false if the queue is empty, or if the oldest producer
+	 * has not finished writing its element yet
+	 */
+	bool pop(T &value)
+	{
+		const size_t head = m_head;
+		Cell *const cell = &m_cells[head & m_mask];
+		if(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != head + 1) return false;
+		value = cell->value;
+		__atomic_store_n(&cell->sequence, head + m_capacity, __ATOMIC_RELEASE);
+		__atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+	
+	size_t size() const
+	{
+		const size_t tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+		const size_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+		return tail > head ? tail - head : 0;
+	}
+	
+	bool isEmpty() const
+	{
+		return size() == 0;
+	}
+	
+	size_t capacity() const
+	{
+		return m_capacity;
+	}
+	
+private:
+	MpscQueue(const MpscQueue &rhs);
+	MpscQueue &operator=(const MpscQueue &rhs);
+	
+	struct Cell
+	{
+		size_t sequence;
+		T value;
+	};
+	
+	const size_t m_capacity;
+	const size_t m_mask;
+	Cell *const m_cells;
+	
+	char m_pad0[QUEUE_CACHE_LINE];
+	size_t m_head;
+	char m_pad1[QUEUE_CACHE_LINE];
+	size_t m_tail;
+	char m_pad2[QUEUE_CACHE_LINE];
+};
+
+#endif
@@ -0,0 +1,54 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file sensor.h
+ * \brief Timestamped sensor readings
+ * \copyright KISS Institute for Practical Robotics
+ * \ingroup sensor
+ */
+
+#ifndef _SENSOR_H_
+#define _SENSOR_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * A sensor value along with when and from which refresh it was read.
+ * Two samples with the same nonzero seq came from the same refresh, so
+ * work done for the first needn't be repeated for the second.
+ * \ingroup sensor
+ */
+typedef struct
+{
+	int value;
+	unsigned long long timestamp; // Nanoseconds on the seconds_monotonic() clock
+	unsigned long seq; // Increments each time the source refreshes. 0 if unknown.
+} sensor_sample;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,7 +29,36 @@
 #ifndef _SENSORS_HPP_
 #define _SENSORS_HPP_
 
+#include "sensor.h"
 #include "export.h"
+#include "util.hpp"
+
+/*!
+ * \class Sample
+ * \brief A sensor value along with when and from which refresh it was read
+ * \ingroup sensor
+ */
+template<typename T>
+struct Sample
+{
+	Sample()
+		: value(),
+		timestamp(0),
+		seq(0)
+	{
+	}
+	
+	Sample(const T &value, const unsigned long long timestamp, const unsigned long seq)
+		: value(value),
+		timestamp(timestamp),
+		seq(seq)
+	{
+	}
+	
+	T value; //!< The sensor's value
+	unsigned long long timestamp; //!< When the value was read from its source. Monotonic nanoseconds, see Time::now()
+	unsigned long seq; //!< Increments each time the source refreshes. 0 if the source has no sequence.
+};
 
 /*!
  * \class Sensor
@@ -48,6 +77,33 @@ public:
 	 * \return The sensor's current value
 	 */
 	virtual T value() const = 0;
+	
+	/*!
+	 * Get the current value for this sensor along with its timestamp and
+	 * source sequence number. Two samples with the same nonzero seq came
+	 * from the same refresh. The default stamps value() with the current
+	 * time and seq 0.
+	 * \return The sensor's current sample
+	 */
+	virtual Sample<T> sample() const
+	{
+		return Sample<T>(value(), Time::now(), 0);
+	}
+	
+	/*!
+	 * Get the sensor's value only if its source has refreshed since seq
+	 * \param seq The seq of the last sample seen. Updated when a newer value is returned.
+	 * \param value Set to the sensor's value if it is newer
+	 * \return true if value was set, false if the source hasn't refreshed since seq
+	 */
+	bool valueIfNewer(unsigned long &seq, T &value) const
+	{
+		const Sample<T> current = sample();
+		if(current.seq && current.seq == seq) return false;
+		seq = current.seq;
+		value = current.value;
+		return true;
+	}
 };
 
 #endif
@@ -6,6 +6,8 @@
 typedef int socket_fd_t;
 
 struct sockaddr;
+struct mmsghdr;
+struct iovec;
 
 class Address
 {
@@ -29,6 +31,50 @@ private:
 	sockaddr_in m_addr;
 };
 
+class DatagramBatch
+{
+public:
+	DatagramBatch(const unsigned capacity, const size_t datagramSize);
+	~DatagramBatch();
+	
+	unsigned capacity() const;
+	size_t datagramSize() const;
+	
+	unsigned size() const;
+	void clear();
+	
+	bool append(const void *const data, const size_t length, const Address &dest);
+	
+	unsigned char *data(const unsigned i);
+	const unsigned char *data(const unsigned i) const;
+	size_t length(const unsigned i) const;
+	Address address(const unsigned i) const;
+	
+	// Kernel receive time on the Time::now() clock, or 0 if
+	// timestamping was not enabled on the socket.
+	unsigned long long timestamp(const unsigned i) const;
+	
+private:
+	DatagramBatch(const DatagramBatch &rhs);
+	DatagramBatch &operator=(const DatagramBatch &rhs);
+	
+	friend class Socket;
+	
+	void prepareReceive();
+	void finishReceive(const unsigned count);
+	
+	unsigned m_capacity;
+	size_t m_datagramSize;
+	unsigned m_size;
+	
+	mmsghdr *m_headers;
+	iovec *m_iovecs;
+	sockaddr_in *m_addresses;
+	unsigned char *m_data;
+	unsigned char *m_control;
+	unsigned long long *m_timestamps;
+};
+
 class Socket
 {
 public:
@@ -39,6 +85,7 @@ public:
 	bool setBlocking(const bool blocking);
 	bool setReusable(const bool reusable);
 	bool bind(const unsigned short port);
+	bool setTimestamping(const bool timestamping);
 	bool close();
 	
 	ssize_t recv(void *const buffer, const size_t length, int flags = 0);
@@ -47,6 +94,14 @@ public:
 	ssize_t send(const void *const buffer, const size_t length, int flags = 0);
 	ssize_t sendto(const void *const buffer, const size_t length, const Address &dest, int flags = 0);
 	
+	// Receives up to batch.capacity() datagrams in one call. Returns the
+	// number received, or -1 on error (errno is EAGAIN if nothing was waiting
+	// on a non-blocking socket).
+	int recvBatch(DatagramBatch &batch, int flags = 0);
+	
+	// Sends every datagram appended to the batch. Returns the number sent.
+	int sendBatch(DatagramBatch &batch, int flags = 0);
+	
 	socket_fd_t fd() const;
 	
 	static Socket udp();
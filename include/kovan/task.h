@@ -0,0 +1,99 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file task.h
+ * \brief Functions for running short jobs on a shared pool of worker threads
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup task Tasks
+ */
+
+#ifndef _TASK_H_
+#define _TASK_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+	void *data;
+} task;
+
+typedef void (*task_function)(void *arg);
+typedef void (*parallel_for_function)(int begin, int end, void *arg);
+
+/*!
+ * Sets the number of worker threads used to run tasks.
+ * \param count The number of workers. Boards with one or two cores should use 1 or 2.
+ * \ingroup task
+ */
+EXPORT_SYM void task_set_worker_count(int count);
+
+/*!
+ * \return The number of worker threads used to run tasks.
+ * \ingroup task
+ */
+EXPORT_SYM int task_worker_count();
+
+/*!
+ * Queues func to be called with arg on a worker thread.
+ * \return A handle that must be released with task_destroy.
+ * \see task_wait
+ * \ingroup task
+ */
+EXPORT_SYM task task_submit(task_function func, void *arg);
+
+/*!
+ * Waits for a submitted task to finish.
+ * \blocks
+ * \ingroup task
+ */
+EXPORT_SYM void task_wait(task t);
+
+/*!
+ * \return 1 if the task has finished, 0 otherwise.
+ * \ingroup task
+ */
+EXPORT_SYM int task_done(task t);
+
+/*!
+ * Waits for the task to finish and releases its handle.
+ * \blocks
+ * \ingroup task
+ */
+EXPORT_SYM void task_destroy(task t);
+
+/*!
+ * Calls func over the range [begin, end) in chunks of at most grain
+ * iterations, spread across the worker threads.
+ * \param grain Chunk size, or 0 to choose one automatically.
+ * \blocks
+ * \ingroup task
+ */
+EXPORT_SYM void parallel_for(int begin, int end, int grain, parallel_for_function func, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file task.hpp
+ * \brief Classes for running short jobs on a shared pool of worker threads
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup task Tasks
+ */
+
+#ifndef _TASK_HPP_
+#define _TASK_HPP_
+
+#include <deque>
+#include <vector>
+
+#include "thread.hpp"
+#include "export.h"
+
+#define TASK_MAX_WORKERS 16
+
+class ThreadPool;
+class TaskWorker;
+
+/*!
+ * \class Task
+ * \brief A unit of work that can be submitted to a ThreadPool
+ * \details A Task doubles as its own completion handle. Subclasses
+ * implement run() and store any results as members; callers use
+ * wait() or isDone() to find out when those results are ready.
+ * \ingroup task
+ */
+class EXPORT_SYM Task
+{
+public:
+	Task();
+	virtual ~Task();
+	
+	virtual void run() = 0;
+	
+	/*!
+	 * \return true if this task has finished running, false otherwise.
+	 */
+	bool isDone() const;
+	
+	/*!
+	 * Blocks until this task has finished running. While waiting, the calling
+	 * thread helps execute other pending tasks.
+	 * \blocks
+	 */
+	void wait();
+	
+private:
+	Task(const Task &rhs);
+	Task &operator=(const Task &rhs);
+	
+	friend class ThreadPool;
+	
+	volatile bool m_done;
+	bool m_autoDelete;
+};
+
+/*!
+ * \class ParallelForBody
+ * \brief The loop body executed by ThreadPool::parallelFor
+ * \ingroup task
+ */
+class EXPORT_SYM ParallelForBody
+{
+public:
+	virtual ~ParallelForBody();
+	
+	/*!
+	 * Processes the half open range [begin, end)
+	 */
+	virtual void run(const int begin, const int end) = 0;
+};
+
+/*!
+ * \class ThreadPool
+ * \brief A work-stealing executor shared by the whole library
+ * \details Every worker owns a queue of tasks. Workers take new work from the
+ * back of their own queue and steal from the front of the others' when they run dry.
+ * Idle workers sleep, so an idle pool costs no CPU time.
+ * \ingroup task
+ */
+class EXPORT_SYM ThreadPool
+{
+public:
+	~ThreadPool();
+	
+	/*!
+	 * Changes the number of worker threads. Pending tasks are kept.
+	 * \param workers The number of workers, clamped to [1, TASK_MAX_WORKERS].
+	 * \note Must not be called from inside a running task.
+	 */
+	void setWorkerCount(const unsigned workers);
+	unsigned workerCount() const;
+	
+	/*!
+	 * Queues a task for execution.
+	 * \param task The task to run. The pool does not take ownership unless autoDelete is true.
+	 * \param autoDelete If true, the pool deletes the task once it has run. The task
+	 * must not be waited on in that case.
+	 */
+	void submit(Task *const task, const bool autoDelete = false);
+	
+	/*!
+	 * Runs body over [begin, end), split into chunks of at most grain iterations.
+	 * The calling thread participates in the work.
+	 * \param grain The chunk size, or 0 to pick one based on the number of workers.
+	 * \blocks
+	 */
+	void parallelFor(const int begin, const int end, ParallelForBody *const body,
+		const int grain = 0);
+	
+	/*!
+	 * The global instance of the pool. Workers are started on first use.
+	 * The initial worker count is the number of online CPUs, or the value
+	 * of the KOVAN_WORKERS environment variable if it is set.
+	 */
+	static ThreadPool *instance();
+	
+private:
+	ThreadPool();
+	ThreadPool(const ThreadPool &rhs);
+	ThreadPool &operator=(const ThreadPool &rhs);
+	
+	friend class Task;
+	friend class TaskWorker;
+	
+	Task *take(const int self);
+	bool runOne(const int self);
+	void execute(Task *const task);
+	void startWorkers(const unsigned workers);
+	void stopWorkers();
+	void idle(const int self);
+	void notifyFinished();
+	
+	static int currentWorker();
+	
+	struct Queue
+	{
+		Mutex mutex;
+		std::deque<Task *> tasks;
+	};
+	
+	std::vector<TaskWorker *> m_workers;
+	Queue m_queues[TASK_MAX_WORKERS];
+	volatile unsigned m_queueCount;
+	Mutex m_resize;
+	unsigned m_next;
+	
+	volatile bool m_stop;
+	volatile int m_pending;
+	
+	Mutex m_sleepMutex;
+	ConditionVariable m_workAvailable;
+	ConditionVariable m_taskFinished;
+};
+
+#endif
@@ -17,19 +17,139 @@ typedef struct
 	void *data;
 } thread;
 
+typedef struct
+{
+	void *data;
+} cond;
+
+typedef struct
+{
+	void *data;
+} semaphore;
+
+typedef struct
+{
+	void *data;
+} rwlock;
+
+typedef struct
+{
+	void *data;
+} queue;
+
 typedef void (*thread_function)();
 
+#define THREAD_POLICY_DEFAULT 0
+#define THREAD_POLICY_FIFO 1
+#define THREAD_POLICY_RR 2
+
 EXPORT_SYM mutex mutex_create(void);
 EXPORT_SYM void mutex_lock(mutex m);
 EXPORT_SYM int mutex_trylock(mutex m);
 EXPORT_SYM void mutex_unlock(mutex m);
 EXPORT_SYM void mutex_destroy(mutex m);
 
+EXPORT_SYM cond cond_create(void);
+EXPORT_SYM void cond_wait(cond c, mutex m);
+/*!
+ * Waits on c for at most msecs milliseconds. m must be locked by the caller.
+ * \return 1 if signaled, 0 if the timeout expired
+ */
+EXPORT_SYM int cond_wait_timeout(cond c, mutex m, long msecs);
+EXPORT_SYM void cond_signal(cond c);
+EXPORT_SYM void cond_broadcast(cond c);
+EXPORT_SYM void cond_destroy(cond c);
+
+EXPORT_SYM semaphore semaphore_create(int initial);
+EXPORT_SYM void semaphore_wait(semaphore s);
+/*!
+ * \return 1 if the semaphore was taken, 0 if the timeout expired
+ */
+EXPORT_SYM int semaphore_wait_timeout(semaphore s, long msecs);
+EXPORT_SYM int semaphore_trywait(semaphore s);
+EXPORT_SYM void semaphore_post(semaphore s);
+EXPORT_SYM void semaphore_destroy(semaphore s);
+
+EXPORT_SYM rwlock rwlock_create(void);
+EXPORT_SYM void rwlock_read_lock(rwlock l);
+EXPORT_SYM void rwlock_write_lock(rwlock l);
+EXPORT_SYM void rwlock_unlock(rwlock l);
+EXPORT_SYM void rwlock_destroy(rwlock l);
+
+/*!
+ * Creates a bounded queue of pointers. Any number of threads may push,
+ * but only one thread may pop.
+ * \param capacity The maximum number of queued items. Rounded up to a power of two.
+ */
+EXPORT_SYM queue queue_create(int capacity);
+/*!
+ * \return 1 on success, 0 if the queue is full
+ */
+EXPORT_SYM int queue_push(queue q, void *item);
+/*!
+ * Removes the oldest item, sleeping until one is available.
+ * \blocks
+ */
+EXPORT_SYM void *queue_pop(queue q);
+/*!
+ * \return 1 if an item was stored in item, 0 if the timeout expired
+ */
+EXPORT_SYM int queue_pop_timeout(queue q, void **item, long msecs);
+/*!
+ * \return 1 if an item was stored in item, 0 if the queue was empty
+ */
+EXPORT_SYM int queue_trypop(queue q, void **item);
+EXPORT_SYM int queue_size(queue q);
+EXPORT_SYM void queue_destroy(queue q);
+
 EXPORT_SYM thread thread_create(thread_function func);
 EXPORT_SYM void thread_start(thread id);
 EXPORT_SYM void thread_wait(thread id);
 EXPORT_SYM void thread_destroy(thread id);
 
+/*!
+ * Sets the scheduling policy and priority of a thread. May be called before
+ * or after thread_start. Real-time policies need root or CAP_SYS_NICE; without
+ * them the thread still runs, using the default policy.
+ * \param policy THREAD_POLICY_DEFAULT, THREAD_POLICY_FIFO or THREAD_POLICY_RR
+ * \param priority 1 (lowest) to 99 (highest) for the real-time policies
+ * \return 1 on success, 0 on failure
+ */
+EXPORT_SYM int thread_set_priority(thread id, int policy, int priority);
+
+/*!
+ * Restricts a thread to a set of CPUs.
+ * \param mask Bit n set allows CPU n. 0 allows every CPU.
+ * \return 1 on success, 0 on failure
+ */
+EXPORT_SYM int thread_set_affinity(thread id, unsigned long mask);
+
+/*!
+ * Sets the stack size of a thread. Must be called before thread_start.
+ * \param bytes The stack size, or 0 for the system default.
+ */
+EXPORT_SYM void thread_set_stack_size(thread id, unsigned long bytes);
+
+/*!
+ * Like thread_set_priority, for the calling thread.
+ * \return 1 on success, 0 on failure
+ */
+EXPORT_SYM int set_current_thread_priority(int policy, int priority);
+
+/*!
+ * Like thread_set_affinity, for the calling thread.
+ * \return 1 on success, 0 on failure
+ */
+EXPORT_SYM int set_current_thread_affinity(unsigned long mask);
+
+/*!
+ * Locks all current and future memory of this program into RAM,
+ * avoiding page fault stalls in time critical loops.
+ * \return 1 on success, 0 on failure
+ */
+EXPORT_SYM int lock_memory();
+EXPORT_SYM int unlock_memory();
+
 #ifdef __cplusplus
 }
 #endif
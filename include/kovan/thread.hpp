@@ -3,14 +3,23 @@
 
 #ifndef WIN32
 #include <pthread.h>
+#include <semaphore.h>
 #endif
 
 #include "export.h"
 
+class ConditionVariable;
+
 class EXPORT_SYM Mutex
 {
 public:
 	Mutex();
+	
+	/*!
+	 * \param recursive If true, the thread holding the mutex may lock it again.
+	 * It must then unlock it as many times.
+	 */
+	Mutex(const bool recursive);
 	~Mutex();
 	
 	void lock();
@@ -20,6 +29,8 @@ public:
 	
 private:
 	Mutex(const Mutex &rhs);
+	
+	friend class ConditionVariable;
 
 #ifdef WIN32
 	CRITICAL_SECTION m_handle;
@@ -28,9 +39,124 @@ private:
 #endif
 };
 
+/*!
+ * \class ConditionVariable
+ * \brief Lets threads sleep until another thread signals them
+ * \details Timeouts are measured against a monotonic clock, so they are
+ * unaffected by changes to the system time.
+ */
+class EXPORT_SYM ConditionVariable
+{
+public:
+	ConditionVariable();
+	~ConditionVariable();
+	
+	/*!
+	 * Atomically releases mutex and sleeps until signaled. mutex is
+	 * locked again before returning.
+	 * \blocks
+	 */
+	void wait(Mutex &mutex);
+	
+	/*!
+	 * Like wait(Mutex &), but gives up after msecs milliseconds.
+	 * \return true if signaled, false if the timeout expired
+	 * \blocks
+	 */
+	bool wait(Mutex &mutex, const unsigned long msecs);
+	
+	void signal();
+	void broadcast();
+	
+private:
+	ConditionVariable(const ConditionVariable &rhs);
+	
+#ifdef WIN32
+	CONDITION_VARIABLE m_handle;
+#else
+	pthread_cond_t m_handle;
+#endif
+};
+
+/*!
+ * \class Semaphore
+ * \brief A counting semaphore
+ */
+class EXPORT_SYM Semaphore
+{
+public:
+	Semaphore(const unsigned initial = 0);
+	~Semaphore();
+	
+	/*!
+	 * Decrements the count, sleeping while it is zero.
+	 * \blocks
+	 */
+	void wait();
+	
+	/*!
+	 * Like wait(), but gives up after msecs milliseconds.
+	 * \return true if the count was decremented, false if the timeout expired
+	 * \blocks
+	 */
+	bool wait(const unsigned long msecs);
+	bool tryWait();
+	
+	void post();
+	
+private:
+	Semaphore(const Semaphore &rhs);
+	
+#ifdef WIN32
+	HANDLE m_handle;
+#else
+	sem_t m_handle;
+#endif
+};
+
+/*!
+ * \class RwLock
+ * \brief A lock that allows many readers or a single writer
+ */
+class EXPORT_SYM RwLock
+{
+public:
+	RwLock();
+	~RwLock();
+	
+	void readLock();
+	bool tryReadLock();
+	
+	void writeLock();
+	bool tryWriteLock();
+	
+	void unlock();
+	
+private:
+	RwLock(const RwLock &rhs);
+	
+#ifdef WIN32
+	SRWLOCK m_handle;
+	bool m_exclusive;
+#else
+	pthread_rwlock_t m_handle;
+#endif
+};
+
 class EXPORT_SYM Thread
 {
 public:
+	/*!
+	 * Scheduling policies. FifoPolicy and RoundRobinPolicy are real-time
+	 * policies and usually require root or CAP_SYS_NICE.
+	 */
+	enum Policy
+	{
+		DefaultPolicy = 0,
+		FifoPolicy,
+		RoundRobinPolicy
+	};
+	
 	Thread();
 	virtual ~Thread();
 	
@@ -39,12 +165,64 @@ public:
 	
 	virtual void run() = 0;
 	
+	/*!
+	 * Sets the scheduling policy and priority. If the thread is already
+	 * running the change is applied immediately, otherwise at start().
+	 * \param priority The real-time priority, 1 (lowest) to 99 (highest). Ignored for DefaultPolicy.
+	 * \return false if the change could not be applied. A thread started
+	 * without sufficient privileges falls back to DefaultPolicy.
+	 */
+	bool setPriority(const Thread::Policy policy, const int priority);
+	Thread::Policy policy() const;
+	int priority() const;
+	
+	/*!
+	 * Restricts the thread to a set of CPUs.
+	 * \param mask Bit n set allows CPU n. 0 allows every CPU.
+	 * \return false if the change could not be applied
+	 */
+	bool setAffinity(const unsigned long mask);
+	unsigned long affinity() const;
+	
+	/*!
+	 * Sets the stack size used by start(). Has no effect on a running thread.
+	 * \param bytes The stack size, or 0 for the system default.
+	 */
+	void setStackSize(const unsigned long bytes);
+	unsigned long stackSize() const;
+	
+	/*!
+	 * Applies a scheduling policy and priority to the calling thread.
+	 * \return false if the change could not be applied
+	 */
+	static bool setCurrentPriority(const Thread::Policy policy, const int priority);
+	
+	/*!
+	 * Restricts the calling thread to a set of CPUs.
+	 * \return false if the change could not be applied
+	 */
+	static bool setCurrentAffinity(const unsigned long mask);
+	
+	/*!
+	 * Locks all current and future pages of the process into RAM so that
+	 * time critical code never waits on a page fault.
+	 * \return false if the pages could not be locked
+	 */
+	static bool lockMemory();
+	static bool unlockMemory();
+	
 private:
 #ifndef WIN32
 	pthread_t m_thread;
 #else
 	unsigned long m_thread;
 #endif
+	bool m_running;
+	
+	Thread::Policy m_policy;
+	int m_priority;
+	unsigned long m_affinity;
+	unsigned long m_stackSize;
 };
 
 #endif
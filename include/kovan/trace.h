@@ -0,0 +1,74 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file trace.h
+ * \brief Functions for recording timing spans that can be viewed in chrome://tracing
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup trace Tracing
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Starts (1) or stops (0) recording spans.
+ * \ingroup trace
+ */
+EXPORT_SYM void trace_enable(int enabled);
+
+/*!
+ * Begins a span.
+ * \return A token to pass to trace_end, or 0 if tracing is off
+ * \ingroup trace
+ */
+EXPORT_SYM unsigned long long trace_begin();
+
+/*!
+ * Ends a span started by trace_begin.
+ * \param name A string that stays valid until the trace is dumped, e.g. a literal
+ * \ingroup trace
+ */
+EXPORT_SYM void trace_end(const char *name, unsigned long long token);
+
+/*!
+ * Writes all recorded spans to path as Chrome trace-event JSON.
+ * \return 1 on success, 0 otherwise
+ * \ingroup trace
+ */
+EXPORT_SYM int trace_dump(const char *path);
+
+/*!
+ * Discards all recorded spans.
+ * \ingroup trace
+ */
+EXPORT_SYM void trace_clear();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+/*!
+ * \file trace.hpp
+ * \brief Lightweight timing spans that can be viewed in chrome://tracing
+ * \copyright KISS Institute for Practical Robotics
+ * \defgroup trace Tracing
+ */
+
+#ifndef _TRACE_HPP_
+#define _TRACE_HPP_
+
+#include "export.h"
+
+/*!
+ * \class Trace
+ * \brief Records timing spans into per-thread rings
+ * \details Each thread writes fixed-size records into its own ring buffer without
+ * locking. When a ring is full the oldest records are overwritten. Recording is
+ * off until setEnabled(true) is called. While it is off, a span costs one
+ * flag check.
+ * \ingroup trace
+ */
+class EXPORT_SYM Trace
+{
+public:
+	static void setEnabled(const bool enabled);
+	static bool isEnabled()
+	{
+		return s_enabled;
+	}
+	
+	/*!
+	 * Adds a completed span to the calling thread's ring.
+	 * \param name Must remain valid until the trace is dumped, e.g. a string literal
+	 * \param begin Start time from Time::now()
+	 * \param end End time from Time::now()
+	 */
+	static void record(const char *const name, const unsigned long long begin, const unsigned long long end);
+	
+	/*!
+	 * Writes every buffered span to path as Chrome trace-event JSON.
+	 * Stop recording first for a consistent snapshot.
+	 */
+	static bool dump(const char *const path);
+	
+	/*!
+	 * Discards every buffered span.
+	 */
+	static void clear();
+	
+private:
+	static volatile bool s_enabled;
+};
+
+/*!
+ * \class TraceSpan
+ * \brief Records the lifetime of a scope as a span
+ * \ingroup trace
+ */
+class EXPORT_SYM TraceSpan
+{
+public:
+	TraceSpan(const char *const name)
+		: m_name(name),
+		m_begin(Trace::isEnabled() ? now() : 0)
+	{
+	}
+	
+	~TraceSpan()
+	{
+		if(m_begin) Trace::record(m_name, m_begin, now());
+	}
+	
+private:
+	static unsigned long long now();
+	
+	const char *m_name;
+	unsigned long long m_begin;
+};
+
+#define KOVAN_TRACE_CONCAT_(a, b) a##b
+#define KOVAN_TRACE_CONCAT(a, b) KOVAN_TRACE_CONCAT_(a, b)
+
+/*!
+ * Traces the rest of the enclosing scope under name. Compiles to nothing
+ * unless LIBKOVAN_TRACE is defined.
+ * \ingroup trace
+ */
+#ifdef LIBKOVAN_TRACE
+#define KOVAN_TRACE_SPAN(name) TraceSpan KOVAN_TRACE_CONCAT(__kovanTraceSpan, __LINE__)(name)
+#else
+#define KOVAN_TRACE_SPAN(name) do {} while(0)
+#endif
+
+#endif
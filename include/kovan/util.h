@@ -41,9 +41,24 @@ extern "C" {
  */
 EXPORT_SYM void msleep(long msecs);
 
+/*!
+ * \return The wall-clock time in milliseconds. This jumps if the system time is changed,
+ * so use seconds_monotonic() to measure intervals.
+ */
 EXPORT_SYM unsigned long systime();
+
+/*!
+ * \return The wall-clock time in seconds.
+ * \see systime
+ */
 EXPORT_SYM double seconds();
 
+/*!
+ * \return Seconds elapsed on a clock that never jumps, with nanosecond resolution.
+ * Only differences between two values are meaningful.
+ */
+EXPORT_SYM double seconds_monotonic();
+
 #ifdef __cplusplus
 }
 #endif
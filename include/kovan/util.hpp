@@ -29,5 +29,36 @@
 #define _UTIL_HPP_
 
 #include "util.h"
+#include "export.h"
+
+/*!
+ * \class Time
+ * \brief Monotonic nanosecond clock
+ * \details Values count from an arbitrary point (usually boot) and are unaffected by
+ * changes to the system time, so they are suitable for timeouts, rate limits and timestamps.
+ */
+class EXPORT_SYM Time
+{
+public:
+	/*!
+	 * \return The current monotonic time in nanoseconds
+	 */
+	static unsigned long long now();
+	
+	/*!
+	 * \return The current monotonic time in seconds
+	 */
+	static double seconds();
+	
+	/*!
+	 * \return Nanoseconds elapsed since a previous value of now()
+	 */
+	static unsigned long long since(const unsigned long long then);
+	
+	/*!
+	 * \return Milliseconds elapsed since a previous value of now()
+	 */
+	static unsigned long msecsSince(const unsigned long long then);
+};
 
 #endif
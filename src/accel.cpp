@@ -1,4 +1,8 @@
 #include "kovan/accel.hpp"
+#include "kovan/periodic.hpp"
+#include "kovan/queue.hpp"
+#include "kovan/util.hpp"
+#include "kovan/metrics.hpp"
 #include "i2c_p.hpp"
 
 #include <unistd.h>
@@ -20,25 +24,135 @@
 
 bool Acceleration::s_setup = false;
 
+static Counter s_samples("accel.samples");
+static Counter s_samplesDropped("accel.samples_dropped");
+
+class AccelSampler : public PeriodicTask
+{
+public:
+	AccelSampler(const size_t capacity)
+		: m_samples(capacity),
+		m_dropped(0)
+	{
+	}
+	
+	~AccelSampler()
+	{
+		PeriodicExecutor::instance()->remove(this);
+	}
+	
+	virtual void run()
+	{
+		accel_sample sample;
+		if(!Acceleration::read(sample)) return;
+		s_samples.increment();
+		if(m_samples.push(sample)) return;
+		__sync_fetch_and_add(&m_dropped, 1);
+		s_samplesDropped.increment();
+	}
+	
+	SpscQueue<accel_sample> m_samples;
+	volatile unsigned long m_dropped;
+};
+
+static AccelSampler *s_sampler = 0;
+static Mutex s_samplerMutex;
+static volatile unsigned long s_reads = 0;
+
+static inline short accelValue(const unsigned char raw)
+{
+	return 4 * (signed short)(signed char)raw;
+}
+
 signed short Acceleration::x()
 {
 	setupI2C();
 	if(!s_setup) return 0xFFFF;
-	return 4 * (signed short)(signed char)Private::I2C::instance()->read(R_XOUT8);
+	return accelValue(Private::I2C::instance()->read(R_XOUT8));
 }
 
 signed short Acceleration::y()
 {
 	setupI2C();
 	if(!s_setup) return 0xFFFF;
-	return 4 * (signed short)(signed char)Private::I2C::instance()->read(R_YOUT8);
+	return accelValue(Private::I2C::instance()->read(R_YOUT8));
 }
 
 signed short Acceleration::z()
 {
 	setupI2C();
 	if(!s_setup) return 0xFFFF;
-	return 4 * (signed short)(signed char)Private::I2C::instance()->read(R_ZOUT8);
+	return accelValue(Private::I2C::instance()->read(R_ZOUT8));
+}
+
+bool Acceleration::read(accel_sample &sample)
+{
+	setupI2C();
+	if(!s_setup) return false;
+	
+	unsigned char raw[3];
+	if(!Private::I2C::instance()->read(R_XOUT8, raw, sizeof(raw))) return false;
+	
+	sample.timestamp = Time::now();
+	sample.seq = __sync_add_and_fetch(&s_reads, 1);
+	sample.x = accelValue(raw[0]);
+	sample.y = accelValue(raw[1]);
+	sample.z = accelValue(raw[2]);
+	return true;
+}
+
+bool Acceleration::startSampler(const unsigned hz, const size_t capacity)
+{
+	if(!hz || !capacity) return false;
+	
+	setupI2C();
+	if(!s_setup) return false;
+	
+	s_samplerMutex.lock();
+	if(s_sampler) {
+		s_samplerMutex.unlock();
+		return false;
+	}
+	s_sampler = new AccelSampler(capacity);
+	const bool ret = PeriodicExecutor::instance()->add(s_sampler, 1000000UL / hz);
+	if(!ret) {
+		delete s_sampler;
+		s_sampler = 0;
+	}
+	s_samplerMutex.unlock();
+	return ret;
+}
+
+void Acceleration::stopSampler()
+{
+	s_samplerMutex.lock();
+	delete s_sampler;
+	s_sampler = 0;
+	s_samplerMutex.unlock();
+}
+
+bool Acceleration::isSampling()
+{
+	return s_sampler;
+}
+
+size_t Acceleration::readBlock(accel_sample *const samples, const size_t max)
+{
+	size_t ret = 0;
+	s_samplerMutex.lock();
+	if(s_sampler) {
+		while(ret < max && s_sampler->m_samples.pop(samples[ret])) ++ret;
+	}
+	s_samplerMutex.unlock();
+	return ret;
+}
+
+unsigned long Acceleration::dropped()
+{
+	s_samplerMutex.lock();
+	const unsigned long ret = s_sampler ? s_sampler->m_dropped : 0;
+	s_samplerMutex.unlock();
+	return ret;
 }
 
 void Acceleration::setupI2C()
@@ -66,9 +180,11 @@ bool Acceleration::calibrate()
 	signed char accel_bias_z = 0;
 
 	for(int i = 0; i < 100; i++) {
-		signed char accel_x = (signed char)Private::I2C::instance()->read(R_XOUT8);
-		signed char accel_y = (signed char)Private::I2C::instance()->read(R_YOUT8);
-		signed char accel_z = (signed char)Private::I2C::instance()->read(R_ZOUT8);
+		unsigned char raw[3];
+		if(!Private::I2C::instance()->read(R_XOUT8, raw, sizeof(raw))) return false;
+		signed char accel_x = (signed char)raw[0];
+		signed char accel_y = (signed char)raw[1];
+		signed char accel_z = (signed char)raw[2];
 
 
 		signed short err_sqrd = (accel_x * accel_x)
@@ -96,17 +212,40 @@ bool Acceleration::calibrate()
 	return false; // fail
 }
 
+// Reads all three axes but keeps one, so the timestamp is the conversion's
+static Sample<short> axisSample(short accel_sample::*const axis)
+{
+	accel_sample sample;
+	if(!Acceleration::read(sample)) return Sample<short>(0xFFFF, Time::now(), 0);
+	return Sample<short>(sample.*axis, sample.timestamp, sample.seq);
+}
+
 short AccelX::value() const
 {
 	return Acceleration::x();
 }
 
+Sample<short> AccelX::sample() const
+{
+	return axisSample(&accel_sample::x);
+}
+
 short AccelY::value() const
 {
 	return Acceleration::y();
 }
 
+Sample<short> AccelY::sample() const
+{
+	return axisSample(&accel_sample::y);
+}
+
 short AccelZ::value() const
 {
 	return Acceleration::z();
-}
\ No newline at end of file
+}
+
+Sample<short> AccelZ::sample() const
+{
+	return axisSample(&accel_sample::z);
+}
@@ -24,3 +24,31 @@ int accel_calibrate()
 
 	return -1;
 }
+
+int accel_read(accel_sample *sample)
+{
+	if(!sample) return 0;
+	return Acceleration::read(*sample) ? 1 : 0;
+}
+
+int accel_sampler_start(int hz, int capacity)
+{
+	if(hz <= 0 || capacity <= 0) return 0;
+	return Acceleration::startSampler(hz, capacity) ? 1 : 0;
+}
+
+void accel_sampler_stop()
+{
+	Acceleration::stopSampler();
+}
+
+int accel_read_block(accel_sample *samples, int max)
+{
+	if(!samples || max <= 0) return 0;
+	return Acceleration::readBlock(samples, max);
+}
+
+unsigned long accel_sampler_dropped()
+{
+	return Acceleration::dropped();
+}
@@ -20,6 +20,7 @@
 
 #include "kovan/analog.hpp"
 #include "analog_p.hpp"
+#include "kovan_p.hpp"
 
 Analog::Analog(const unsigned char& port)
 	: m_port(port)
@@ -32,6 +33,15 @@ unsigned short Analog::value() const
 	return Private::Analog::instance()->value(m_port);
 }
 
+Sample<unsigned short> Analog::sample() const
+{
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	const Sample<unsigned short> ret(value(), kovan->stateTimestamp(), kovan->stateSeq());
+	kovan->unlock();
+	return ret;
+}
+
 void Analog::setPullup(bool pullup)
 {
 	return Private::Analog::instance()->setPullup(m_port, pullup);
@@ -19,7 +19,9 @@
  **************************************************************************/
 
 #include "kovan/analog.h"
+#include "kovan/analog.hpp"
 #include "analog_p.hpp"
+#include "sample_p.hpp"
 
 int analog10(int port)
 {
@@ -31,6 +33,12 @@ int analog(int port)
 	return analog10(port) >> 2;
 }
 
+int analog10_sample(int port, sensor_sample *sample)
+{
+	if(!sample) return 0;
+	return Private::copySample(Analog(static_cast<unsigned char>(port)).sample(), sample);
+}
+
 void set_analog_pullup(int port, int pullup)
 {
 	Private::Analog::instance()->setPullup(static_cast<unsigned char>(port), pullup == 0 ? false : true);
@@ -33,12 +33,14 @@ void Analog::setPullup(const unsigned char& port, const bool& pullup)
 {
 	if(port >= 8) return;
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	unsigned short &pullups = kovan->currentState().t[AN_PULLUPS];
 	
 	if(pullup) pullups |= (1 << port);
 	else pullups &= ~(1 << port);
 	
 	kovan->enqueueCommand(createWriteCommand(AN_PULLUPS, pullups));
+	kovan->unlock();
 }
 
 bool Analog::pullup(const unsigned char& port) const
@@ -47,7 +49,7 @@ bool Analog::pullup(const unsigned char& port) const
 	
 	Private::Kovan *kovan = Private::Kovan::instance();
 	kovan->autoUpdate();
-	return kovan->currentState().t[AN_PULLUPS] & (1 << port);
+	return kovan->registerValue(AN_PULLUPS) & (1 << port);
 }
 
 unsigned short Analog::value(const unsigned char& port) const
@@ -55,12 +57,12 @@ unsigned short Analog::value(const unsigned char& port) const
 	if(port > 16) return 0xFFFF;
 	Private::Kovan *kovan = Private::Kovan::instance();
 	kovan->autoUpdate();
-	return kovan->currentState().t[AN_IN_0 + port];
+	return kovan->registerValue(AN_IN_0 + port);
 }
 
 bool Analog::isCharging() const
 {
-	return Private::Kovan::instance()->currentState().t[AC_CONNECTED];
+	return Private::Kovan::instance()->registerValue(AC_CONNECTED);
 }
 
 Analog *Analog::instance()
@@ -19,11 +19,16 @@
  **************************************************************************/
 
 #include "kovan/ardrone.hpp"
+#include "kovan/ardrone.h"
 #include "kovan/thread.hpp"
 #include "kovan/socket.hpp"
-#include "kovan/util.h"
+#include "kovan/event_loop.hpp"
+#include "kovan/metrics.hpp"
+#include "kovan/util.hpp"
 #include "ardrone_constants_p.hpp"
 #include "uvlc_video_decoder_p.hpp"
+#include "init_timer_p.hpp"
+#include "warn.hpp"
 
 #include <opencv2/opencv.hpp>
 
@@ -32,7 +37,6 @@
 #include <unistd.h>
 #include <cstdlib>
 #include <cstdio>
-#include <iostream>
 #include <cstring>
 #include <string>
 #include <errno.h>
@@ -214,7 +218,7 @@ DroneCommand::DroneCommand()
 	memset(data, 0, ARDRONE_MAX_CMD_LENGTH);
 }
 
-class DroneController : public Thread
+class DroneController : public Thread, public EventHandler
 {
 public:
 	enum DoReturn {
@@ -244,6 +248,7 @@ public:
 	void configure(const char *const cmd, unsigned value);
 	
 	void run();
+	void event(EventLoop *const loop, const int fd, const unsigned events);
 	
 	void stop();
 	bool isStopped() const;
@@ -304,6 +309,12 @@ private:
 	Socket m_atSocket;
 	Socket m_navdataSocket;
 	Socket m_videoSocket;
+	DatagramBatch m_videoBatch;
+	
+	EventLoop m_loop;
+	int m_tickTimer;
+	bool m_videoWatched;
+	unsigned long m_ticks;
 	
 	Address m_atAddress;
 	Address m_navdataAddress;
@@ -325,7 +336,11 @@ private:
 };
 
 DroneController::DroneController()
-	: m_stop(true),
+	: m_videoBatch(4, 40000),
+	m_tickTimer(-1),
+	m_videoWatched(false),
+	m_ticks(0),
+	m_stop(true),
 	m_cameraActivated(false)
 {
 	memset(m_navdata, 0, sizeof(m_navdata));
@@ -422,24 +437,47 @@ void DroneController::configure(const char *const cmd, unsigned value)
 	
 void DroneController::run()
 {
-	unsigned long ticks = 0;
+	m_ticks = 0;
+	m_stop = false;
+	
+	// Commands go out on a 3 ms tick. Video is read whenever
+	// the socket becomes readable instead of being polled.
+	m_tickTimer = m_loop.addTimer(3000000ULL, this);
+	if(m_tickTimer >= 0) m_loop.run();
+	
+	m_mutex.lock();
+	m_loop.remove(m_tickTimer);
+	m_tickTimer = -1;
+	if(m_videoWatched) m_loop.remove(m_videoSocket.fd());
+	m_videoWatched = false;
+	m_mutex.unlock();
+	
 	m_stop = false;
-	while(!m_stop) {
-		m_mutex.lock();
-		DroneController::DoReturn at = doAt(ticks);
-		DroneController::DoReturn navdata = DroneController::NotReady; // doNavdata(ticks);
-		DroneController::DoReturn video = doVideo(ticks);
-		m_mutex.unlock();
+	m_seq.reset();
+}
+
+void DroneController::event(EventLoop *const loop, const int fd, const unsigned events)
+{
+	bool error = false;
+	
+	m_mutex.lock();
+	if(fd == m_tickTimer) {
+		DroneController::DoReturn at = doAt(m_ticks);
+		DroneController::DoReturn navdata = DroneController::NotReady; // doNavdata(m_ticks);
+		DroneController::DoReturn video = doVideo(m_ticks);
 		
-		if(at == DroneController::Error
+		error = at == DroneController::Error
 			|| navdata == DroneController::Error
-			|| video == DroneController::Error) break;
+			|| video == DroneController::Error;
 		
-		msleep(3);
-		++ticks;
+		if(!m_videoWatched && m_videoSocket.isOpen()) m_videoWatched = m_loop.add(m_videoSocket, this);
+		++m_ticks;
+	} else if(m_videoWatched && fd == m_videoSocket.fd()) {
+		error = !fetchVideo();
 	}
-	m_stop = false;
-	m_seq.reset();
+	m_mutex.unlock();
+	
+	if(error) loop->quit();
 }
 
 void DroneController::stop()
@@ -447,6 +485,7 @@ void DroneController::stop()
 	m_mutex.lock();
 	m_stop = true;
 	m_mutex.unlock();
+	m_loop.quit();
 }
 
 bool DroneController::isStopped() const
@@ -577,6 +616,9 @@ void DroneController::setVideoAddress(const Address &videoAddress)
 	m_mutex.lock();
 	m_videoAddress = videoAddress;
 	
+	if(m_videoWatched) m_loop.remove(m_videoSocket.fd());
+	m_videoWatched = false;
+	
 	if(m_videoAddress.isValid()) setupSocket(m_videoSocket, m_videoAddress.port());
 	else m_videoSocket.close();
 	
@@ -653,38 +695,45 @@ bool DroneController::fetchNavdata()
 	ssize_t readLength = 0;
 	char data[sizeof(m_navdata)];
 	if((readLength = m_navdataSocket.recv(data, sizeof(data))) < 0 && errno != EAGAIN) {
-		perror("DroneController::fetchNavdata");
+		PWARN("navdata recv failed");
 		return false;
 	}
 	if(readLength < 0) return true;
 	
-#ifdef ARDRONE_DEBUG
-	std::cout << "Read " << readLength << " bytes from navdata stream" << std::endl;
-#endif
+	DEBUG_LOG("Read %ld bytes from navdata stream", (long)readLength);
 	
 	memcpy(m_navdata, data, sizeof(m_navdata));
 	return true;
 }
 
+static Counter s_videoFrames("drone.video_frames");
+static Counter s_videoFramesSkipped("drone.video_frames_skipped");
+static Counter s_decodeFailures("drone.decode_failures");
+static const double s_decodeBounds[] = { 1000, 2500, 5000, 10000, 20000, 40000 };
+static Histogram s_decodeTime("drone.decode_us", s_decodeBounds, sizeof(s_decodeBounds) / sizeof(double));
+
 bool DroneController::fetchVideo()
 {
-	ssize_t readLength = 0;
-	unsigned char data[40000];
-	if((readLength = m_videoSocket.recv(data, 40000)) < 0 && errno != EAGAIN) {
-		perror("DroneController::fetchVideo");
+	int received = 0;
+	if((received = m_videoSocket.recvBatch(m_videoBatch)) < 0 && errno != EAGAIN) {
+		PWARN("video recv failed");
 		return false;
 	}
-	// std::cout << std::hex << data << std::endl;
-	if(readLength < 0) {
-#ifdef ARDRONE_DEBUG
-		std::cout << "Didn't read any data from video stream." << std::endl;
-#endif
+	if(received <= 0) {
+		DEBUG_LOG("Didn't read any data from video stream");
 		return true;
 	}
-	// #ifdef ARDRONE_DEBUG
-	std::cout << "Read " << readLength << " bytes from video stream" << std::endl;
-	// #endif
-	Private::UvlcVideoDecoder().decode(data, readLength, m_image);
+	
+	// Every frame is a full picture, so only the newest one in the batch is worth decoding
+	const unsigned latest = received - 1;
+	DEBUG_LOG("Read %d datagrams from video stream", received);
+	s_videoFramesSkipped.increment(latest);
+	
+	const unsigned long long start = Time::now();
+	if(Private::UvlcVideoDecoder().decode(m_videoBatch.data(latest), m_videoBatch.length(latest), m_image)) {
+		s_decodeTime.observe(Time::since(start) / 1000.0);
+		s_videoFrames.increment();
+	} else s_decodeFailures.increment();
 	return true;
 }
 
@@ -719,11 +768,6 @@ DroneController::DoReturn DroneController::doVideo(const size_t it)
 {
 	if(!m_videoSocket.isOpen()) return DroneController::NotReady;
 	
-	// 30 Hz
-	if(it % 11) {
-		if(!fetchVideo()) return DroneController::Error;
-	}
-	
 	// Periodically
 	if(it % 100) {
 		if(!requestVideo()) return DroneController::Error;
@@ -735,15 +779,13 @@ DroneController::DoReturn DroneController::doVideo(const size_t it)
 bool DroneController::wakeupStream(Socket &socket, const Address &address)
 {
 	if(!socket.isOpen()) {
-#ifdef ARDRONE_DEBUG
-		std::cout << "Failed to wakeup stream using invalid socket." << std::endl;
-#endif
+		WARN("Failed to wakeup stream using invalid socket");
 		return false;
 	}
 	
 	const static char dummy[4] = { 0x01, 0x00, 0x00, 0x00 };
 	if(socket.sendto(dummy, sizeof(dummy), address) != sizeof(dummy)) {
-		perror("DroneController::wakeupStream -> sendto");
+		PWARN("sendto failed");
 		return false;
 	}
 	
@@ -754,21 +796,17 @@ bool DroneController::sendCurrentCommand()
 {
 	// Nothing to do.
 	if(m_commandStack.empty()) {
-#ifdef ARDRONE_DEBUG
-		std::cout << "Waiting on non-empty command stack" << std::endl;
-#endif
+		DEBUG_LOG("Waiting on non-empty command stack");
 		return true;
 	}
 	
 	char realCommand[ARDRONE_MAX_CMD_LENGTH];
 	sprintf(realCommand, m_commandStack.top().data, m_seq.next());
 	
-#ifdef ARDRONE_DEBUG
-	std::cout << "Sending " << realCommand << std::endl;
-#endif
+	DEBUG_LOG("Sending %s", realCommand);
 	
 	if(m_atSocket.sendto(realCommand, strlen(realCommand), m_atAddress) < 0) {
-		perror("DroneController::run -> sendto");
+		PWARN("sendto failed");
 		return false;
 	}
 	
@@ -785,7 +823,7 @@ bool DroneController::setupSocket(Socket &socket, const unsigned short bindTo) c
 	if(success) success &= socket.setReusable(true);
 	if(success && bindTo) success &= socket.bind(bindTo);
 	if(!success) {
-		perror("setupSocket");
+		PWARN("failed to set up socket");
 		socket.close();
 	}
 	
@@ -797,14 +835,24 @@ ARDrone::~ARDrone()
 	disconnect();
 }
 	
+static Gauge s_connectTime("init.drone_us");
+
 bool ARDrone::connect(const char *const ip, const double timeout)
 {
+	Private::InitTimer timer(s_connectTime, "ARDrone::connect");
+	
 	m_controller->setAtAddress(Address(ip, ARDRONE_AT_PORT));
 	m_controller->setNavdataAddress(Address(ip, ARDRONE_NAVDATA_PORT));
 	m_controller->setVideoAddress(Address(ip, ARDRONE_VIDEO_PORT));
 	
 	if(!m_controller->isValid()) return false;
 	
+	// The controller thread only runs while a drone is connected
+	if(!m_controllerRunning) {
+		m_controller->start();
+		m_controllerRunning = true;
+	}
+	
 	// We know we're connected once we start
 	// receiving navdata back
 	
@@ -815,8 +863,8 @@ bool ARDrone::connect(const char *const ip, const double timeout)
 	m_controller->control();
 	
 	/* bool gotComm = false;
-	double startWait = seconds();
-	while(seconds() - startWait < timeout) {
+	double startWait = seconds_monotonic();
+	while(seconds_monotonic() - startWait < timeout) {
 		if(m_controller->latestNavdata()) {
 			gotComm = true;
 			break;
@@ -836,10 +884,19 @@ bool ARDrone::connect(const char *const ip, const double timeout)
 
 void ARDrone::disconnect()
 {
+	if(!m_controllerRunning) {
+		m_controller->invalidate();
+		return;
+	}
+	
 	m_controller->land(true);
 	msleep(100);
 	// while(state() != ARDrone::Landed) msleep(100);
 	
+	m_controller->stop();
+	m_controller->join();
+	m_controllerRunning = false;
+	
 	m_controller->invalidate();
 }
 
@@ -903,9 +960,9 @@ ARDrone *ARDrone::instance()
 
 ARDrone::ARDrone()
 	: m_controller(new DroneController),
+	m_controllerRunning(false),
 	m_activeCamera(ARDrone::None)
 {
-	m_controller->start();
 }
 
 Camera::ARDroneInputProvider::ARDroneInputProvider()
@@ -916,7 +973,7 @@ Camera::ARDroneInputProvider::ARDroneInputProvider()
 bool Camera::ARDroneInputProvider::open(const int number)
 {
 	if(ARDrone::instance()->state() == ARDrone::Disconnected) {
-		std::cout << "Failed to open the ARDrone's camera (disconnected)" << std::endl;
+		WARN("Failed to open the ARDrone's camera (disconnected)");
 		return false;
 	}
 	
@@ -958,4 +1015,15 @@ bool Camera::ARDroneInputProvider::close()
 	ARDrone::instance()->setActiveCamera(ARDrone::None);
 	m_opened = false;
 	return true;
-}
\ No newline at end of file
+}
+
+camera drone_camera_open_handle(int which)
+{
+	camera ret;
+	Camera::Device *const device = new Camera::Device(new Camera::ARDroneInputProvider);
+	ret.data = reinterpret_cast<void *>(device);
+	if(device->open(which)) return ret;
+	delete device;
+	ret.data = 0;
+	return ret;
+}
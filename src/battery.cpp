@@ -20,6 +20,7 @@
 
 #include "kovan/battery.hpp"
 #include "analog_p.hpp"
+#include "battery_monitor_p.hpp"
 
 #define BATTERY_ADC_CHAN 16
 
@@ -31,4 +32,19 @@ bool Battery::isCharging()
 float Battery::powerLevel()
 {
 	return Private::Analog::instance()->value(BATTERY_ADC_CHAN);
-}
\ No newline at end of file
+}
+
+void Battery::setCompensation(const bool on)
+{
+	Private::BatteryMonitor::instance()->setCompensation(on);
+}
+
+bool Battery::compensation()
+{
+	return Private::BatteryMonitor::instance()->compensation();
+}
+
+float Battery::compensationFactor()
+{
+	return Private::BatteryMonitor::instance()->factor();
+}
@@ -29,4 +29,14 @@ int battery_charging()
 float power_level()
 {
 	return Battery::powerLevel();
-}
\ No newline at end of file
+}
+
+void set_battery_compensation(int on)
+{
+	Battery::setCompensation(on);
+}
+
+float get_battery_compensation()
+{
+	return Battery::compensationFactor();
+}
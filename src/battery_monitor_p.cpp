@@ -0,0 +1,109 @@
+#include "battery_monitor_p.hpp"
+#include "kovan_p.hpp"
+#include "kovan_regs_p.hpp"
+#include "motors_p.hpp"
+#include "kovan/metrics.hpp"
+#include "time_p.hpp"
+#include "warn.hpp"
+
+#include <cmath>
+
+using namespace Private;
+
+static Gauge s_factor("battery.compensation");
+static Gauge s_filtered("battery.filtered");
+
+BatteryMonitor::~BatteryMonitor()
+{
+	PeriodicExecutor::instance()->remove(this);
+}
+
+void BatteryMonitor::setCompensation(const bool on)
+{
+	Kovan *const kovan = Kovan::instance();
+	kovan->lock();
+	if(on == m_on) {
+		kovan->unlock();
+		return;
+	}
+	
+	if(on) {
+		// The reference is the battery as it is right now
+		kovan->flush();
+		m_filtered = kovan->currentState().t[AN_IN_16];
+		m_lastSample = Private::Time::monotonic();
+		if(m_filtered <= 0.0) {
+			WARN("No battery reading, compensation stays off");
+			kovan->unlock();
+			return;
+		}
+		m_reference = m_filtered;
+		PeriodicExecutor::instance()->add(this, BATTERY_PERIOD);
+	} else PeriodicExecutor::instance()->remove(this);
+	
+	m_on = on;
+	m_factor = 1.0;
+	s_factor.set(m_factor);
+	Motor::instance()->applyCompensation(m_factor);
+	kovan->unlock();
+}
+
+bool BatteryMonitor::compensation() const
+{
+	return m_on;
+}
+
+double BatteryMonitor::factor() const
+{
+	return m_factor;
+}
+
+void BatteryMonitor::run()
+{
+	Kovan *const kovan = Kovan::instance();
+	kovan->lock();
+	if(!m_on) {
+		kovan->unlock();
+		return;
+	}
+	
+	sample(Private::Time::monotonic());
+	double factor = m_reference / m_filtered;
+	if(factor < BATTERY_MIN_FACTOR) factor = BATTERY_MIN_FACTOR;
+	if(factor > BATTERY_MAX_FACTOR) factor = BATTERY_MAX_FACTOR;
+	
+	if(std::fabs(factor - m_factor) >= BATTERY_REAPPLY_STEP) {
+		m_factor = factor;
+		s_factor.set(m_factor);
+		Motor::instance()->applyCompensation(m_factor);
+	}
+	kovan->unlock();
+}
+
+BatteryMonitor *BatteryMonitor::instance()
+{
+	static BatteryMonitor s_instance;
+	return &s_instance;
+}
+
+BatteryMonitor::BatteryMonitor()
+	: m_on(false),
+	m_filtered(0.0),
+	m_reference(0.0),
+	m_factor(1.0),
+	m_lastSample(0)
+{
+}
+
+void BatteryMonitor::sample(const unsigned long long now)
+{
+	// The state is whatever the last reply brought; no packet is sent for it
+	const unsigned short reading = Kovan::instance()->registerValue(AN_IN_16);
+	const double dt = (now - m_lastSample) / 1e9;
+	m_lastSample = now;
+	if(!reading) return;
+	
+	const double alpha = dt / (BATTERY_TIME_CONSTANT + dt);
+	m_filtered += alpha * (reading - m_filtered);
+	s_filtered.set(m_filtered);
+}
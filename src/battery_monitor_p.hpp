@@ -0,0 +1,47 @@
+#ifndef _BATTERY_MONITOR_P_HPP_
+#define _BATTERY_MONITOR_P_HPP_
+
+#include "kovan/periodic.hpp"
+
+#define BATTERY_PERIOD 100000 // us
+#define BATTERY_TIME_CONSTANT 2.0 // s
+#define BATTERY_MIN_FACTOR 0.5
+#define BATTERY_MAX_FACTOR 1.5
+#define BATTERY_REAPPLY_STEP 0.01 // Rewrite PWM once the factor moves this much
+
+namespace Private
+{
+	// Low-pass filters the battery reading that comes back in every State
+	// reply, so sampling costs no round trips. While compensation is on, the
+	// motor PWM factor is the reference reading (taken when compensation was
+	// turned on) divided by the filtered one.
+	class BatteryMonitor : public PeriodicTask
+	{
+	public:
+		~BatteryMonitor();
+		
+		void setCompensation(const bool on);
+		bool compensation() const;
+		
+		// 1.0 while compensation is off
+		double factor() const;
+		
+		virtual void run();
+		
+		static BatteryMonitor *instance();
+		
+	private:
+		BatteryMonitor();
+		
+		// Folds the latest reading into the filter. Call with the Kovan locked.
+		void sample(const unsigned long long now);
+		
+		bool m_on;
+		double m_filtered;
+		double m_reference;
+		double m_factor;
+		unsigned long long m_lastSample;
+	};
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/board.h"
+#include "kovan_pool_p.hpp"
+
+using namespace Private;
+
+static KovanBoard *boardObject(board b)
+{
+	return reinterpret_cast<KovanBoard *>(b.data);
+}
+
+static board boardStruct(KovanBoard *object)
+{
+	board ret;
+	ret.data = reinterpret_cast<void *>(object);
+	return ret;
+}
+
+board board_open(const char *address)
+{
+	return boardStruct(KovanPool::instance()->open(address));
+}
+
+void board_close(board b)
+{
+	KovanPool::instance()->close(boardObject(b));
+}
+
+void board_set_register(board b, int reg, int value)
+{
+	if(!b.data || reg < 0) return;
+	KovanPool::instance()->write(boardObject(b), reg, value);
+}
+
+int board_get_register(board b, int reg)
+{
+	if(!b.data || reg < 0) return 0;
+	return KovanPool::instance()->read(boardObject(b), reg);
+}
+
+int board_publish(board b)
+{
+	if(!b.data) return 0;
+	return KovanPool::instance()->flush(boardObject(b)) ? 1 : 0;
+}
+
+int boards_publish()
+{
+	return KovanPool::instance()->flushAll();
+}
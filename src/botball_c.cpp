@@ -26,9 +26,9 @@ public:
 	
 	virtual void run()
 	{
-		const double start = seconds();
+		const double start = seconds_monotonic();
 		msleep(m_s * 1000.0);
-		const double end = seconds();
+		const double end = seconds_monotonic();
 		std::cout << std::endl << "Shutdown after " << (end - start) << " seconds" << std::endl;
 		// Note: Might want to move this to botui in the future.
 		Create::instance()->stop();
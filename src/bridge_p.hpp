@@ -0,0 +1,49 @@
+#ifndef _BRIDGE_P_HPP_
+#define _BRIDGE_P_HPP_
+
+#include "kovan_command_p.hpp"
+#include "delta_p.hpp"
+
+#include <stdint.h>
+
+#define BRIDGE_PORT 4629
+#define BRIDGE_MAX_COMMANDS 256
+#define BRIDGE_HISTORY 8
+
+namespace Private
+{
+	// Sent by RemoteKovanModule to kovan-bridge: the batched commands of one
+	// flush, plus the id of the newest state the client has decoded.
+	struct BridgeRequest
+	{
+		uint32_t seq;
+		uint32_t ackedState; // 0 if the client has no state yet
+		uint16_t num;
+		uint16_t reserved;
+		Command commands[1];
+	};
+	
+	// The board's state after the commands ran, as a StateDelta against the
+	// state with id base (0 means an all-zero state, i.e. a full update).
+	struct BridgeReply
+	{
+		uint32_t seq; // The request this answers
+		uint32_t state;
+		uint32_t base;
+		uint16_t length;
+		uint16_t reserved;
+		unsigned char delta[STATE_DELTA_MAX_SIZE];
+	};
+	
+	inline size_t bridgeRequestSize(const uint16_t num)
+	{
+		return sizeof(BridgeRequest) + sizeof(Command) * (num ? num - 1 : 0);
+	}
+	
+	inline size_t bridgeReplySize(const uint16_t length)
+	{
+		return sizeof(BridgeReply) - STATE_DELTA_MAX_SIZE + length;
+	}
+}
+
+#endif
@@ -21,10 +21,10 @@
 #include "button_p.hpp"
 #include "kovan_p.hpp"
 #include "kovan_regs_p.hpp"
+#include "warn.hpp"
 
 #include <cstring>
 #include <cstdio>
-#include <iostream>
 
 using namespace Private;
 
@@ -45,21 +45,29 @@ void Private::Button::setText(const ::Button::Type::Id &id, const char *text)
 			m_text[offset][j] << 8 | m_text[offset][j + 1]), false);
 	}
 	
-	unsigned short &dirty = Private::Kovan::instance()->currentState().t[BUTTON_TEXT_DIRTY];
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	unsigned short &dirty = kovan->currentState().t[BUTTON_TEXT_DIRTY];
 	dirty |= 1 << offset;
-	Private::Kovan::instance()->enqueueCommand(createWriteCommand(BUTTON_TEXT_DIRTY, dirty));
+	kovan->enqueueCommand(createWriteCommand(BUTTON_TEXT_DIRTY, dirty));
+	kovan->unlock();
 }
 
 bool Private::Button::isTextDirty(const ::Button::Type::Id &id) const
 {
-	Private::Kovan::instance()->autoUpdate();
 	const unsigned char offset = buttonOffset(id);
 	if(offset > 5) return false;
-	unsigned short &dirty = Private::Kovan::instance()->currentState().t[BUTTON_TEXT_DIRTY];
-	if(!((dirty >> offset) & 1)) return false;
-	dirty &= ~(1 << offset);
-	Private::Kovan::instance()->enqueueCommand(createWriteCommand(BUTTON_TEXT_DIRTY, dirty));
-	return true;
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	kovan->autoUpdate();
+	unsigned short &dirty = kovan->currentState().t[BUTTON_TEXT_DIRTY];
+	const bool ret = (dirty >> offset) & 1;
+	if(ret) {
+		dirty &= ~(1 << offset);
+		kovan->enqueueCommand(createWriteCommand(BUTTON_TEXT_DIRTY, dirty));
+	}
+	kovan->unlock();
+	return ret;
 }
 
 const char *Private::Button::text(const ::Button::Type::Id &id) const
@@ -71,13 +79,16 @@ const char *Private::Button::text(const ::Button::Type::Id &id) const
 	unsigned short end = 0;
 	if(!buttonRegs(start, end, id)) return 0;
 	
-	unsigned short *registers = Private::Kovan::instance()->currentState().t;
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	unsigned short *registers = kovan->currentState().t;
 	unsigned char j = 0;
 	for(unsigned short i = start; j < MAX_BUTTON_TEXT_SIZE && i <= end; ++i) {
 		m_text[offset][j++] = (registers[i] >> 8) & 0x00FF;
 		m_text[offset][j++] = registers[i] & 0x00FF;
 	}
 	m_text[offset][MAX_BUTTON_TEXT_SIZE - 1] = 0;
+	kovan->unlock();
 	return m_text[offset];
 }
 
@@ -85,41 +96,46 @@ void Private::Button::setPressed(const ::Button::Type::Id &id, bool pressed)
 {
 	const unsigned char offset = buttonOffset(id);
 	if(offset > 5) return;
-	unsigned short &states = Private::Kovan::instance()->currentState().t[BUTTON_STATES];
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	unsigned short &states = kovan->currentState().t[BUTTON_STATES];
 	if(pressed) states |= (1 << offset);
 	else states &= ~(1 << offset);
-	std::cout << "States: " << std::hex << states << std::endl;
-	Private::Kovan::instance()->enqueueCommand(createWriteCommand(BUTTON_STATES, states));
+	DEBUG_LOG("States: %x", states);
+	kovan->enqueueCommand(createWriteCommand(BUTTON_STATES, states));
+	kovan->unlock();
 }
 
 bool Private::Button::isPressed(const ::Button::Type::Id &id) const
 {
 	Private::Kovan::instance()->autoUpdate();
 	if(id == ::Button::Type::Side) {
-		return Private::Kovan::instance()->currentState().t[SIDE_BUTTON];
+		return Private::Kovan::instance()->registerValue(SIDE_BUTTON);
 	}
 	
 	const unsigned char offset = buttonOffset(id);
 	if(offset > 5) return false;
-	unsigned short &states = Private::Kovan::instance()->currentState().t[BUTTON_STATES];
+	const unsigned short states = Private::Kovan::instance()->registerValue(BUTTON_STATES);
 	// std::cout << "states: " << std::hex << states << std::endl;
 	return (states >> offset) & 1;
 }
 
 void Private::Button::setExtraShown(const bool& shown)
 {
-	unsigned short &states = Private::Kovan::instance()->currentState().t[BUTTON_STATES];
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	unsigned short &states = kovan->currentState().t[BUTTON_STATES];
 	unsigned short oldStates = states;
 	if(shown) states |= 0x8000;
 	else states &= 0x7FFF;
-	if(oldStates == states) return;
-	Private::Kovan::instance()->enqueueCommand(createWriteCommand(BUTTON_STATES, states));
+	if(oldStates != states) kovan->enqueueCommand(createWriteCommand(BUTTON_STATES, states));
+	kovan->unlock();
 }
 
 bool Private::Button::isExtraShown() const
 {
 	Private::Kovan::instance()->autoUpdate();
-	return Private::Kovan::instance()->currentState().t[BUTTON_STATES] & 0x8000;
+	return Private::Kovan::instance()->registerValue(BUTTON_STATES) & 0x8000;
 }
 
 void Private::Button::resetButtons()
@@ -1,10 +1,16 @@
 #include "kovan/camera.hpp"
-#include "kovan/ardrone.hpp"
+#include "kovan/trace.hpp"
+#include "kovan/metrics.hpp"
+#include "kovan/util.hpp"
+#include "kovan/task.hpp"
 #include "channel_p.hpp"
+#include "init_timer_p.hpp"
 #include "warn.hpp"
 
 #include <fstream>
+#include <algorithm>
 #include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
 
 using namespace Camera;
 
@@ -99,6 +105,20 @@ ObjectVector ChannelImpl::objects(const Config &config)
 	return findObjects(config);
 }
 
+bool ChannelImpl::mask(const Config &config, cv::Mat &mask)
+{
+	if(m_dirty) {
+		update(m_image);
+		m_dirty = false;
+	}
+	return findMask(config, mask);
+}
+
+bool ChannelImpl::findMask(const Config &config, cv::Mat &mask)
+{
+	return false;
+}
+
 ChannelImplManager::~ChannelImplManager()
 {
 }
@@ -133,7 +153,9 @@ Camera::Channel::Channel(Device *device, const Config &config)
 	: m_device(device),
 	m_config(config),
 	m_impl(0),
-	m_valid(false)
+	m_valid(false),
+	m_maskValid(false),
+	m_integralValid(false)
 {
 	m_objects.clear();
 	const std::string type = config.stringValue("type");
@@ -156,6 +178,8 @@ Camera::Channel::~Channel()
 void Camera::Channel::invalidate()
 {
 	m_valid = false;
+	m_maskValid = false;
+	m_integralValid = false;
 }
 
 struct AreaComparator
@@ -171,6 +195,7 @@ const ObjectVector *Camera::Channel::objects() const
 {
 	if(!m_impl) return 0;
 	if(!m_valid) {
+		KOVAN_TRACE_SPAN("Camera::Channel::objects");
 		m_objects.clear();
 		m_objects = m_impl->objects(m_config);
 		std::sort(m_objects.begin(), m_objects.end(), LargestAreaFirst);
@@ -179,6 +204,70 @@ const ObjectVector *Camera::Channel::objects() const
 	return &m_objects;
 }
 
+const cv::Mat *Camera::Channel::mask() const
+{
+	if(!m_impl) return 0;
+	if(!m_maskValid) {
+		KOVAN_TRACE_SPAN("Camera::Channel::mask");
+		if(!m_impl->mask(m_config, m_mask)) m_mask = cv::Mat();
+		m_maskValid = true;
+	}
+	return m_mask.empty() ? 0 : &m_mask;
+}
+
+bool Camera::Channel::updateIntegral() const
+{
+	if(m_integralValid) return !m_integral.empty();
+	const cv::Mat *const mask = this->mask();
+	if(mask) cv::integral(*mask, m_integral, CV_32S);
+	else m_integral = cv::Mat();
+	m_integralValid = true;
+	return mask;
+}
+
+// The mask is 0 or 255, so sums over it are 255 times the pixel count
+static int integralArea(const cv::Mat &integral, const int x0, const int y0,
+	const int x1, const int y1)
+{
+	const int sum = integral.at<int>(y1, x1) - integral.at<int>(y0, x1)
+		- integral.at<int>(y1, x0) + integral.at<int>(y0, x0);
+	return sum / 255;
+}
+
+int Camera::Channel::areaInRect(const Rectangle<unsigned> &rect) const
+{
+	if(!updateIntegral()) return -1;
+	
+	const int width = m_integral.cols - 1;
+	const int height = m_integral.rows - 1;
+	const int x0 = std::min<int>(rect.x(), width);
+	const int y0 = std::min<int>(rect.y(), height);
+	const int x1 = std::min<int>(rect.x() + rect.width(), width);
+	const int y1 = std::min<int>(rect.y() + rect.height(), height);
+	return integralArea(m_integral, x0, y0, x1, y1);
+}
+
+bool Camera::Channel::occupancy(const unsigned columns, const unsigned rows,
+	std::vector<double> &cells) const
+{
+	if(!columns || !rows || !updateIntegral()) return false;
+	
+	const int width = m_integral.cols - 1;
+	const int height = m_integral.rows - 1;
+	cells.resize(columns * rows);
+	for(unsigned r = 0; r < rows; ++r) {
+		const int y0 = r * height / rows;
+		const int y1 = (r + 1) * height / rows;
+		for(unsigned c = 0; c < columns; ++c) {
+			const int x0 = c * width / columns;
+			const int x1 = (c + 1) * width / columns;
+			const int size = (x1 - x0) * (y1 - y0);
+			cells[r * columns + c] = size ? (double)integralArea(m_integral, x0, y0, x1, y1) / size : 0.0;
+		}
+	}
+	return true;
+}
+
 Device *Camera::Channel::device() const
 {
 	return m_device;
@@ -296,12 +385,11 @@ bool UsbInputProvider::close()
 
 Camera::Device::Device(InputProvider *const inputProvider)
 	: m_inputProvider(inputProvider),
-	m_channelImplManager(new DefaultChannelImplManager)
+	m_configLoaded(false),
+	m_channelImplManager(new DefaultChannelImplManager),
+	m_frameSeq(0),
+	m_frameTimestamp(0)
 {
-	Config *config = Config::load(Camera::ConfigPath::defaultConfigPath());
-	if(!config) return;
-	setConfig(*config);
-	delete config;
 }
 
 Camera::Device::~Device()
@@ -313,6 +401,7 @@ Camera::Device::~Device()
 
 bool Camera::Device::open(const int number)
 {
+	loadDefaultConfig();
 	return m_inputProvider->open(number);
 }
 
@@ -336,13 +425,22 @@ bool Camera::Device::close()
 	return m_inputProvider->close();
 }
 
+static Counter s_framesProcessed("camera.frames_processed");
+static Counter s_framesDropped("camera.frames_dropped");
+
 bool Camera::Device::update()
 {
+	loadDefaultConfig();
+	
 	// Get new image
 	if(!m_inputProvider->next(m_image)) {
 		m_image = cv::Mat();
+		s_framesDropped.increment();
 		return false;
 	}
+	s_framesProcessed.increment();
+	m_frameTimestamp = Time::now();
+	++m_frameSeq;
 	
 	// No need to update channels if there are none.
 	if(m_channels.empty()) return true;
@@ -356,8 +454,71 @@ bool Camera::Device::update()
 	return true;
 }
 
+namespace
+{
+	// Channels of the same device can share a ChannelImpl, so a device's
+	// channels are processed in order on one worker
+	class UpdateTask : public Task
+	{
+	public:
+		UpdateTask(Camera::Device *const device)
+			: m_device(device),
+			m_updated(false)
+		{
+		}
+		
+		virtual void run()
+		{
+			m_updated = m_device->update();
+			if(!m_updated) return;
+			
+			const ChannelPtrVector &channels = m_device->channels();
+			ChannelPtrVector::const_iterator it = channels.begin();
+			for(; it != channels.end(); ++it) (*it)->objects();
+		}
+		
+		bool updated() const
+		{
+			return m_updated;
+		}
+		
+	private:
+		Camera::Device *const m_device;
+		bool m_updated;
+	};
+}
+
+static const double s_updateAllBounds[] = { 5000, 10000, 20000, 33000, 50000, 100000, 200000 };
+static Histogram s_updateAllTime("camera.update_all_us", s_updateAllBounds,
+	sizeof(s_updateAllBounds) / sizeof(double));
+
+unsigned Camera::Device::updateAll(Device *const *const devices, const unsigned count)
+{
+	KOVAN_TRACE_SPAN("Camera::Device::updateAll");
+	const unsigned long long start = Time::now();
+	
+	std::vector<UpdateTask *> tasks;
+	tasks.reserve(count);
+	for(unsigned i = 0; i < count; ++i) {
+		if(!devices[i]) continue;
+		tasks.push_back(new UpdateTask(devices[i]));
+		ThreadPool::instance()->submit(tasks.back());
+	}
+	
+	unsigned updated = 0;
+	for(std::vector<UpdateTask *>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+		(*it)->wait();
+		if((*it)->updated()) ++updated;
+		delete *it;
+	}
+	
+	s_updateAllTime.observe(Time::since(start) / 1000.0);
+	return updated;
+}
+
 const ChannelPtrVector &Camera::Device::channels() const
 {
+	const_cast<Device *>(this)->loadDefaultConfig();
 	return m_channels;
 }
 
@@ -371,14 +532,26 @@ const cv::Mat &Camera::Device::rawImage() const
 	return m_image;
 }
 
+unsigned long Camera::Device::frameSeq() const
+{
+	return m_frameSeq;
+}
+
+unsigned long long Camera::Device::frameTimestamp() const
+{
+	return m_frameTimestamp;
+}
+
 void Camera::Device::setConfig(const Config &config)
 {
+	m_configLoaded = true;
 	m_config = config;
 	updateConfig();
 }
 
 const Config &Camera::Device::config() const
 {
+	const_cast<Device *>(this)->loadDefaultConfig();
 	return m_config;
 }
 
@@ -393,6 +566,20 @@ ChannelImplManager *Camera::Device::channelImplManager() const
 	return m_channelImplManager;
 }
 
+static Gauge s_configTime("init.camera_config_us");
+
+void Camera::Device::loadDefaultConfig()
+{
+	if(m_configLoaded) return;
+	m_configLoaded = true;
+	
+	Private::InitTimer timer(s_configTime, "Camera::Device::loadDefaultConfig");
+	Config *config = Config::load(Camera::ConfigPath::defaultConfigPath());
+	if(!config) return;
+	setConfig(*config);
+	delete config;
+}
+
 void Camera::Device::updateConfig()
 {
 	ChannelPtrVector::const_iterator it = m_channels.begin();
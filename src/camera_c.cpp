@@ -1,9 +1,11 @@
 #include "kovan/camera.h"
 #include "kovan/camera.hpp"
 #include "nyi.h"
+#include "warn.hpp"
 
-#include <iostream>
 #include <cstdlib>
+#include <vector>
+#include <algorithm>
 
 class DeviceSingleton
 {
@@ -15,10 +17,23 @@ public:
 	}
 };
 
-int camera_open(enum Resolution res)
+static Camera::Device *cameraObject(camera c)
+{
+	return reinterpret_cast<Camera::Device *>(c.data);
+}
+
+static camera cameraStruct(Camera::Device *object)
+{
+	camera ret;
+	ret.data = reinterpret_cast<void *>(object);
+	return ret;
+}
+
+// These implement both the functions on the default camera and the ones
+// taking a handle
+
+static bool setResolution(Camera::Device *const device, const enum Resolution res)
 {
-	bool ret = DeviceSingleton::instance()->open();
-	if(!ret) return 0;
 	int width = 0;
 	int height = 0;
 	switch(res) {
@@ -35,41 +50,179 @@ int camera_open(enum Resolution res)
 		height = 480;
 		break;
 	}
-	DeviceSingleton::instance()->setWidth(width);
-	DeviceSingleton::instance()->setHeight(height);
-	return 1;
-}
-
-int camera_open_device(int number)
-{
-	return DeviceSingleton::instance()->open(number) ? 1 : 0;
+	device->setWidth(width);
+	device->setHeight(height);
+	return true;
 }
 
-int camera_load_config(const char *name)
+static int loadConfig(Camera::Device *const device, const char *name)
 {
 	Config *config = Config::load(Camera::ConfigPath::path(name));
 	if(!config) return 0;
-	DeviceSingleton::instance()->setConfig(*config);
+	device->setConfig(*config);
 	delete config;
 	return 1;
 }
 
-void set_camera_width(int width)
+static void setWidth(Camera::Device *const device, int width)
 {
 	if(width <= 0) {
-		std::cout << "Camera width must be greater than 0." << std::endl;
+		WARN("Camera width must be greater than 0");
 		return;
 	}
-	DeviceSingleton::instance()->setWidth(width);
+	device->setWidth(width);
 }
 
-void set_camera_height(int height)
+static void setHeight(Camera::Device *const device, int height)
 {
 	if(height <= 0) {
-		std::cout << "Camera height must be greater than 0." << std::endl;
+		WARN("Camera height must be greater than 0");
 		return;
 	}
-	DeviceSingleton::instance()->setHeight(height);
+	device->setHeight(height);
+}
+
+static bool checkChannel(Camera::Device *const device, int i)
+{
+	const Camera::ChannelPtrVector &channels = device->channels();
+	if(i < 0 || i >= channels.size()) {
+		WARN("Channel must be in the range 0 .. %d", (int)channels.size() - 1);
+		return false;
+	}
+	return true;
+}
+
+static bool checkChannelAndObject(Camera::Device *const device, int i, int j)
+{
+	const Camera::ChannelPtrVector &channels = device->channels();
+	if(i < 0 || i >= channels.size()) {
+		if(channels.size() < 1) WARN("Active configuration doesn't have any channels");
+		else WARN("Channel must be in the range 0 .. %d", (int)channels.size() - 1);
+		return false;
+	}
+	const Camera::ObjectVector *objs = channels[i]->objects();
+	if(j < 0 || j >= objs->size()) {
+		WARN("No such object %d", j);
+		return false;
+	}
+	return true;
+}
+
+static const Camera::Object &findObject(Camera::Device *const device, int channel, int object)
+{
+	return (*device->channels()[channel]->objects())[object];
+}
+
+static int objectCount(Camera::Device *const device, int channel)
+{
+	if(!checkChannel(device, channel)) return -1;
+	return device->channels()[channel]->objects()->size();
+}
+
+static int channelAreaInRect(Camera::Device *const device, int channel, rectangle rect)
+{
+	if(!checkChannel(device, channel)) return -1;
+	if(rect.ulx < 0) {
+		rect.width += rect.ulx;
+		rect.ulx = 0;
+	}
+	if(rect.uly < 0) {
+		rect.height += rect.uly;
+		rect.uly = 0;
+	}
+	if(rect.width <= 0 || rect.height <= 0) return 0;
+	return device->channels()[channel]->areaInRect(Rectangle<unsigned>(rect.ulx, rect.uly,
+		rect.width, rect.height));
+}
+
+static int channelOccupancy(Camera::Device *const device, int channel, int columns, int rows,
+	double *cells)
+{
+	if(!cells || columns <= 0 || rows <= 0) return 0;
+	if(!checkChannel(device, channel)) return 0;
+	std::vector<double> ret;
+	if(!device->channels()[channel]->occupancy(columns, rows, ret)) return 0;
+	std::copy(ret.begin(), ret.end(), cells);
+	return 1;
+}
+
+static double objectConfidence(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return 0.0;
+	return findObject(device, channel, o).confidence();
+}
+
+static const char *objectData(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return 0;
+	return findObject(device, channel, o).data();
+}
+
+static int codeNum(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return -1;
+	const char *data = objectData(device, channel, o);
+	if(!data) return 0;
+	return atoi(data);
+}
+
+static int objectDataLength(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return 0;
+	return findObject(device, channel, o).dataLength();
+}
+
+static int objectArea(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return -1;
+	return findObject(device, channel, o).boundingBox().area();
+}
+
+static rectangle objectBBox(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return create_rectangle(-1, -1, 0, 0);
+	return findObject(device, channel, o).boundingBox().toCRectangle();
+}
+
+static point2 objectCentroid(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return create_point2(-1, -1);
+	return findObject(device, channel, o).centroid().toCPoint2();
+}
+
+static point2 objectCenter(Camera::Device *const device, int channel, int o)
+{
+	if(!checkChannelAndObject(device, channel, o)) return create_point2(-1, -1);
+	return findObject(device, channel, o).boundingBox().center().toCPoint2();
+}
+
+// Default camera //
+
+int camera_open(enum Resolution res)
+{
+	bool ret = DeviceSingleton::instance()->open();
+	if(!ret) return 0;
+	return setResolution(DeviceSingleton::instance(), res) ? 1 : 0;
+}
+
+int camera_open_device(int number)
+{
+	return DeviceSingleton::instance()->open(number) ? 1 : 0;
+}
+
+int camera_load_config(const char *name)
+{
+	return loadConfig(DeviceSingleton::instance(), name);
+}
+
+void set_camera_width(int width)
+{
+	setWidth(DeviceSingleton::instance(), width);
+}
+
+void set_camera_height(int height)
+{
+	setHeight(DeviceSingleton::instance(), height);
 }
 
 int camera_update()
@@ -77,6 +230,16 @@ int camera_update()
 	return DeviceSingleton::instance()->update() ? 1 : 0;
 }
 
+unsigned long long get_camera_frame_timestamp()
+{
+	return DeviceSingleton::instance()->frameTimestamp();
+}
+
+unsigned long get_camera_frame_seq()
+{
+	return DeviceSingleton::instance()->frameSeq();
+}
+
 pixel get_camera_pixel(point2 p)
 {
 	nyi("get_camera_pixel");
@@ -87,98 +250,198 @@ int get_channel_count()
 	return DeviceSingleton::instance()->channels().size();
 }
 
-bool check_channel(int i)
+int get_object_count(int channel)
 {
-	const Camera::ChannelPtrVector &channels = DeviceSingleton::instance()->channels();
-	if(i < 0 || i >= channels.size()) {
-		std::cout << "Channel must be in the range 0 .. " << (channels.size() - 1) << std::endl;
-		return false;
-	}
-	return true;
+	return objectCount(DeviceSingleton::instance(), channel);
 }
 
-bool check_channel_and_object(int i, int j)
+int get_channel_area_in_rect(int channel, rectangle rect)
 {
-	const Camera::ChannelPtrVector &channels = DeviceSingleton::instance()->channels();
-	if(i < 0 || i >= channels.size()) {
-		if(channels.size() < 1) std::cout << "Active configuration doesn't have any channels.";
-		else std::cout << "Channel must be in the range 0 .. " << (channels.size() - 1);
-		std::cout << std::endl;
-		return false;
-	}
-	const Camera::ObjectVector *objs = channels[i]->objects();
-	if(j < 0 || j >= objs->size()) {
-		std::cout << "No such object " << j << std::endl;
-		return false;
-	}
-	return true;
+	return channelAreaInRect(DeviceSingleton::instance(), channel, rect);
 }
 
-int get_object_count(int channel)
+int get_channel_occupancy(int channel, int columns, int rows, double *cells)
 {
-	if(!check_channel(channel)) return -1;
-	return DeviceSingleton::instance()->channels()[channel]->objects()->size();
+	return channelOccupancy(DeviceSingleton::instance(), channel, columns, rows, cells);
 }
 
 double get_object_confidence(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return 0.0;
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.confidence();
+	return objectConfidence(DeviceSingleton::instance(), channel, object);
 }
 
-
 const char *get_object_data(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return 0;
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.data();
+	return objectData(DeviceSingleton::instance(), channel, object);
 }
 
 int get_code_num(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return -1;
-	const char *data = get_object_data(channel, object);
-	if(!data) return 0;
-	return atoi(data);
+	return codeNum(DeviceSingleton::instance(), channel, object);
 }
 
 int get_object_data_length(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return 0;
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.dataLength();
+	return objectDataLength(DeviceSingleton::instance(), channel, object);
 }
 
 int get_object_area(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return -1;
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.boundingBox().area();
+	return objectArea(DeviceSingleton::instance(), channel, object);
 }
 
 rectangle get_object_bbox(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return create_rectangle(-1, -1, 0, 0);
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.boundingBox().toCRectangle();
+	return objectBBox(DeviceSingleton::instance(), channel, object);
 }
 
 point2 get_object_centroid(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return create_point2(-1, -1);
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.centroid().toCPoint2();
+	return objectCentroid(DeviceSingleton::instance(), channel, object);
 }
 
 point2 get_object_center(int channel, int object)
 {
-	if(!check_channel_and_object(channel, object)) return create_point2(-1, -1);
-	const Camera::Object &o = (*DeviceSingleton::instance()->channels()[channel]->objects())[object];
-	return o.boundingBox().center().toCPoint2();
+	return objectCenter(DeviceSingleton::instance(), channel, object);
 }
 
 void camera_close()
 {
 	DeviceSingleton::instance()->close();
-}
\ No newline at end of file
+}
+
+// Camera handles //
+
+camera camera_open_handle(int number, enum Resolution res)
+{
+	Camera::Device *const device = new Camera::Device(new Camera::UsbInputProvider);
+	if(!device->open(number)) {
+		delete device;
+		return cameraStruct(0);
+	}
+	setResolution(device, res);
+	return cameraStruct(device);
+}
+
+void camera_close_handle(camera c)
+{
+	if(!c.data) return;
+	Camera::Device *const device = cameraObject(c);
+	device->close();
+	delete device;
+}
+
+int camera_load_config_h(camera c, const char *name)
+{
+	if(!c.data) return 0;
+	return loadConfig(cameraObject(c), name);
+}
+
+void set_camera_width_h(camera c, int width)
+{
+	if(!c.data) return;
+	setWidth(cameraObject(c), width);
+}
+
+void set_camera_height_h(camera c, int height)
+{
+	if(!c.data) return;
+	setHeight(cameraObject(c), height);
+}
+
+int camera_update_h(camera c)
+{
+	return camera_update_all(&c, 1);
+}
+
+int camera_update_all(const camera *cameras, int count)
+{
+	if(!cameras || count <= 0) return 0;
+	std::vector<Camera::Device *> devices(count);
+	for(int i = 0; i < count; ++i) devices[i] = cameraObject(cameras[i]);
+	return Camera::Device::updateAll(&devices[0], count);
+}
+
+unsigned long long get_camera_frame_timestamp_h(camera c)
+{
+	if(!c.data) return 0;
+	return cameraObject(c)->frameTimestamp();
+}
+
+unsigned long get_camera_frame_seq_h(camera c)
+{
+	if(!c.data) return 0;
+	return cameraObject(c)->frameSeq();
+}
+
+int get_channel_count_h(camera c)
+{
+	if(!c.data) return 0;
+	return cameraObject(c)->channels().size();
+}
+
+int get_object_count_h(camera c, int channel)
+{
+	if(!c.data) return -1;
+	return objectCount(cameraObject(c), channel);
+}
+
+int get_channel_area_in_rect_h(camera c, int channel, rectangle rect)
+{
+	if(!c.data) return -1;
+	return channelAreaInRect(cameraObject(c), channel, rect);
+}
+
+int get_channel_occupancy_h(camera c, int channel, int columns, int rows, double *cells)
+{
+	if(!c.data) return 0;
+	return channelOccupancy(cameraObject(c), channel, columns, rows, cells);
+}
+
+double get_object_confidence_h(camera c, int channel, int object)
+{
+	if(!c.data) return 0.0;
+	return objectConfidence(cameraObject(c), channel, object);
+}
+
+const char *get_object_data_h(camera c, int channel, int object)
+{
+	if(!c.data) return 0;
+	return objectData(cameraObject(c), channel, object);
+}
+
+int get_code_num_h(camera c, int channel, int object)
+{
+	if(!c.data) return -1;
+	return codeNum(cameraObject(c), channel, object);
+}
+
+int get_object_data_length_h(camera c, int channel, int object)
+{
+	if(!c.data) return 0;
+	return objectDataLength(cameraObject(c), channel, object);
+}
+
+int get_object_area_h(camera c, int channel, int object)
+{
+	if(!c.data) return -1;
+	return objectArea(cameraObject(c), channel, object);
+}
+
+rectangle get_object_bbox_h(camera c, int channel, int object)
+{
+	if(!c.data) return create_rectangle(-1, -1, 0, 0);
+	return objectBBox(cameraObject(c), channel, object);
+}
+
+point2 get_object_centroid_h(camera c, int channel, int object)
+{
+	if(!c.data) return create_point2(-1, -1);
+	return objectCentroid(cameraObject(c), channel, object);
+}
+
+point2 get_object_center_h(camera c, int channel, int object)
+{
+	if(!c.data) return create_point2(-1, -1);
+	return objectCenter(cameraObject(c), channel, object);
+}
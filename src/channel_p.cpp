@@ -21,40 +21,35 @@ void HsvChannelImpl::update(const cv::Mat &image)
 	cv::cvtColor(image, m_image, CV_BGR2HSV);
 }
 
-Camera::ObjectVector HsvChannelImpl::findObjects(const Config &config)
+bool HsvChannelImpl::findMask(const Config &config, cv::Mat &mask)
 {
-	if(m_image.empty()) return ::Camera::ObjectVector();
-	
+	if(m_image.empty()) return false;
 	
 	// TODO: This lookup is really slow compared to the rest of
 	// the algorithm.
-	cv::Vec3b top(config.intValue("th"),
+	const cv::Vec3b top(config.intValue("th"),
 		config.intValue("ts"), config.intValue("tv"));
-	cv::Vec3b bottom(config.intValue("bh"),
+	const cv::Vec3b bottom(config.intValue("bh"),
 		config.intValue("bs"), config.intValue("bv"));
 	
-	// std::cout << "top: <" << top[0] << ", " << top[1] << ", " << top[2] << ">" << std::endl;
-	
-	cv::Mat fixed = m_image;
-	if(bottom[0] > top[0]) {
-		// Modulo 180
-		// TODO: Optimize for ARM?
-		const uchar adjH = 180 - bottom[0];
-		for(int i = 0; i < fixed.rows; ++i) {
-			uchar *row = fixed.ptr<uchar>(i);
-			for(int j = 0; j < fixed.cols; ++j) {
-				row[j * fixed.elemSize()] += adjH;
-				row[j * fixed.elemSize()] %= 180;
-			}
-		}
-		
-		cv::Vec3b adj(adjH, 0, 0);
-		bottom = cv::Vec3b(0, bottom[1], bottom[2]);
-		cv::add(adj, top, top);
+	if(bottom[0] <= top[0]) {
+		cv::inRange(m_image, bottom, top, mask);
+		return true;
 	}
 	
+	// The hue range wraps around 180. m_image is shared with the other
+	// channels, so it's matched in two parts instead of being shifted.
+	cv::Mat upper;
+	cv::inRange(m_image, bottom, cv::Vec3b(179, top[1], top[2]), upper);
+	cv::inRange(m_image, cv::Vec3b(0, bottom[1], bottom[2]), top, mask);
+	cv::bitwise_or(mask, upper, mask);
+	return true;
+}
+
+Camera::ObjectVector HsvChannelImpl::findObjects(const Config &config)
+{
 	cv::Mat only;
-	cv::inRange(fixed, bottom, top, only);
+	if(!findMask(config, only)) return ::Camera::ObjectVector();
 	
 	std::vector<std::vector<cv::Point> > c;
 	cv::findContours(only, c, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_TC89_L1);
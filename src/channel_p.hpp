@@ -16,6 +16,7 @@ namespace Private
 			HsvChannelImpl();
 			virtual void update(const cv::Mat &image);
 			virtual ::Camera::ObjectVector findObjects(const Config &config);
+			virtual bool findMask(const Config &config, cv::Mat &mask);
 			
 		private:
 			cv::Mat m_image;
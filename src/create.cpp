@@ -1,6 +1,9 @@
 #include "kovan/create.hpp"
 #include "kovan/create_codes.h"
 #include "kovan/util.hpp"
+#include "kovan/trace.hpp"
+#include "kovan/metrics.hpp"
+#include "warn.hpp"
 
 #ifndef WIN32
 #include <fcntl.h>
@@ -49,6 +52,33 @@ using namespace CreatePackets;
 
 namespace CreateSensors
 {
+	// Stamps samples with the sensor packet they were read from
+	template<typename T>
+	class CreateSensor : public Sensor<T>
+	{
+	public:
+		CreateSensor(Create *create, const unsigned char packet)
+			: m_create(create),
+			m_packet(packet)
+		{
+		}
+		
+		virtual Sample<T> sample() const
+		{
+			m_create->beginAtomicOperation();
+			const Sample<T> ret(this->value(), m_create->packetTimestamp(m_packet),
+				m_create->packetSeq(m_packet));
+			m_create->endAtomicOperation();
+			return ret;
+		}
+		
+	protected:
+		Create *m_create;
+		
+	private:
+		unsigned char m_packet;
+	};
+	
 	class PlayButton : public AbstractButton
 	{
 	public:
@@ -79,331 +109,281 @@ namespace CreateSensors
 		Create *m_create;
 	};
 
-	class Wall : public Sensor<bool>
+	class Wall : public CreateSensor<bool>
 	{
 	public:
-		Wall(Create *create) : m_create(create) {}
+		Wall(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->wall;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffLeft : public Sensor<bool>
+	class CliffLeft : public CreateSensor<bool>
 	{
 	public:
-		CliffLeft(Create *create) : m_create(create) {}
+		CliffLeft(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->cliffLeft;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffFrontLeft : public Sensor<bool>
+	class CliffFrontLeft : public CreateSensor<bool>
 	{
 	public:
-		CliffFrontLeft(Create *create) : m_create(create) {}
+		CliffFrontLeft(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->cliffFrontLeft;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffFrontRight : public Sensor<bool>
+	class CliffFrontRight : public CreateSensor<bool>
 	{
 	public:
-		CliffFrontRight(Create *create) : m_create(create) {}
+		CliffFrontRight(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->cliffFrontRight;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffRight : public Sensor<bool>
+	class CliffRight : public CreateSensor<bool>
 	{
 	public:
-		CliffRight(Create *create) : m_create(create) {}
+		CliffRight(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->cliffRight;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class VirtualWall : public Sensor<bool>
+	class VirtualWall : public CreateSensor<bool>
 	{
 	public:
-		VirtualWall(Create *create) : m_create(create) {}
+		VirtualWall(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->virtualWall;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class WallSignal : public Sensor<unsigned short>
+	class WallSignal : public CreateSensor<unsigned short>
 	{
 	public:
-		WallSignal(Create *create) : m_create(create) {}
+		WallSignal(Create *create) : CreateSensor<unsigned short>(create, 4) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket4()->wallSignal);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffLeftSignal : public Sensor<unsigned short>
+	class CliffLeftSignal : public CreateSensor<unsigned short>
 	{
 	public:
-		CliffLeftSignal(Create *create) : m_create(create) {}
+		CliffLeftSignal(Create *create) : CreateSensor<unsigned short>(create, 4) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket4()->cliffLeftSignal);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffFrontLeftSignal : public Sensor<unsigned short>
+	class CliffFrontLeftSignal : public CreateSensor<unsigned short>
 	{
 	public:
-		CliffFrontLeftSignal(Create *create) : m_create(create) {}
+		CliffFrontLeftSignal(Create *create) : CreateSensor<unsigned short>(create, 4) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket4()->cliffFrontLeftSignal);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffFrontRightSignal : public Sensor<unsigned short>
+	class CliffFrontRightSignal : public CreateSensor<unsigned short>
 	{
 	public:
-		CliffFrontRightSignal(Create *create) : m_create(create) {}
+		CliffFrontRightSignal(Create *create) : CreateSensor<unsigned short>(create, 4) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket4()->cliffFrontRightSignal);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CliffRightSignal : public Sensor<unsigned short>
+	class CliffRightSignal : public CreateSensor<unsigned short>
 	{
 	public:
-		CliffRightSignal(Create *create) : m_create(create) {}
+		CliffRightSignal(Create *create) : CreateSensor<unsigned short>(create, 4) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket4()->cliffRightSignal);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class CargoBayAnalogSignal : public Sensor<unsigned short>
+	class CargoBayAnalogSignal : public CreateSensor<unsigned short>
 	{
 	public:
-		CargoBayAnalogSignal(Create *create) : m_create(create) {}
+		CargoBayAnalogSignal(Create *create) : CreateSensor<unsigned short>(create, 4) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket4()->userAnalogInput);
 		}
-	private:
-		Create *m_create;
 	};
 	
-	class CargoBayDigitalInputs : public Sensor<unsigned char>
+	class CargoBayDigitalInputs : public CreateSensor<unsigned char>
 	{
 	public:
-		CargoBayDigitalInputs(Create *create) : m_create(create) {}
+		CargoBayDigitalInputs(Create *create) : CreateSensor<unsigned char>(create, 4) {}
 
 		virtual unsigned char value() const
 		{
 			return m_create->sensorPacket4()->userDigitalInputs;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class IR : public Sensor<unsigned char>
+	class IR : public CreateSensor<unsigned char>
 	{
 	public:
-		IR(Create *create) : m_create(create) {}
+		IR(Create *create) : CreateSensor<unsigned char>(create, 2) {}
 
 		virtual unsigned char value() const
 		{
 			return m_create->sensorPacket2()->ir;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class ChargingState : public Sensor<unsigned char>
+	class ChargingState : public CreateSensor<unsigned char>
 	{
 	public:
-		ChargingState(Create *create) : m_create(create) {}
+		ChargingState(Create *create) : CreateSensor<unsigned char>(create, 3) {}
 
 		virtual unsigned char value() const
 		{
 			return m_create->sensorPacket3()->chargingState;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class BatteryTemperature : public Sensor<char>
+	class BatteryTemperature : public CreateSensor<char>
 	{
 	public:
-		BatteryTemperature(Create *create) : m_create(create) {}
+		BatteryTemperature(Create *create) : CreateSensor<char>(create, 3) {}
 
 		virtual char value() const
 		{
 			return m_create->sensorPacket3()->batteryTemperature;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class BatteryCharge : public Sensor<unsigned short>
+	class BatteryCharge : public CreateSensor<unsigned short>
 	{
 	public:
-		BatteryCharge(Create *create) : m_create(create) {}
+		BatteryCharge(Create *create) : CreateSensor<unsigned short>(create, 3) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket3()->batteryCharge);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class BatteryCapacity : public Sensor<unsigned short>
+	class BatteryCapacity : public CreateSensor<unsigned short>
 	{
 	public:
-		BatteryCapacity(Create *create) : m_create(create) {}
+		BatteryCapacity(Create *create) : CreateSensor<unsigned short>(create, 3) {}
 
 		virtual unsigned short value() const
 		{
 			return SHORT(m_create->sensorPacket3()->batteryCapacity);
 		}
-	private:
-		Create *m_create;
 	};
 
-	class Angle : public Sensor<int>
+	class Angle : public CreateSensor<int>
 	{
 	public:
-		Angle(Create *create) : m_create(create) {}
+		Angle(Create *create) : CreateSensor<int>(create, 2) {}
 
 		virtual int value() const
 		{
 			m_create->sensorPacket2();
 			return m_create->state()->angle;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class Distance : public Sensor<int>
+	class Distance : public CreateSensor<int>
 	{
 	public:
-		Distance(Create *create) : m_create(create) {}
+		Distance(Create *create) : CreateSensor<int>(create, 2) {}
 
 		virtual int value() const
 		{
 			m_create->sensorPacket2();
 			return m_create->state()->distance;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class BumpLeft : public Sensor<bool>
+	class BumpLeft : public CreateSensor<bool>
 	{
 	public:
-		BumpLeft(Create *create) : m_create(create) {}
+		BumpLeft(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->bumpsAndWheelDrops & 0x02;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class BumpRight : public Sensor<bool>
+	class BumpRight : public CreateSensor<bool>
 	{
 	public:
-		BumpRight(Create *create) : m_create(create) {}
+		BumpRight(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->bumpsAndWheelDrops & 0x01;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class WheelDropRight : public Sensor<bool>
+	class WheelDropRight : public CreateSensor<bool>
 	{
 	public:
-		WheelDropRight(Create *create) : m_create(create) {}
+		WheelDropRight(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->bumpsAndWheelDrops & 0x04;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class WheelDropLeft : public Sensor<bool>
+	class WheelDropLeft : public CreateSensor<bool>
 	{
 	public:
-		WheelDropLeft(Create *create) : m_create(create) {}
+		WheelDropLeft(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->bumpsAndWheelDrops & 0x08;
 		}
-	private:
-		Create *m_create;
 	};
 
-	class WheelDropCaster : public Sensor<bool>
+	class WheelDropCaster : public CreateSensor<bool>
 	{
 	public:
-		WheelDropCaster(Create *create) : m_create(create) {}
+		WheelDropCaster(Create *create) : CreateSensor<bool>(create, 1) {}
 
 		virtual bool value() const
 		{
 			return m_create->sensorPacket1()->bumpsAndWheelDrops & 0x10;
 		}
-	private:
-		Create *m_create;
 	};
 }
 
@@ -635,6 +615,11 @@ void Create::send(const CreateScript& script)
 	m_script = script;
 }
 
+static Counter s_bytesWritten("create.bytes_written");
+static Counter s_bytesRead("create.bytes_read");
+static Counter s_shortWrites("create.short_writes");
+static Counter s_readTimeouts("create.read_timeouts");
+
 bool Create::write(const unsigned char& c)
 {
 	return write(&c, 1);
@@ -645,12 +630,12 @@ bool Create::write(const unsigned char *data, const size_t& len)
 	if(!m_tty) return false;
 #ifndef WIN32
 	int ret = ::write(m_tty, data, len);
-	if(ret != len) {
-		printf("Only wrote %d of %ld bytes\n", ret, len);
-	}
-	if(ret < 0) perror("::write");
+	if(ret > 0) s_bytesWritten.increment(ret);
+	if(ret != (ssize_t)len) s_shortWrites.increment();
+	if(ret < 0) PWARN("write failed");
+	else if(ret != (ssize_t)len) WARN("Only wrote %d of %lu bytes", ret, (unsigned long)len);
 	tcdrain(m_tty);
-	return ret == len;
+	return ret == (ssize_t)len;
 #else
 	#warning Create library not yet implemented for Windows
 #endif
@@ -680,30 +665,28 @@ int Create::read(unsigned char *data, const size_t& len)
 #else
 	#warning Create library not yet implemented for Windows
 #endif
-	if(ret < 0 && errno != EAGAIN) perror("::read");
+	if(ret < 0 && errno != EAGAIN) PWARN("read failed");
+	if(ret > 0) s_bytesRead.increment(ret);
 	return ret;
 }
 
 bool Create::blockingRead(unsigned char *data, const size_t& size, unsigned timeout)
 {
 	if(!isConnected()) return false;
-	timeval start = timeOfDay();
+	KOVAN_TRACE_SPAN("Create::blockingRead");
+	const unsigned long long start = Time::now();
 	
 	size_t total = 0;
-	long msecs = 0;
+	unsigned long msecs = 0;
 	do {
 		int ret = read(data + total, size - total);
 		if(ret < 0 && errno != EAGAIN) return false;
 		if(ret > 0) total += ret;
-#ifndef WIN32
-		timeval current = timeOfDay();
-		timeval diff;
-		timersub(&current, &start, &diff);
-		msecs = diff.tv_sec * 1000 + diff.tv_usec / 1000;
-#endif
+		msecs = Time::msecsSince(start);
 		// printf("msecs: %ld, %ld of %ld\n", msecs, total, size);
 		usleep(5000);
 	} while(total < size && msecs < timeout);
+	if(msecs >= timeout) s_readTimeouts.increment();
 	return msecs < timeout;
 }
 
@@ -767,10 +750,7 @@ void Create::turn(const short& angle, const unsigned short& speed)
 	const short goalAngle = m_state.angle + angle;
 	double timeToGoal = (deg2rad(angle + 360 / angle) * 258) / angularVelocity();
 	// printf("Time to Goal: %f (rad = %f, av = %d)\n", timeToGoal, deg2rad(angle), angularVelocity());
-	double startTime = timevalToFloat(timeOfDay());
 	usleep(timeToGoal * 1000000L - 300);
-	double elapsed = timevalToFloat(timeOfDay());
-	// printf("Diff: %lf\n", elapsed - startTime - timeToGoal);
 	spin(0);
 }
 
@@ -781,10 +761,7 @@ void Create::move(const short& millimeters, const unsigned short& speed)
 	const short goalDistance = m_state.distance + millimeters;
 	double timeToGoal = ((double)millimeters) / speed;
 	// printf("Time to Goal: %f (milli = %d, s = %d)\n", timeToGoal, millimeters, speed);
-	double startTime = timevalToFloat(timeOfDay());
 	usleep(timeToGoal * 1000000L - 300);
-	double elapsed = timevalToFloat(timeOfDay());
-	// printf("Diff: %lf\n", elapsed - startTime - timeToGoal);
 	driveDirect(0, 0);
 }
 
@@ -869,6 +846,18 @@ const CreatePackets::_5 *Create::sensorPacket5()
 	return &m_5;
 }
 
+unsigned long long Create::packetTimestamp(const unsigned char packet) const
+{
+	if(packet < 1 || packet > 5) return 0;
+	return timestamps[packet - 1];
+}
+
+unsigned long Create::packetSeq(const unsigned char packet) const
+{
+	if(packet < 1 || packet > 5) return 0;
+	return m_packetSeqs[packet - 1];
+}
+
 AbstractButton *Create::playButton() const LAZY_RETURN(m_playButton);
 AbstractButton *Create::advanceButton() const LAZY_RETURN(m_advanceButton);
 Sensor<bool> *Create::wall() const LAZY_RETURN(m_wall);
@@ -944,9 +933,16 @@ Create::Create()
 	m_wheelDropCaster(0)
 {
 #ifndef WIN32
-	pthread_mutex_init(&m_mutex, 0);
+	// Recursive so samples can hold it across a refresh
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&m_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
 #endif
 	memset(&m_state, 0, sizeof(CreateState));
+	memset(timestamps, 0, sizeof(timestamps));
+	memset(m_packetSeqs, 0, sizeof(m_packetSeqs));
 }
 
 Create::Create(const Create&) {}
@@ -989,7 +985,7 @@ bool Create::open()
 #endif
 	endAtomicOperation();
 	
-	if(m_tty < 0) perror("Create::open");
+	if(m_tty < 0) PWARN("failed to open /dev/ttyS2");
 	
 	return m_tty >= 0;
 }
@@ -1007,7 +1003,7 @@ void Create::close()
 
 void Create::updateState()
 {
-	m_state.timestamp = timeOfDay();
+	m_state.timestamp = Time::now();
 }
 
 void printArray(const unsigned char *array, const size_t& size) {
@@ -1028,7 +1024,8 @@ void Create::updateSensorPacket1()
 	write(OI_SENSORS);
 	write(1);
 	blockingRead(m_1);
-	timestamps[0] = timeOfDay();
+	timestamps[0] = Time::now();
+	++m_packetSeqs[0];
 	endAtomicOperation();
 }
 
@@ -1040,7 +1037,8 @@ void Create::updateSensorPacket2(bool forceUpdate)
 	write(OI_SENSORS);
 	write(2);
 	blockingRead(m_2);
-	timestamps[1] = timeOfDay();
+	timestamps[1] = Time::now();
+	++m_packetSeqs[1];
 	m_state.distance += SHORT(m_2.distance);
 	m_state.angle += SHORT(m_2.angle);
 	endAtomicOperation();
@@ -1054,7 +1052,8 @@ void Create::updateSensorPacket3()
 	write(OI_SENSORS);
 	write(3);
 	blockingRead(m_3);
-	timestamps[2] = timeOfDay();
+	timestamps[2] = Time::now();
+	++m_packetSeqs[2];
 	endAtomicOperation();
 }
 
@@ -1066,7 +1065,8 @@ void Create::updateSensorPacket4()
 	write(OI_SENSORS);
 	write(4);
 	blockingRead(m_4);
-	timestamps[3] = timeOfDay();
+	timestamps[3] = Time::now();
+	++m_packetSeqs[3];
 	endAtomicOperation();
 }
 
@@ -1078,6 +1078,7 @@ void Create::updateSensorPacket5()
 	write(OI_SENSORS);
 	write(5);
 	blockingRead(m_5);
-	timestamps[4] = timeOfDay();
+	timestamps[4] = Time::now();
+	++m_packetSeqs[4];
 	endAtomicOperation();
 }
\ No newline at end of file
@@ -20,6 +20,7 @@
 
 #include "kovan/create.h"
 #include "kovan/create.hpp"
+#include "sample_p.hpp"
 
 #include <climits>
 
@@ -184,6 +185,18 @@ void set_create_distance(int dist)
 	Create::instance()->setDistance(dist);
 }
 
+int get_create_total_angle_sample(sensor_sample *sample)
+{
+	if(!sample) return 0;
+	return Private::copySample(Create::instance()->angle()->sample(), sample);
+}
+
+int get_create_distance_sample(sensor_sample *sample)
+{
+	if(!sample) return 0;
+	return Private::copySample(Create::instance()->distance()->sample(), sample);
+}
+
 int get_create_battery_charging_state()
 {
 	return Create::instance()->chargingState()->value();
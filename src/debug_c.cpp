@@ -5,7 +5,12 @@
 
 void debug_print_registers()
 {
-	const unsigned short *regs = Private::Kovan::instance()->currentState().t;
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	const Private::State state = kovan->currentState();
+	kovan->unlock();
+	
+	const unsigned short *regs = state.t;
 	std::cout << "[";
 	for(int i = 0; i < TOTAL_REGS; ++i) {
 		std::cout << i << ": " << regs[i];
@@ -20,5 +25,5 @@ void debug_print_registers()
 unsigned short register_value(unsigned short addy)
 {
 	if(addy >= TOTAL_REGS) return 0xFFFF;
-	return Private::Kovan::instance()->currentState().t[addy];
+	return Private::Kovan::instance()->registerValue(addy);
 }
\ No newline at end of file
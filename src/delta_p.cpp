@@ -0,0 +1,65 @@
+#include "delta_p.hpp"
+
+#include <cstring>
+
+using namespace Private;
+
+size_t StateDelta::encode(const State &base, const State &current,
+	unsigned char *const out, const size_t size)
+{
+	size_t pos = 0;
+	unsigned i = 0;
+	while(i < TOTAL_REGS) {
+		unsigned unchanged = 0;
+		while(i + unchanged < TOTAL_REGS
+			&& base.t[i + unchanged] == current.t[i + unchanged]) ++unchanged;
+		
+		// Trailing unchanged registers don't need a run
+		if(i + unchanged == TOTAL_REGS) break;
+		i += unchanged;
+		
+		// Skips too long for one count become runs with nothing changed
+		for(; unchanged > STATE_DELTA_MAX_RUN; unchanged -= STATE_DELTA_MAX_RUN) {
+			if(pos + 2 > size) return 0;
+			out[pos++] = STATE_DELTA_MAX_RUN;
+			out[pos++] = 0;
+		}
+		
+		unsigned changed = 0;
+		while(i + changed < TOTAL_REGS && changed < STATE_DELTA_MAX_RUN
+			&& base.t[i + changed] != current.t[i + changed]) ++changed;
+		
+		if(pos + 2 + changed * 2 > size) return 0;
+		out[pos++] = unchanged;
+		out[pos++] = changed;
+		for(unsigned j = 0; j < changed; ++j, ++i) {
+			const unsigned short x = base.t[i] ^ current.t[i];
+			out[pos++] = x & 0xFF;
+			out[pos++] = x >> 8;
+		}
+	}
+	return pos;
+}
+
+bool StateDelta::decode(const State &base, const unsigned char *const in,
+	const size_t size, State &state)
+{
+	State ret;
+	memcpy(&ret, &base, sizeof(State));
+	
+	size_t pos = 0;
+	unsigned i = 0;
+	while(pos < size) {
+		if(pos + 2 > size) return false;
+		i += in[pos++];
+		const unsigned changed = in[pos++];
+		if(i + changed > TOTAL_REGS || pos + changed * 2 > size) return false;
+		
+		for(unsigned j = 0; j < changed; ++j, ++i, pos += 2) {
+			ret.t[i] ^= in[pos] | (in[pos + 1] << 8);
+		}
+	}
+	
+	memcpy(&state, &ret, sizeof(State));
+	return true;
+}
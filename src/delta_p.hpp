@@ -0,0 +1,36 @@
+#ifndef _DELTA_P_HPP_
+#define _DELTA_P_HPP_
+
+#include "kovan_command_p.hpp"
+
+#include <cstddef>
+
+// Worst case: one header per changed register plus its value
+#define STATE_DELTA_MAX_SIZE (TOTAL_REGS * 4)
+
+// Longest run a single count can describe. Longer runs are split.
+#ifndef STATE_DELTA_MAX_RUN
+#define STATE_DELTA_MAX_RUN 255
+#endif
+
+namespace Private
+{
+	// Encodes a State as the XOR of its registers with a base State the
+	// other side already has. Unchanged registers are run-length encoded as
+	// a sequence of runs:
+	//   [unchanged count] [changed count] [changed count XOR values, little endian]
+	// Counts are one byte each. An unchanged state encodes to zero bytes.
+	class StateDelta
+	{
+	public:
+		// Returns the encoded size, or 0 if out is too small (or nothing changed)
+		static size_t encode(const State &base, const State &current,
+			unsigned char *const out, const size_t size);
+		
+		// Returns false if the delta is malformed, in which case state is unchanged
+		static bool decode(const State &base, const unsigned char *const in,
+			const size_t size, State &state);
+	};
+}
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "kovan/digital.hpp"
 #include "digital_p.hpp"
+#include "kovan_p.hpp"
 
 Digital::Digital(const unsigned char& port)
 	: m_port(port)
@@ -37,6 +38,15 @@ bool Digital::value() const
 	return Private::Digital::instance()->value(m_port);
 }
 
+Sample<bool> Digital::sample() const
+{
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	const Sample<bool> ret(value(), kovan->stateTimestamp(), kovan->stateSeq());
+	kovan->unlock();
+	return ret;
+}
+
 void Digital::setOutput(const bool& output)
 {
 	Private::Digital::instance()->setDirection(m_port, output ? Private::Digital::Out : Private::Digital::In);
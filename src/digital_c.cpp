@@ -19,7 +19,9 @@
  **************************************************************************/
 
 #include "kovan/digital.h"
+#include "kovan/digital.hpp"
 #include "digital_p.hpp"
+#include "sample_p.hpp"
 
 int digital(int port)
 {
@@ -36,6 +38,12 @@ int get_digital_value(int port)
 	return Private::Digital::instance()->value(port);
 }
 
+int get_digital_value_sample(int port, sensor_sample *sample)
+{
+	if(!sample) return 0;
+	return Private::copySample(Digital(port).sample(), sample);
+}
+
 void set_digital_output(int port, int out)
 {
 	Private::Digital::instance()->setDirection(port, out ? Private::Digital::Out : Private::Digital::In);
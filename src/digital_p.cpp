@@ -36,7 +36,7 @@ bool Digital::value(const unsigned char& port) const
 	const unsigned char actualPort = 7 - (port - 8);
 	if(actualPort > 7) return false;
 	Private::Kovan::instance()->autoUpdate();
-	bool ret = Private::Kovan::instance()->currentState().t[DIG_IN] & (1 << actualPort);
+	bool ret = Private::Kovan::instance()->registerValue(DIG_IN) & (1 << actualPort);
 	return ret;
 }
 
@@ -45,12 +45,14 @@ bool Digital::setValue(const unsigned char& port, const bool& value)
 	const unsigned char actualPort = 7 - (port - 8);
 	if(actualPort > 7) return false;
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	unsigned short &out = kovan->currentState().t[DIG_OUT];
 	
 	if(value) out |= (1 << actualPort);
 	else out &= ~(1 << actualPort);
 	
 	kovan->enqueueCommand(createWriteCommand(DIG_OUT, out));
+	kovan->unlock();
 	return true;
 }
 
@@ -60,7 +62,7 @@ const Digital::Direction Digital::direction(const unsigned char& port) const
 	if(actualPort > 7) return Digital::Unknown;
 	Private::Kovan *kovan = Private::Kovan::instance();
 	kovan->autoUpdate();
-	Digital::Direction ret = kovan->currentState().t[DIG_OUT_ENABLE] & (1 << actualPort) ? Digital::Out : Digital::In;
+	Digital::Direction ret = kovan->registerValue(DIG_OUT_ENABLE) & (1 << actualPort) ? Digital::Out : Digital::In;
 	return ret;
 }
 
@@ -69,12 +71,14 @@ bool Digital::setDirection(const unsigned char& port, const Digital::Direction&
 	const unsigned char actualPort = 7 - (port - 8);
 	if(actualPort > 7) return false;
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	unsigned short &dir = kovan->currentState().t[DIG_OUT_ENABLE];
 	
 	if(direction == Digital::Out) dir |= (1 << actualPort);
 	else dir &= ~(1 << actualPort);
 	
 	kovan->enqueueCommand(createWriteCommand(DIG_OUT_ENABLE, dir));
+	kovan->unlock();
 	return false;
 }
 
@@ -83,7 +87,7 @@ bool Digital::pullup(const unsigned char& port) const
 	const unsigned char actualPort = 7 - (port - 8);
 	if(actualPort > 15) return false;
 	Private::Kovan::instance()->autoUpdate();
-	bool ret = Private::Kovan::instance()->currentState().t[DIG_PULLUPS] & (1 << actualPort);
+	bool ret = Private::Kovan::instance()->registerValue(DIG_PULLUPS) & (1 << actualPort);
 	return ret;
 }
 
@@ -92,12 +96,14 @@ bool Digital::setPullup(const unsigned char& port, const bool& pullup)
 	const unsigned char actualPort = 7 - (port - 8);
 	if(actualPort > 7) return false;
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	unsigned short &pullups = kovan->currentState().t[DIG_PULLUPS];
 	
 	if(pullup) pullups |= (1 << actualPort);
 	else pullups &= ~(1 << actualPort);
 	
 	kovan->enqueueCommand(createWriteCommand(DIG_PULLUPS, pullups));
+	kovan->unlock();
 	return true;
 }
 
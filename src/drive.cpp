@@ -0,0 +1,289 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/drive.hpp"
+#include "kovan/metrics.hpp"
+#include "kovan_p.hpp"
+#include "motors_p.hpp"
+#include "stall_p.hpp"
+#include "time_p.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#define DRIVE_KP 2.0 // 1/s, how quickly position errors are corrected
+#define DRIVE_TOLERANCE 10 // ticks
+#define DRIVE_SETTLE_TIME 500 // ms after the profile ends
+#define DRIVE_DEFAULT_SPEED 300.0 // mm/s
+#define DRIVE_DEFAULT_ACCELERATION 600.0 // mm/s^2
+
+static Counter s_driveMoves("drive.moves");
+static Counter s_driveTimeouts("drive.timeouts");
+static Counter s_driveStalls("drive.stalls");
+static Counter s_driveUnsettled("drive.unsettled");
+
+DriveGeometry::DriveGeometry()
+	: leftMotor(0),
+	rightMotor(1),
+	wheelDiameter(0.0),
+	wheelBase(0.0),
+	ticksPerRevolution(0.0)
+{
+}
+
+DriveMove::~DriveMove()
+{
+	if(!m_controller) return;
+	m_controller->m_mutex.lock();
+	if(m_controller->m_move == this) {
+		m_controller->m_move = 0;
+		m_controller->m_stopPending = true;
+	}
+	std::vector<DriveMove *> &moves = m_controller->m_moves;
+	moves.erase(std::remove(moves.begin(), moves.end(), this), moves.end());
+	m_controller->m_mutex.unlock();
+}
+
+DriveMove::Status DriveMove::status() const
+{
+	if(!m_controller) return m_status;
+	m_controller->m_mutex.lock();
+	const Status ret = m_status;
+	m_controller->m_mutex.unlock();
+	return ret;
+}
+
+DriveMove::Status DriveMove::wait() const
+{
+	// m_controller is cleared while we wait if the controller goes away
+	DriveController *const controller = m_controller;
+	if(!controller) return m_status;
+	controller->m_mutex.lock();
+	++controller->m_waiters;
+	while(m_status == Running) controller->m_condition.wait(controller->m_mutex);
+	const Status ret = m_status;
+	--controller->m_waiters;
+	controller->m_condition.broadcast();
+	controller->m_mutex.unlock();
+	return ret;
+}
+
+DriveMove::DriveMove(DriveController *const controller, const double left, const double right,
+	const double speed, const unsigned long deadline)
+	: m_controller(controller),
+	m_status(Running),
+	m_left(left),
+	m_right(right),
+	m_speed(speed),
+	m_deadline(deadline ? Private::Time::monotonic() + deadline * 1000000ULL : 0),
+	m_distance(0.0),
+	m_velocity(0.0),
+	m_leftStart(0),
+	m_rightStart(0),
+	m_lastTick(0),
+	m_settleStart(0)
+{
+}
+
+DriveController::DriveController(const DriveGeometry &geometry)
+	: m_geometry(geometry),
+	m_maxSpeed(DRIVE_DEFAULT_SPEED),
+	m_acceleration(DRIVE_DEFAULT_ACCELERATION),
+	m_move(0),
+	m_stopPending(false),
+	m_waiters(0)
+{
+	PeriodicExecutor::instance()->add(this, DRIVE_PERIOD);
+}
+
+DriveController::~DriveController()
+{
+	PeriodicExecutor::instance()->remove(this);
+	m_mutex.lock();
+	if(m_move) finish(DriveMove::Cancelled);
+	
+	// Outstanding moves outlive us, so they must stop pointing here
+	for(std::vector<DriveMove *>::iterator it = m_moves.begin(); it != m_moves.end(); ++it) {
+		(*it)->m_controller = 0;
+	}
+	m_moves.clear();
+	
+	// Waiters still need our mutex to return
+	while(m_waiters) m_condition.wait(m_mutex);
+	m_mutex.unlock();
+}
+
+const DriveGeometry &DriveController::geometry() const
+{
+	return m_geometry;
+}
+
+void DriveController::setLimits(const double maxSpeed, const double acceleration)
+{
+	m_mutex.lock();
+	m_maxSpeed = maxSpeed;
+	m_acceleration = acceleration;
+	m_mutex.unlock();
+}
+
+DriveMove *DriveController::driveDistance(const double distance, const double speed, const unsigned long deadline)
+{
+	return start(distance, distance, speed, deadline);
+}
+
+DriveMove *DriveController::driveArc(const double radius, const double degrees, const double speed,
+	const unsigned long deadline)
+{
+	const double radians = degrees * M_PI / 180.0;
+	const double half = m_geometry.wheelBase / 2.0;
+	return start(radians * (radius - half), radians * (radius + half), speed, deadline);
+}
+
+DriveMove *DriveController::turnAngle(const double degrees, const double speed, const unsigned long deadline)
+{
+	const double wheel = degrees * M_PI / 180.0 * m_geometry.wheelBase / 2.0;
+	return start(-wheel, wheel, speed, deadline);
+}
+
+void DriveController::stop()
+{
+	m_mutex.lock();
+	if(m_move) finish(DriveMove::Cancelled);
+	m_stopPending = true;
+	m_mutex.unlock();
+}
+
+void DriveController::run()
+{
+	m_mutex.lock();
+	DriveMove *const move = m_move;
+	if(!move && !m_stopPending) {
+		m_mutex.unlock();
+		return;
+	}
+	
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	Private::Motor *const motor = Private::Motor::instance();
+	const port_t leftPort = m_geometry.leftMotor;
+	const port_t rightPort = m_geometry.rightMotor;
+	
+	// Steering needs this period's positions. Replies are swapped into the
+	// state under the lock, so readers on other threads never see a
+	// partial one, and both wheels are read from the same reply.
+	kovan->lock();
+	kovan->autoUpdate();
+	
+	DriveMove::Status status = move ? DriveMove::Running : DriveMove::Cancelled;
+	const unsigned long long now = Private::Time::monotonic();
+	const int left = motor->backEMF(leftPort, false);
+	const int right = motor->backEMF(rightPort, false);
+	double leftVelocity = 0.0;
+	double rightVelocity = 0.0;
+	
+	if(move && !move->m_lastTick) {
+		move->m_leftStart = left;
+		move->m_rightStart = right;
+		move->m_lastTick = now;
+	}
+	
+	if(move) {
+		if(move->m_deadline && now >= move->m_deadline) status = DriveMove::TimedOut;
+		else if(Private::StallMonitor::instance()->stalled(leftPort)
+			|| Private::StallMonitor::instance()->stalled(rightPort)) status = DriveMove::Stalled;
+		else status = advance(move, now, left, right, leftVelocity, rightVelocity);
+	}
+	
+	// Queue both setpoints so they go out in one packet
+	if(status == DriveMove::Running) {
+		motor->setControlMode(leftPort, Private::Motor::Speed, false);
+		motor->setPidVelocity(leftPort, (int)leftVelocity, false);
+		motor->setControlMode(rightPort, Private::Motor::Speed, false);
+		motor->setPidVelocity(rightPort, (int)rightVelocity, false);
+	} else {
+		motor->stop(leftPort, false);
+		motor->stop(rightPort, false);
+		m_stopPending = false;
+	}
+	
+	kovan->flush();
+	kovan->unlock();
+	
+	if(move && status != DriveMove::Running) finish(status);
+	m_mutex.unlock();
+}
+
+DriveMove::Status DriveController::advance(DriveMove *const move, const unsigned long long now,
+	const int left, const int right, double &leftVelocity, double &rightVelocity)
+{
+	// Profile the wheel that has further to go; the other follows in proportion
+	const double total = std::max(std::fabs(move->m_left), std::fabs(move->m_right));
+	const double dt = (now - move->m_lastTick) / 1e9;
+	move->m_lastTick = now;
+	
+	const double cruise = std::min(std::fabs(move->m_speed), m_maxSpeed);
+	const double remaining = total - move->m_distance;
+	double velocity = std::min(cruise, move->m_velocity + m_acceleration * dt);
+	velocity = std::min(velocity, std::sqrt(2.0 * m_acceleration * std::max(remaining, 0.0)));
+	move->m_distance = std::min(total, move->m_distance + velocity * dt);
+	if(move->m_distance >= total) velocity = 0.0;
+	move->m_velocity = velocity;
+	
+	const double ticksPerMm = m_geometry.ticksPerRevolution / (M_PI * m_geometry.wheelDiameter);
+	const double leftRatio = total > 0.0 ? move->m_left / total : 0.0;
+	const double rightRatio = total > 0.0 ? move->m_right / total : 0.0;
+	const double leftError = move->m_leftStart + leftRatio * move->m_distance * ticksPerMm - left;
+	const double rightError = move->m_rightStart + rightRatio * move->m_distance * ticksPerMm - right;
+	leftVelocity = leftRatio * velocity * ticksPerMm + DRIVE_KP * leftError;
+	rightVelocity = rightRatio * velocity * ticksPerMm + DRIVE_KP * rightError;
+	
+	if(move->m_distance < total) return DriveMove::Running;
+	
+	// Give the wheels a moment to catch up with the end of the profile
+	if(!move->m_settleStart) move->m_settleStart = now;
+	const bool settled = std::fabs(leftError) <= DRIVE_TOLERANCE && std::fabs(rightError) <= DRIVE_TOLERANCE;
+	if(settled) return DriveMove::Done;
+	if(now - move->m_settleStart >= DRIVE_SETTLE_TIME * 1000000ULL) return DriveMove::Unsettled;
+	return DriveMove::Running;
+}
+
+DriveMove *DriveController::start(const double left, const double right, const double speed,
+	const unsigned long deadline)
+{
+	DriveMove *const move = new DriveMove(this, left, right, speed, deadline);
+	s_driveMoves.increment();
+	
+	m_mutex.lock();
+	if(m_move) finish(DriveMove::Cancelled);
+	m_move = move;
+	m_moves.push_back(move);
+	m_stopPending = false;
+	m_mutex.unlock();
+	return move;
+}
+
+void DriveController::finish(const DriveMove::Status status)
+{
+	if(status == DriveMove::TimedOut) s_driveTimeouts.increment();
+	if(status == DriveMove::Stalled) s_driveStalls.increment();
+	if(status == DriveMove::Unsettled) s_driveUnsettled.increment();
+	m_move->m_status = status;
+	m_move = 0;
+	m_condition.broadcast();
+}
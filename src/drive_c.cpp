@@ -0,0 +1,104 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/drive.h"
+#include "kovan/drive.hpp"
+#include "warn.hpp"
+
+static DriveController *s_controller = 0;
+
+static DriveMove *moveObject(void *data)
+{
+	return reinterpret_cast<DriveMove *>(data);
+}
+
+static drive_move moveStruct(DriveMove *move)
+{
+	drive_move ret;
+	ret.data = reinterpret_cast<void *>(move);
+	return ret;
+}
+
+static DriveController *controller()
+{
+	if(!s_controller) WARN("Call drive_set_geometry first");
+	return s_controller;
+}
+
+void drive_set_geometry(int left_motor, int right_motor, double wheel_diameter,
+	double wheel_base, double ticks_per_revolution)
+{
+	DriveGeometry geometry;
+	geometry.leftMotor = left_motor;
+	geometry.rightMotor = right_motor;
+	geometry.wheelDiameter = wheel_diameter;
+	geometry.wheelBase = wheel_base;
+	geometry.ticksPerRevolution = ticks_per_revolution;
+	
+	delete s_controller;
+	s_controller = new DriveController(geometry);
+}
+
+void drive_set_limits(double max_speed, double acceleration)
+{
+	if(!controller()) return;
+	s_controller->setLimits(max_speed, acceleration);
+}
+
+drive_move drive_distance(double distance, double speed, int deadline_ms)
+{
+	if(!controller()) return moveStruct(0);
+	return moveStruct(s_controller->driveDistance(distance, speed, deadline_ms > 0 ? deadline_ms : 0));
+}
+
+drive_move drive_arc(double radius, double degrees, double speed, int deadline_ms)
+{
+	if(!controller()) return moveStruct(0);
+	return moveStruct(s_controller->driveArc(radius, degrees, speed, deadline_ms > 0 ? deadline_ms : 0));
+}
+
+drive_move turn_angle(double degrees, double speed, int deadline_ms)
+{
+	if(!controller()) return moveStruct(0);
+	return moveStruct(s_controller->turnAngle(degrees, speed, deadline_ms > 0 ? deadline_ms : 0));
+}
+
+int drive_status(drive_move move)
+{
+	if(!move.data) return DRIVE_CANCELLED;
+	return moveObject(move.data)->status();
+}
+
+int drive_wait(drive_move move)
+{
+	if(!move.data) return DRIVE_CANCELLED;
+	return moveObject(move.data)->wait();
+}
+
+void drive_free(drive_move move)
+{
+	delete moveObject(move.data);
+}
+
+void drive_stop()
+{
+	if(!controller()) return;
+	s_controller->stop();
+}
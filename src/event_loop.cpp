@@ -0,0 +1,255 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/event_loop.hpp"
+#include "kovan/socket.hpp"
+
+#ifndef WIN32
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#error Windows not yet supported.
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "warn.hpp"
+
+#define EVENT_LOOP_MAX_EVENTS 32
+
+static unsigned nativeEvents(const unsigned events)
+{
+	unsigned ret = 0;
+	if(events & EventLoop::Readable) ret |= EPOLLIN;
+	if(events & EventLoop::Writable) ret |= EPOLLOUT;
+	return ret;
+}
+
+static unsigned loopEvents(const unsigned events)
+{
+	unsigned ret = 0;
+	if(events & EPOLLIN) ret |= EventLoop::Readable;
+	if(events & EPOLLOUT) ret |= EventLoop::Writable;
+	if(events & (EPOLLHUP | EPOLLERR)) ret |= EventLoop::Hangup;
+	return ret;
+}
+
+EventHandler::~EventHandler()
+{
+}
+
+EventLoop::EventLoop()
+	: m_epoll(epoll_create1(EPOLL_CLOEXEC)),
+	m_wake(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+	m_quit(false)
+{
+	if(m_epoll < 0) PWARN("epoll_create1");
+	if(m_wake < 0) PWARN("eventfd");
+	if(m_epoll < 0 || m_wake < 0) return;
+	
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = m_wake;
+	if(epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wake, &ev) < 0) PWARN("epoll_ctl");
+}
+
+EventLoop::~EventLoop()
+{
+	for(std::map<int, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+		if(it->second.owned) ::close(it->first);
+	}
+	if(m_wake >= 0) ::close(m_wake);
+	if(m_epoll >= 0) ::close(m_epoll);
+}
+
+bool EventLoop::isValid() const
+{
+	return m_epoll >= 0 && m_wake >= 0;
+}
+
+bool EventLoop::add(const int fd, const unsigned events, EventHandler *const handler)
+{
+	Entry entry;
+	entry.handler = handler;
+	entry.owned = false;
+	entry.counter = false;
+	return insert(fd, events, entry);
+}
+
+bool EventLoop::add(const Socket &socket, EventHandler *const handler)
+{
+	return add(socket.fd(), Readable, handler);
+}
+
+bool EventLoop::modify(const int fd, const unsigned events)
+{
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = nativeEvents(events);
+	ev.data.fd = fd;
+	return epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+bool EventLoop::remove(const int fd)
+{
+	m_mutex.lock();
+	std::map<int, Entry>::iterator it = m_entries.find(fd);
+	if(it == m_entries.end()) {
+		m_mutex.unlock();
+		return false;
+	}
+	const bool owned = it->second.owned;
+	m_entries.erase(it);
+	m_mutex.unlock();
+	
+	// A closed descriptor has already left the epoll set
+	epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, 0);
+	if(owned) ::close(fd);
+	return true;
+}
+
+int EventLoop::addTimer(const unsigned long long intervalNs, EventHandler *const handler, const bool repeat)
+{
+	const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	if(fd < 0) {
+		PWARN("timerfd_create");
+		return -1;
+	}
+	
+	itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = intervalNs / 1000000000ULL;
+	spec.it_value.tv_nsec = intervalNs % 1000000000ULL;
+	// A zero it_value would disarm the timer
+	if(!intervalNs) spec.it_value.tv_nsec = 1;
+	if(repeat) spec.it_interval = spec.it_value;
+	
+	Entry entry;
+	entry.handler = handler;
+	entry.owned = true;
+	entry.counter = true;
+	if(timerfd_settime(fd, 0, &spec, 0) < 0 || !insert(fd, Readable, entry)) {
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int EventLoop::addNotifier(EventHandler *const handler)
+{
+	const int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(fd < 0) {
+		PWARN("eventfd");
+		return -1;
+	}
+	
+	Entry entry;
+	entry.handler = handler;
+	entry.owned = true;
+	entry.counter = true;
+	if(!insert(fd, Readable, entry)) {
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool EventLoop::notify(const int notifier)
+{
+	const unsigned long long one = 1;
+	return ::write(notifier, &one, sizeof(one)) == sizeof(one);
+}
+
+int EventLoop::runOnce(const int timeoutMs)
+{
+	epoll_event events[EVENT_LOOP_MAX_EVENTS];
+	const int ready = epoll_wait(m_epoll, events, EVENT_LOOP_MAX_EVENTS, timeoutMs);
+	if(ready < 0) {
+		if(errno == EINTR) return 0;
+		PWARN("epoll_wait");
+		return -1;
+	}
+	
+	int dispatched = 0;
+	for(int i = 0; i < ready; ++i) {
+		const int fd = events[i].data.fd;
+		unsigned long long count;
+		if(fd == m_wake) {
+			(void)!::read(m_wake, &count, sizeof(count));
+			continue;
+		}
+		
+		// Look the handler up again in case an earlier callback removed it
+		m_mutex.lock();
+		std::map<int, Entry>::const_iterator it = m_entries.find(fd);
+		if(it == m_entries.end()) {
+			m_mutex.unlock();
+			continue;
+		}
+		const Entry entry = it->second;
+		m_mutex.unlock();
+		
+		// Timers and notifiers stay readable until their counter is drained
+		if(entry.counter) (void)!::read(fd, &count, sizeof(count));
+		
+		if(entry.handler) entry.handler->event(this, fd, loopEvents(events[i].events));
+		++dispatched;
+	}
+	return dispatched;
+}
+
+void EventLoop::run()
+{
+	while(!m_quit) {
+		if(runOnce() < 0) break;
+	}
+	m_quit = false;
+}
+
+void EventLoop::quit()
+{
+	m_quit = true;
+	notify(m_wake);
+}
+
+bool EventLoop::insert(const int fd, const unsigned events, const Entry &entry)
+{
+	if(fd < 0) return false;
+	
+	m_mutex.lock();
+	m_entries[fd] = entry;
+	m_mutex.unlock();
+	
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = nativeEvents(events);
+	ev.data.fd = fd;
+	if(epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) == 0) return true;
+	
+	PWARN("epoll_ctl");
+	m_mutex.lock();
+	m_entries.erase(fd);
+	m_mutex.unlock();
+	return false;
+}
@@ -20,6 +20,7 @@
 
 #include "kovan/general.h"
 #include "kovan_p.hpp"
+#include "stop_p.hpp"
 
 #include "kovan/motors.h"
 #include "kovan/servo.h"
@@ -37,22 +38,48 @@ void publish()
 	Private::Kovan::instance()->flush();
 }
 
-void halt()
+int set_publish_window(int window)
+{
+	if(window < 1) return 0;
+	return Private::Kovan::instance()->setWindow(window) ? 1 : 0;
+}
+
+int get_publish_window()
+{
+	return Private::Kovan::instance()->window();
+}
+
+void publish_and_wait()
+{
+	Private::Kovan::instance()->sync();
+}
+
+int subscribe_state(int max_rate, int changes_only)
 {
-	freeze_halt();
-	disable_servos();
+	if(max_rate < 1 || max_rate > 1000) return 0;
+	return Private::Kovan::instance()->subscribe(0, TOTAL_REGS, 1000 / max_rate, changes_only) ? 1 : 0;
+}
+
+void unsubscribe_state()
+{
+	Private::Kovan::instance()->unsubscribe();
+}
+
+int set_kovan_bridge(const char *host)
+{
+	return Private::Kovan::instance()->setBridge(host) ? 1 : 0;
+}
 
+void halt()
+{
+	Private::EmergencyStop::trigger(Private::EmergencyStop::Motors
+		| Private::EmergencyStop::Ports | Private::EmergencyStop::Servos);
+	create_stop();
 }
 
 void freeze_halt()
 {
-	ao();
-	for(int i = 0; i < 8; ++i) {
-		set_analog_pullup(i, 1);
-	}
-	for(int i = 8; i < 16; ++i) {
-		set_digital_output(i, 0);
-		set_digital_pullup(i, 1);
-	}
+	Private::EmergencyStop::trigger(Private::EmergencyStop::Motors
+		| Private::EmergencyStop::Ports);
 	create_stop();
 }
\ No newline at end of file
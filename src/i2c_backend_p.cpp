@@ -0,0 +1,225 @@
+#include "i2c_backend_p.hpp"
+#include "i2c_mock_p.hpp"
+#include "warn.hpp"
+
+#ifdef KOVAN
+#include <i2c_wrapper.h>
+#endif
+
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define KOVAN_DEVICE_NAME "1"
+
+static bool readWriteCombined(const int fd, const unsigned short slave, const unsigned char addr,
+	unsigned char *const values, const size_t length)
+{
+	// Register write followed by a repeated-start read. Devices
+	// auto-increment the register address for each byte.
+	unsigned char reg = addr;
+	i2c_msg msgs[2];
+	msgs[0].addr = slave;
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &reg;
+	msgs[1].addr = slave;
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = length;
+	msgs[1].buf = values;
+	
+	i2c_rdwr_ioctl_data data;
+	data.msgs = msgs;
+	data.nmsgs = 2;
+	return ioctl(fd, I2C_RDWR, &data) >= 0;
+}
+
+Private::I2CBackend::~I2CBackend()
+{
+}
+
+Private::I2CBackend *Private::I2CBackend::create(const char *const spec)
+{
+	const std::string s(spec ? spec : "");
+	
+	if(s == "mock" || s.compare(0, 5, "mock:") == 0) {
+		MockI2CBackend *const ret = new MockI2CBackend();
+		if(s.size() > 5 && !ret->load(s.substr(5))) {
+			delete ret;
+			return 0;
+		}
+		return ret;
+	}
+	
+#ifdef KOVAN
+	if(s.empty() || s == "kovan") {
+		KovanI2CBackend *const ret = new KovanI2CBackend();
+		if(ret->isOpen()) return ret;
+		delete ret;
+		return 0;
+	}
+#else
+	if(s == "kovan") {
+		WARN("This build does not include the Kovan i2c backend.");
+		return 0;
+	}
+	
+	// Off the board, never guess which of the host's buses to talk to
+	if(s.empty()) return 0;
+#endif
+	
+	// A bare bus number means /dev/i2c-N
+	const std::string device = s[0] == '/' ? s : "/dev/i2c-" + s;
+	LinuxI2CBackend *const ret = new LinuxI2CBackend(device.c_str());
+	if(ret->isOpen()) return ret;
+	delete ret;
+	return 0;
+}
+
+#ifdef KOVAN
+Private::KovanI2CBackend::KovanI2CBackend()
+	: m_fd(-1),
+	m_slave(0)
+{
+	char dummy[20];
+	m_fd = i2c_open_device(KOVAN_DEVICE_NAME, dummy, sizeof(dummy), 1);
+	if(m_fd < 0) PWARN("i2c_open_device failed. File handle is bad.");
+}
+
+Private::KovanI2CBackend::~KovanI2CBackend()
+{
+	if(m_fd >= 0) i2c_close_device(m_fd);
+}
+
+bool Private::KovanI2CBackend::isOpen() const
+{
+	return m_fd >= 0;
+}
+
+const char *Private::KovanI2CBackend::name() const
+{
+	return "kovan";
+}
+
+bool Private::KovanI2CBackend::pickSlave(const unsigned short slave)
+{
+	char buffer[8];
+	sprintf(buffer, "0x%x", slave);
+	if(i2c_pick_slave(m_fd, buffer) < 0) return false;
+	m_slave = slave;
+	return true;
+}
+
+bool Private::KovanI2CBackend::write(const unsigned char addr, const unsigned char val, const bool readback)
+{
+	return i2c_write_byte(m_fd, addr, val, readback ? 1 : 0) >= 0;
+}
+
+bool Private::KovanI2CBackend::read(const unsigned char addr, unsigned char &val)
+{
+	val = i2c_read_byte(m_fd, addr);
+	return true;
+}
+
+bool Private::KovanI2CBackend::read(const unsigned char addr, unsigned char *const values, const size_t length)
+{
+	if(readWriteCombined(m_fd, m_slave, addr, values, length)) return true;
+	
+	// Fall back to one transaction per register
+	for(size_t i = 0; i < length; ++i) values[i] = i2c_read_byte(m_fd, addr + i);
+	return true;
+}
+#endif
+
+Private::LinuxI2CBackend::LinuxI2CBackend(const char *const device)
+	: m_fd(::open(device, O_RDWR | O_CLOEXEC)),
+	m_slave(0),
+	m_rdwr(true)
+{
+	if(m_fd < 0) PWARN("Failed to open %s", device);
+}
+
+Private::LinuxI2CBackend::~LinuxI2CBackend()
+{
+	if(m_fd >= 0) ::close(m_fd);
+}
+
+bool Private::LinuxI2CBackend::isOpen() const
+{
+	return m_fd >= 0;
+}
+
+const char *Private::LinuxI2CBackend::name() const
+{
+	return "i2c-dev";
+}
+
+bool Private::LinuxI2CBackend::pickSlave(const unsigned short slave)
+{
+	if(ioctl(m_fd, I2C_SLAVE, (unsigned long)slave) < 0) {
+		PWARN("I2C_SLAVE 0x%x", slave);
+		return false;
+	}
+	m_slave = slave;
+	return true;
+}
+
+bool Private::LinuxI2CBackend::write(const unsigned char addr, const unsigned char val, const bool readback)
+{
+	i2c_smbus_data data;
+	data.byte = val;
+	if(!smbus(I2C_SMBUS_WRITE, addr, I2C_SMBUS_BYTE_DATA, &data)) return false;
+	if(!readback) return true;
+	
+	unsigned char check = 0;
+	return read(addr, check) && check == val;
+}
+
+bool Private::LinuxI2CBackend::read(const unsigned char addr, unsigned char &val)
+{
+	i2c_smbus_data data;
+	if(!smbus(I2C_SMBUS_READ, addr, I2C_SMBUS_BYTE_DATA, &data)) return false;
+	val = data.byte;
+	return true;
+}
+
+bool Private::LinuxI2CBackend::read(const unsigned char addr, unsigned char *const values, const size_t length)
+{
+	// Not every adapter supports raw combined transfers. Remember
+	// when it doesn't and use SMBus block reads instead.
+	if(m_rdwr) {
+		if(readWriteCombined(m_fd, m_slave, addr, values, length)) return true;
+		if(errno != EOPNOTSUPP && errno != EINVAL) return false;
+		m_rdwr = false;
+	}
+	
+	size_t done = 0;
+	while(done < length) {
+		const size_t chunk = std::min(length - done, (size_t)I2C_SMBUS_BLOCK_MAX);
+		i2c_smbus_data data;
+		data.block[0] = chunk;
+		if(!smbus(I2C_SMBUS_READ, addr + done, I2C_SMBUS_I2C_BLOCK_DATA, &data)) return false;
+		memcpy(values + done, data.block + 1, chunk);
+		done += chunk;
+	}
+	return true;
+}
+
+bool Private::LinuxI2CBackend::smbus(const char readWrite, const unsigned char command, const int size, void *const data)
+{
+	i2c_smbus_ioctl_data args;
+	args.read_write = readWrite;
+	args.command = command;
+	args.size = size;
+	args.data = reinterpret_cast<i2c_smbus_data *>(data);
+	return ioctl(m_fd, I2C_SMBUS, &args) >= 0;
+}
@@ -0,0 +1,73 @@
+#ifndef _I2C_BACKEND_P_HPP_
+#define _I2C_BACKEND_P_HPP_
+
+#include <cstddef>
+
+namespace Private
+{
+	// One way of reaching an I2C bus. Calls are serialized by Private::I2C.
+	class I2CBackend
+	{
+	public:
+		virtual ~I2CBackend();
+		
+		virtual const char *name() const = 0;
+		
+		virtual bool pickSlave(const unsigned short slave) = 0;
+		virtual bool write(const unsigned char addr, const unsigned char val, const bool readback) = 0;
+		virtual bool read(const unsigned char addr, unsigned char &val) = 0;
+		virtual bool read(const unsigned char addr, unsigned char *const values, const size_t length) = 0;
+		
+		// spec is one of "kovan", a bus number or /dev/i2c-N path,
+		// "mock" or "mock:<script>". An empty spec means "kovan" on the
+		// board and no bus elsewhere. Returns 0 if the bus can't be opened.
+		static I2CBackend *create(const char *const spec);
+	};
+	
+#ifdef KOVAN
+	// The board's i2c_wrapper library
+	class KovanI2CBackend : public I2CBackend
+	{
+	public:
+		KovanI2CBackend();
+		~KovanI2CBackend();
+		
+		bool isOpen() const;
+		
+		const char *name() const;
+		bool pickSlave(const unsigned short slave);
+		bool write(const unsigned char addr, const unsigned char val, const bool readback);
+		bool read(const unsigned char addr, unsigned char &val);
+		bool read(const unsigned char addr, unsigned char *const values, const size_t length);
+		
+	private:
+		int m_fd;
+		unsigned short m_slave;
+	};
+#endif
+	
+	// Any bus exposed by the kernel's i2c-dev driver
+	class LinuxI2CBackend : public I2CBackend
+	{
+	public:
+		LinuxI2CBackend(const char *const device);
+		~LinuxI2CBackend();
+		
+		bool isOpen() const;
+		
+		const char *name() const;
+		bool pickSlave(const unsigned short slave);
+		bool write(const unsigned char addr, const unsigned char val, const bool readback);
+		bool read(const unsigned char addr, unsigned char &val);
+		bool read(const unsigned char addr, unsigned char *const values, const size_t length);
+		
+	private:
+		bool smbus(const char readWrite, const unsigned char command, const int size, void *const data);
+		
+		int m_fd;
+		unsigned short m_slave;
+		bool m_rdwr;
+	};
+}
+
+#endif
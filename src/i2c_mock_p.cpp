@@ -0,0 +1,172 @@
+#include "i2c_mock_p.hpp"
+#include "kovan/config.hpp"
+#include "time_p.hpp"
+#include "warn.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+static unsigned long parseNumber(const std::string &s)
+{
+	return strtoul(s.c_str(), 0, 0);
+}
+
+Private::MockI2CBackend::Register::Register()
+	: value(0),
+	position(0),
+	held(false)
+{
+}
+
+Private::MockI2CBackend::MockI2CBackend()
+	: m_anySlave(true),
+	m_slave(0),
+	m_latency(0),
+	m_byteLatency(0),
+	m_transactions(0),
+	m_bytes(0)
+{
+}
+
+bool Private::MockI2CBackend::load(const std::string &path)
+{
+	Config *const config = Config::load(path);
+	if(!config) {
+		WARN("Failed to load i2c mock script %s", path.c_str());
+		return false;
+	}
+	
+	setLatency(config->intValue("latency_us"), config->intValue("byte_latency_us"));
+	
+	std::stringstream slaves(config->stringValue("slaves"));
+	std::string slave;
+	while(slaves >> slave) addSlave(parseNumber(slave));
+	
+	// Config has no way to list its keys, so probe every
+	// register of every declared slave.
+	for(std::map<unsigned short, Device>::const_iterator it = m_devices.begin(); it != m_devices.end(); ++it) {
+		char group[8];
+		sprintf(group, "0x%02x", it->first);
+		config->beginGroup(group);
+		for(unsigned addr = 0; addr < 256; ++addr) {
+			char key[8];
+			sprintf(key, "0x%02x", addr);
+			if(!config->containsKey(key)) continue;
+			
+			std::stringstream stream(config->stringValue(key));
+			std::vector<unsigned char> values;
+			std::string value;
+			while(stream >> value) values.push_back(parseNumber(value));
+			setScript(it->first, addr, values);
+		}
+		config->endGroup();
+	}
+	
+	delete config;
+	return true;
+}
+
+void Private::MockI2CBackend::setLatency(const unsigned long transactionUs, const unsigned long byteUs)
+{
+	m_latency = transactionUs;
+	m_byteLatency = byteUs;
+}
+
+void Private::MockI2CBackend::addSlave(const unsigned short slave)
+{
+	m_devices[slave];
+	m_anySlave = false;
+}
+
+void Private::MockI2CBackend::setRegister(const unsigned short slave, const unsigned char addr, const unsigned char value)
+{
+	m_devices[slave][addr].value = value;
+}
+
+void Private::MockI2CBackend::setScript(const unsigned short slave, const unsigned char addr,
+	const std::vector<unsigned char> &values)
+{
+	Register &reg = m_devices[slave][addr];
+	reg.script = values;
+	reg.position = 0;
+	reg.held = false;
+}
+
+unsigned char Private::MockI2CBackend::registerValue(const unsigned short slave, const unsigned char addr) const
+{
+	std::map<unsigned short, Device>::const_iterator device = m_devices.find(slave);
+	if(device == m_devices.end()) return 0;
+	Device::const_iterator reg = device->second.find(addr);
+	return reg == device->second.end() ? 0 : reg->second.value;
+}
+
+unsigned long Private::MockI2CBackend::transactions() const
+{
+	return m_transactions;
+}
+
+unsigned long Private::MockI2CBackend::bytes() const
+{
+	return m_bytes;
+}
+
+const char *Private::MockI2CBackend::name() const
+{
+	return "mock";
+}
+
+bool Private::MockI2CBackend::pickSlave(const unsigned short slave)
+{
+	if(!m_anySlave && m_devices.find(slave) == m_devices.end()) return false;
+	m_slave = slave;
+	return true;
+}
+
+bool Private::MockI2CBackend::write(const unsigned char addr, const unsigned char val, const bool readback)
+{
+	// Address, register and value
+	transfer(3);
+	Register &reg = m_devices[m_slave][addr];
+	reg.value = val;
+	reg.held = true;
+	if(readback) transfer(3);
+	return true;
+}
+
+bool Private::MockI2CBackend::read(const unsigned char addr, unsigned char &val)
+{
+	return read(addr, &val, 1);
+}
+
+bool Private::MockI2CBackend::read(const unsigned char addr, unsigned char *const values, const size_t length)
+{
+	// Address and register, then a repeated start and the data
+	transfer(3 + length);
+	Device &device = m_devices[m_slave];
+	for(size_t i = 0; i < length; ++i) values[i] = next(device[(unsigned char)(addr + i)]);
+	return true;
+}
+
+void Private::MockI2CBackend::transfer(const size_t length)
+{
+	++m_transactions;
+	m_bytes += length;
+	const unsigned long delay = m_latency + m_byteLatency * length;
+	if(delay) Private::Time::microsleep(delay);
+}
+
+unsigned char Private::MockI2CBackend::next(Register &reg)
+{
+	if(reg.script.empty()) return reg.value;
+	
+	if(reg.held) {
+		reg.held = false;
+		reg.position = 0;
+		return reg.value;
+	}
+	
+	reg.value = reg.script[reg.position];
+	reg.position = (reg.position + 1) % reg.script.size();
+	return reg.value;
+}
@@ -0,0 +1,70 @@
+#ifndef _I2C_MOCK_P_HPP_
+#define _I2C_MOCK_P_HPP_
+
+#include "i2c_backend_p.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Private
+{
+	// An in-memory bus for developing and measuring I2C code off the board.
+	//
+	// A script is a Config file:
+	//   latency_us: 200          per-transaction delay
+	//   byte_latency_us: 20      extra delay per byte transferred
+	//   slaves: 0x1d 0x53        devices that acknowledge (any if omitted)
+	//   0x1d/0x06: 1 2 3         successive reads of register 0x06 return
+	//                            1, 2, 3, 1, 2, ...
+	// Writing a scripted register makes the next read return the written
+	// value, after which the script starts over.
+	class MockI2CBackend : public I2CBackend
+	{
+	public:
+		MockI2CBackend();
+		
+		bool load(const std::string &path);
+		
+		void setLatency(const unsigned long transactionUs, const unsigned long byteUs);
+		void addSlave(const unsigned short slave);
+		void setRegister(const unsigned short slave, const unsigned char addr, const unsigned char value);
+		void setScript(const unsigned short slave, const unsigned char addr, const std::vector<unsigned char> &values);
+		unsigned char registerValue(const unsigned short slave, const unsigned char addr) const;
+		
+		unsigned long transactions() const;
+		unsigned long bytes() const;
+		
+		const char *name() const;
+		bool pickSlave(const unsigned short slave);
+		bool write(const unsigned char addr, const unsigned char val, const bool readback);
+		bool read(const unsigned char addr, unsigned char &val);
+		bool read(const unsigned char addr, unsigned char *const values, const size_t length);
+		
+	private:
+		struct Register
+		{
+			Register();
+			
+			unsigned char value;
+			std::vector<unsigned char> script;
+			size_t position;
+			bool held;
+		};
+		
+		typedef std::map<unsigned char, Register> Device;
+		
+		void transfer(const size_t length);
+		unsigned char next(Register &reg);
+		
+		std::map<unsigned short, Device> m_devices;
+		bool m_anySlave;
+		unsigned short m_slave;
+		unsigned long m_latency;
+		unsigned long m_byteLatency;
+		unsigned long m_transactions;
+		unsigned long m_bytes;
+	};
+}
+
+#endif
@@ -1,52 +1,90 @@
 #include "i2c_p.hpp"
+#include "i2c_backend_p.hpp"
+#include "init_timer_p.hpp"
 #include "warn.hpp"
 
-#ifdef KOVAN
-#include <i2c_wrapper.h>
-#endif
-
-#define DEVICE_NAME "1"
+#include <cstdlib>
 
 bool Private::I2C::pickSlave(const char *slave)
 {
-	if(m_fd < 0) {
-		WARN("Bad file handle for i2c bus.");
+	m_mutex.lock();
+	if(!open()) {
+		m_mutex.unlock();
 		return false;
 	}
-#ifdef KOVAN
-	return i2c_pick_slave(m_fd, slave) >= 0;
-#else
-	WARN("Not implemented for this host.");
-	return false;
-#endif
+	const bool ret = m_backend->pickSlave(strtol(slave, 0, 0));
+	m_mutex.unlock();
+	return ret;
 }
 
 bool Private::I2C::write(const unsigned char &addr, const unsigned char &val, const bool &readback)
 {
-	if(m_fd < 0) {
-		WARN("Bad file handle for i2c bus.");
+	m_mutex.lock();
+	if(!open()) {
+		m_mutex.unlock();
 		return false;
 	}
-#ifdef KOVAN
-	return i2c_write_byte(m_fd, addr, val, readback ? 1 : 0) >= 0;
-#else
-	WARN("Not implemented for this host.");
-	return false;
-#endif
+	const bool ret = m_backend->write(addr, val, readback);
+	m_mutex.unlock();
+	return ret;
 }
 
 unsigned char Private::I2C::read(const unsigned char &addr)
 {
-	if(m_fd < 0) {
-		WARN("Bad file handle for i2c bus.");
+	unsigned char ret = 0;
+	m_mutex.lock();
+	if(!open()) {
+		m_mutex.unlock();
 		return 0;
 	}
-#ifdef KOVAN
-	return i2c_read_byte(m_fd, addr);
-#else
-	WARN("Not implemented for this host.");
-	return 0;
-#endif
+	m_backend->read(addr, ret);
+	m_mutex.unlock();
+	return ret;
+}
+
+bool Private::I2C::read(const unsigned char &addr, unsigned char *const values, const size_t &length)
+{
+	m_mutex.lock();
+	if(!open()) {
+		m_mutex.unlock();
+		return false;
+	}
+	const bool ret = m_backend->read(addr, values, length);
+	m_mutex.unlock();
+	return ret;
+}
+
+void Private::I2C::setBackend(I2CBackend *const backend)
+{
+	m_mutex.lock();
+	delete m_backend;
+	m_backend = backend;
+	m_opened = true;
+	m_mutex.unlock();
+}
+
+Private::I2CBackend *Private::I2C::backend()
+{
+	m_mutex.lock();
+	open();
+	I2CBackend *const ret = m_backend;
+	m_mutex.unlock();
+	return ret;
+}
+
+static Gauge s_openTime("init.i2c_us");
+
+bool Private::I2C::open()
+{
+	if(!m_opened) {
+		m_opened = true;
+		InitTimer timer(s_openTime, "I2C::open");
+		m_backend = I2CBackend::create(getenv("KOVAN_I2C"));
+		if(!m_backend) WARN("Failed to open an i2c bus. Set KOVAN_I2C to a bus number or \"mock\".");
+	}
+	
+	if(!m_backend) WARN("No i2c bus available.");
+	return m_backend != 0;
 }
 
 Private::I2C *Private::I2C::instance()
@@ -56,21 +94,12 @@ Private::I2C *Private::I2C::instance()
 }
 
 Private::I2C::I2C()
-	: m_fd(-1)
+	: m_backend(0),
+	m_opened(false)
 {
-	char dummy[20];
-#ifdef KOVAN
-	m_fd = i2c_open_device(DEVICE_NAME, dummy, sizeof(dummy), 1);
-#endif
-	if(m_fd < 0) {
-		PWARN("i2c_open_device failed. File handle is bad.");
-	}
 }
 
 Private::I2C::~I2C()
 {
-	if(m_fd < 0) return;
-#ifdef KOVAN
-	i2c_close_device(m_fd);
-#endif
+	delete m_backend;
 }
@@ -1,8 +1,14 @@
 #ifndef _I2C_P_HPP_
 #define _I2C_P_HPP_
 
+#include <cstddef>
+
+#include "kovan/thread.hpp"
+
 namespace Private
 {
+	class I2CBackend;
+	
 	class I2C
 	{
 	public:
@@ -10,12 +16,27 @@ namespace Private
 		bool write(const unsigned char &addr, const unsigned char &val, const bool &readback);
 		unsigned char read(const unsigned char &addr);
 		
+		// Reads length consecutive registers starting at addr in a single
+		// bus transaction, so the values all come from the same conversion.
+		bool read(const unsigned char &addr, unsigned char *const values, const size_t &length);
+		
+		// Takes ownership of backend. The default comes from the KOVAN_I2C
+		// environment variable (see I2CBackend::create) and is opened on
+		// first use.
+		void setBackend(I2CBackend *const backend);
+		I2CBackend *backend();
+		
 		static I2C *instance();
 	private:
 		I2C();
 		~I2C();
 		
-		int m_fd;
+		// Must be called with m_mutex held
+		bool open();
+		
+		I2CBackend *m_backend;
+		bool m_opened;
+		Mutex m_mutex;
 	};
 }
 
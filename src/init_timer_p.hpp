@@ -0,0 +1,37 @@
+#ifndef _INIT_TIMER_P_HPP_
+#define _INIT_TIMER_P_HPP_
+
+#include "kovan/metrics.hpp"
+#include "kovan/trace.hpp"
+#include "time_p.hpp"
+
+namespace Private
+{
+	// Times the deferred initialization of a subsystem. The duration ends up
+	// in gauge (microseconds) and, if tracing is enabled, as a trace span.
+	// Gauges for this are named "init.*" so print_startup_profile finds them.
+	class InitTimer
+	{
+	public:
+		InitTimer(Gauge &gauge, const char *const name)
+			: m_gauge(gauge),
+			m_name(name),
+			m_start(Time::monotonic())
+		{
+		}
+		
+		~InitTimer()
+		{
+			const unsigned long long end = Time::monotonic();
+			m_gauge.set((end - m_start) / 1000.0);
+			if(Trace::isEnabled()) Trace::record(m_name, m_start, end);
+		}
+		
+	private:
+		Gauge &m_gauge;
+		const char *const m_name;
+		const unsigned long long m_start;
+	};
+}
+
+#endif
@@ -11,7 +11,8 @@ namespace Private
 	{
 		NilType = 0,
 		StateCommandType,
-		WriteCommandType
+		WriteCommandType,
+		SubscribeCommandType
 	};
 
 	struct Command
@@ -32,6 +33,22 @@ namespace Private
 		unsigned short val; // 0 - 0xFFFF
 	};
 
+	enum SubscribeFlags
+	{
+		SubscribeChangesOnly = 1
+	};
+	
+	// Asks for StatePush updates of registers [first, first + count), at
+	// most one every interval ms, sent to the address the command came from.
+	// A count of 0 ends the subscription.
+	struct SubscribeCommand
+	{
+		unsigned short first;
+		unsigned short count;
+		unsigned short interval;
+		unsigned short flags;
+	};
+	
 	struct State
 	{
 		unsigned short t[TOTAL_REGS];
@@ -1,12 +1,23 @@
 #include "kovan_module_p.hpp"
 
 #include "kovan_regs_p.hpp"
+#include "subscribe_p.hpp"
+#include "time_p.hpp"
+#include "kovan/metrics.hpp"
+#include "warn.hpp"
 
 #include <iostream>
 
 #include <cstdio>
 #include <cstdlib>
 #include <errno.h>
+#include <string>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/select.h>
+#include <netdb.h>
+#endif
 
 #define TIMEDIV (1.0 / 13000000) // 13 MHz clock
 #define PWM_PERIOD_RAW 0.02F
@@ -18,9 +29,24 @@
 
 using namespace Private;
 
+static Counter s_packetsSent("kovan.packets_sent");
+static Counter s_packetsReceived("kovan.packets_received");
+static Counter s_sendErrors("kovan.send_errors");
+static Counter s_receiveErrors("kovan.receive_errors");
+static Counter s_pushes("kovan.pushes");
+static Counter s_pushBytes("kovan.push_bytes");
+static Counter s_pushGaps("kovan.push_gaps");
+
 KovanModule::KovanModule(const uint64_t& moduleAddress, const uint16_t& modulePort)
-	: m_sock(-1)
+	: m_sock(-1),
+	m_pushSock(-1),
+	m_subscribedAt(0),
+	m_pushSeq(0),
+	m_havePushed(false),
+	m_pushFresh(false)
 {
+	memset(&m_subscription, 0, sizeof(SubscribeCommand));
+	memset(&m_pushed, 0, sizeof(State));
 	memset(&m_out, 0, sizeof(m_out));
 	m_out.sin_family = AF_INET;
 	m_out.sin_addr.s_addr = moduleAddress;
@@ -29,6 +55,7 @@ KovanModule::KovanModule(const uint64_t& moduleAddress, const uint16_t& modulePo
 
 KovanModule::~KovanModule()
 {
+	if(m_pushSock >= 0) subscribe(0, 0, 0, false, 0);
 	close();
 }
 
@@ -41,7 +68,7 @@ bool KovanModule::init()
 	bool on = true;
 	setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&on), sizeof(bool));
 	if(m_sock < 0) {
-		perror("socket");
+		PWARN("socket failed");
 		return false;
 	}
 	
@@ -69,7 +96,7 @@ bool KovanModule::bind(const uint64_t& address, const uint16_t& port)
 			continue;
 		}
 		
-		perror("bind");
+		PWARN("bind failed");
 		return false;
 	}
 	
@@ -84,6 +111,7 @@ void KovanModule::close()
 #else
 	closesocket(m_sock);
 #endif
+	m_sock = -1;
 }
 
 uint64_t KovanModule::moduleAddress() const
@@ -114,9 +142,11 @@ bool KovanModule::send(const CommandVector& commands)
 	while(sendto(m_sock, reinterpret_cast<const char *>(packet), packetSize, 0,
 		(sockaddr *)&m_out, sizeof(m_out)) != packetSize) {
 		if(errno == EINTR) continue;
-		perror("sendto");
+		PWARN("sendto failed");
+		s_sendErrors.increment();
 		ret = false;
 	}
+	if(ret) s_packetsSent.increment();
 	
 	free(packet);
 	return ret;
@@ -130,11 +160,228 @@ bool KovanModule::recv(State& state)
 	while((i = recvfrom(m_sock, reinterpret_cast<char *>(&state),
 		sizeof(State), 0, NULL, NULL)) != sizeof(State)) {
 		if(errno == EINTR) continue;
-		perror("recvfrom");
-		printf("Got %ld\n", i);
+		PWARN("recvfrom returned %ld", (long)i);
+		s_receiveErrors.increment();
+		return false;
+	}
+	
+	s_packetsReceived.increment();
+	
+	// Pushes that are already here are older than this reply
+	if(m_pushSock >= 0) {
+		decodePushes();
+		m_pushFresh = false;
+	}
+	return true;
+}
+
+bool KovanModule::waitReadable(const int timeout)
+{
+	if(m_sock < 0) return false;
+	
+	fd_set readable;
+	FD_ZERO(&readable);
+	FD_SET(m_sock, &readable);
+	timeval tv;
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+	
+	int ret = 0;
+	while((ret = select(m_sock + 1, &readable, 0, 0, &tv)) < 0 && errno == EINTR);
+	return ret > 0;
+}
+
+bool KovanModule::supportsWindow() const
+{
+	// The daemon answers state requests in the order it receives them
+	return true;
+}
+
+bool KovanModule::subscribe(const unsigned short first, const unsigned short count,
+	const unsigned short interval, const bool changesOnly, const int timeout)
+{
+	if(first + count > TOTAL_REGS) return false;
+	
+	m_subscription.first = first;
+	m_subscription.count = count;
+	m_subscription.interval = interval;
+	m_subscription.flags = changesOnly ? SubscribeChangesOnly : 0;
+	m_havePushed = false;
+	
+	if(!count) {
+		if(m_pushSock >= 0) sendSubscribe();
+		closePushSocket();
+		return true;
+	}
+	
+	if(m_pushSock < 0) {
+		m_pushSock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if(m_pushSock < 0) {
+			PWARN("socket failed");
+			return false;
+		}
+	}
+	if(!sendSubscribe()) {
+		closePushSocket();
+		return false;
+	}
+	
+	// Reads aren't answered from the subscription until the full update is in
+	const unsigned long long deadline = Private::Time::monotonic() + timeout * 1000000ULL;
+	while(!m_havePushed) {
+		const unsigned long long now = Private::Time::monotonic();
+		if(now >= deadline) break;
+		
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(m_pushSock, &readable);
+		const unsigned long long left = (deadline - now) / 1000ULL;
+		timeval tv;
+		tv.tv_sec = left / 1000000ULL;
+		tv.tv_usec = left % 1000000ULL;
+		if(select(m_pushSock + 1, &readable, 0, 0, &tv) < 0 && errno != EINTR) break;
+		
+		State ignored;
+		receivePushes(ignored);
+	}
+	
+	if(!m_havePushed) {
+		WARN("No state pushed within %d ms", timeout);
+		closePushSocket();
+		return false;
+	}
+	return true;
+}
+
+bool KovanModule::subscribed() const
+{
+	return m_pushSock >= 0 && m_havePushed;
+}
+
+bool KovanModule::receivePushes(State &state)
+{
+	if(m_pushSock < 0) return false;
+	if(Private::Time::monotonic() - m_subscribedAt > SUBSCRIBE_RENEW * 1000000ULL) sendSubscribe();
+	const bool decoded = decodePushes();
+	if(decoded) m_pushFresh = true;
+	
+	if(!m_havePushed || !m_pushFresh) return false;
+	memcpy(state.t + m_subscription.first, m_pushed.t + m_subscription.first,
+		m_subscription.count * sizeof(unsigned short));
+	return decoded;
+}
+
+bool KovanModule::decodePushes()
+{
+	bool decoded = false;
+	StatePush push;
+	for(;;) {
+		const ssize_t ret = ::recv(m_pushSock, reinterpret_cast<char *>(&push), sizeof(push), MSG_DONTWAIT);
+		if(ret < 0) {
+			if(errno == EINTR) continue;
+			if(errno != EAGAIN && errno != EWOULDBLOCK) PWARN("recv failed");
+			break;
+		}
+		s_pushBytes.increment(ret);
+		
+		if((size_t)ret < statePushSize(0) || (size_t)ret != statePushSize(push.length)) {
+			WARN("Malformed state push");
+			continue;
+		}
+		
+		State base;
+		if(push.seq == 1) memset(&base, 0, sizeof(State));
+		else if(m_pushSeq && push.seq == m_pushSeq + 1) memcpy(&base, &m_pushed, sizeof(State));
+		else {
+			// A push went missing. Renewing starts over with a full update.
+			if(m_pushSeq) {
+				s_pushGaps.increment();
+				m_pushSeq = 0;
+				sendSubscribe();
+			}
+			continue;
+		}
+		
+		if(!StateDelta::decode(base, push.delta, push.length, m_pushed)) {
+			WARN("Malformed state delta in push");
+			continue;
+		}
+		m_pushSeq = push.seq;
+		m_havePushed = true;
+		decoded = true;
+		s_pushes.increment();
+	}
+	return decoded;
+}
+
+bool KovanModule::sendSubscribe()
+{
+	Command command;
+	command.type = SubscribeCommandType;
+	memset(command.data, 0, MAX_COMMAND_DATA_SIZE);
+	memcpy(command.data, &m_subscription, sizeof(SubscribeCommand));
+	
+	uint32_t packetSize = 0;
+	Packet *const packet = createPacket(1, packetSize);
+	if(!packet) return false;
+	packet->commands[0] = command;
+	
+	ssize_t ret = 0;
+	while((ret = sendto(m_pushSock, reinterpret_cast<const char *>(packet), packetSize, 0,
+		(sockaddr *)&m_out, sizeof(m_out))) < 0 && errno == EINTR);
+	free(packet);
+	if(ret != (ssize_t)packetSize) {
+		PWARN("sendto failed");
+		return false;
+	}
+	
+	m_subscribedAt = Private::Time::monotonic();
+	return true;
+}
+
+void KovanModule::closePushSocket()
+{
+	if(m_pushSock < 0) return;
+#ifndef WIN32
+	::close(m_pushSock);
+#else
+	closesocket(m_pushSock);
+#endif
+	m_pushSock = -1;
+	m_pushSeq = 0;
+	m_havePushed = false;
+	m_pushFresh = false;
+}
+
+int KovanModule::descriptor() const
+{
+	return m_sock;
+}
+
+bool KovanModule::resolve(const char *const host, const uint16_t defaultPort,
+	uint64_t &address, uint16_t &port)
+{
+	std::string name(host);
+	port = htons(defaultPort);
+	const std::string::size_type colon = name.rfind(':');
+	if(colon != std::string::npos) {
+		port = htons(atoi(name.c_str() + colon + 1));
+		name.erase(colon);
+	}
+	
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	
+	addrinfo *result = 0;
+	if(getaddrinfo(name.c_str(), 0, &hints, &result) || !result) {
+		WARN("Can't resolve %s", name.c_str());
 		return false;
 	}
 	
+	address = reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr.s_addr;
+	freeaddrinfo(result);
 	return true;
 }
 
@@ -161,7 +408,7 @@ int KovanModule::getState(State &state)
 	send(commands);
 
 	if(!recv(state)) {
-		std::cout << "Error: didn't get state back!" << std::endl;
+		WARN("Didn't get state back");
 		return -1;
 	}
 
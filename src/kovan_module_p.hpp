@@ -48,9 +48,9 @@ namespace Private
 	{
 	public:
 		KovanModule(const uint64_t& moduleAddress, const uint16_t& modulePort);
-		~KovanModule();
+		virtual ~KovanModule();
 
-		bool init();
+		virtual bool init();
 		bool bind(const uint64_t& address, const uint16_t& port);
 		void close();
 
@@ -58,18 +58,56 @@ namespace Private
 		uint16_t modulePort() const;
 
 		bool send(const Command& command);
-		bool send(const CommandVector& commands);
+		virtual bool send(const CommandVector& commands);
 
-		bool recv(State& state);
+		virtual bool recv(State& state);
+		
+		// Waits up to timeout ms for a reply. 0 only checks.
+		bool waitReadable(const int timeout);
+		
+		// Whether replies can be matched to packets when several are in flight
+		virtual bool supportsWindow() const;
+		
+		// Asks the daemon to push changes to registers [first, first + count)
+		// to a second socket, at most once every interval ms. Waits up to
+		// timeout ms for the first, full update. count 0 unsubscribes.
+		virtual bool subscribe(const unsigned short first, const unsigned short count,
+			const unsigned short interval, const bool changesOnly, const int timeout);
+		bool subscribed() const;
+		
+		// Copies the subscribed registers into state once updates have arrived,
+		// without blocking. Renews the subscription when it is due. Returns
+		// true if a new update was copied.
+		bool receivePushes(State &state);
 
 		int getState(State &state);
 		void displayState(const State &state);
+		
+		int descriptor() const;
+		
+		// Resolves "host[:port]". address and port are in network byte order.
+		static bool resolve(const char *const host, const uint16_t defaultPort,
+			uint64_t &address, uint16_t &port);
+		
+		// Allocates a packet with room for num commands. Free it with free().
+		static Packet *createPacket(const uint16_t& num, uint32_t& packet_size);
 
-	private:
+	protected:
 		int m_sock;
 		sockaddr_in m_out;
-
-		static Packet *createPacket(const uint16_t& num, uint32_t& packet_size);
+		
+	private:
+		bool sendSubscribe();
+		void closePushSocket();
+		bool decodePushes();
+		
+		int m_pushSock;
+		SubscribeCommand m_subscription;
+		unsigned long long m_subscribedAt;
+		uint32_t m_pushSeq;
+		bool m_havePushed;
+		bool m_pushFresh;
+		State m_pushed;
 	};
 }
 
@@ -1,12 +1,42 @@
 #include "kovan_p.hpp"
 
 #include "kovan_module_p.hpp"
+#include "remote_kovan_module_p.hpp"
 #include "kovan_regs_p.hpp"
+#include "kovan/trace.hpp"
+#include "kovan/metrics.hpp"
+#include "time_p.hpp"
+#include "init_timer_p.hpp"
+#include "warn.hpp"
+
+#include <cstdlib>
+#include <cstring>
 
-#include <iostream> // FIXME: tmp
 
 using namespace Private;
 
+namespace
+{
+	// Holds a Kovan's mutex until the end of the scope
+	class Locker
+	{
+	public:
+		Locker(Mutex &mutex)
+			: m_mutex(mutex)
+		{
+			m_mutex.lock();
+		}
+		
+		~Locker()
+		{
+			m_mutex.unlock();
+		}
+		
+	private:
+		Mutex &m_mutex;
+	};
+}
+
 Kovan::~Kovan()
 {
 	delete m_module;
@@ -14,6 +44,7 @@ Kovan::~Kovan()
 
 void Kovan::enqueueCommand(const Command &command, bool autoFlush)
 {
+	Locker locker(m_mutex);
 	m_queue.push_back(command);
 	
 	// FIXME: This logic needs to be improved eventually
@@ -30,8 +61,16 @@ const bool &Kovan::autoFlush() const
 	return m_autoFlush;
 }
 
+static const double s_flushBounds[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000 };
+static Histogram s_flushTime("kovan.flush_us", s_flushBounds, sizeof(s_flushBounds) / sizeof(double));
+
 bool Kovan::flush()
 {
+	KOVAN_TRACE_SPAN("Kovan::flush");
+	Locker locker(m_mutex);
+	if(m_window > 1) return flushPipelined();
+	const unsigned long long start = Private::Time::monotonic();
+	
 	std::vector<Command> sendQueue = m_queue;
 	m_queue.clear();
 	
@@ -40,25 +79,247 @@ bool Kovan::flush()
 	stateCommand.type = StateCommandType;
 	sendQueue.push_back(stateCommand);
 	
-#ifdef LIBKOVAN_DEBUG
-	std::cout << "Sending queue to kovan module." << std::endl;
-#endif
+	DEBUG_LOG("Sending queue to kovan module");
 
+	if(!m_connected && !connect()) return false;
 	if(!m_module->send(sendQueue)) return false;
 	// TODO: This needs to be removed eventually.
-	if(!m_module->recv(m_currentState)) return false;
+	// Received aside so readers never see a half-written state
+	State state;
+	if(!m_module->recv(state)) return false;
+	m_currentState = state;
+	stateRefreshed();
+	s_flushTime.observe((Private::Time::monotonic() - start) / 1000.0);
 
-#ifdef LIBKOVAN_DEBUG	
-	std::cout << "Queue successfully sent with State response." << std::endl;
+	DEBUG_LOG("Queue successfully sent with State response");
+#ifdef LIBKOVAN_DEBUG
 	m_module->displayState(m_currentState);
 #endif
 	
 	return true;
 }
 
+static Histogram s_ackTime("kovan.ack_us", s_flushBounds, sizeof(s_flushBounds) / sizeof(double));
+static Gauge s_inFlight("kovan.in_flight");
+static Counter s_acksLost("kovan.acks_lost");
+
+// Replays writes the daemon hadn't seen yet when it sent state
+static void applyWrites(State &state, const std::vector<Command> &commands)
+{
+	for(std::vector<Command>::const_iterator it = commands.begin(); it != commands.end(); ++it) {
+		if(it->type != WriteCommandType) continue;
+		WriteCommand write;
+		memcpy(&write, it->data, sizeof(WriteCommand));
+		if(write.addy < TOTAL_REGS) state.t[write.addy] = write.val;
+	}
+}
+
+bool Kovan::flushPipelined()
+{
+	if(!m_connected && !connect()) return false;
+	
+	// Take whatever replies have already arrived
+	while(!m_inFlight.empty() && m_module->waitReadable(0)) {
+		if(!receiveAck()) return false;
+	}
+	
+	// Back-pressure. The daemon answers in order, so a packet whose reply
+	// doesn't come within the timeout is given up on.
+	while(m_inFlight.size() >= m_window) {
+		if(m_module->waitReadable(KOVAN_ACK_TIMEOUT)) {
+			if(!receiveAck()) return false;
+			continue;
+		}
+		WARN("No reply to packet %u within %d ms", m_inFlight.front().seq, KOVAN_ACK_TIMEOUT);
+		resync();
+	}
+	
+	InFlight packet;
+	packet.seq = ++m_seq;
+	packet.commands.swap(m_queue);
+	Command stateCommand;
+	stateCommand.type = StateCommandType;
+	packet.commands.push_back(stateCommand);
+	
+	packet.sent = Private::Time::monotonic();
+	if(!m_module->send(packet.commands)) return false;
+	m_inFlight.push_back(packet);
+	s_inFlight.set(m_inFlight.size());
+	return true;
+}
+
+bool Kovan::receiveAck()
+{
+	State state;
+	if(!m_module->recv(state)) return false;
+	
+	if(!m_inFlight.empty()) {
+		s_ackTime.observe((Private::Time::monotonic() - m_inFlight.front().sent) / 1000.0);
+		m_inFlight.pop_front();
+	}
+	s_inFlight.set(m_inFlight.size());
+	
+	// Keep the values of writes that are still on their way
+	for(std::deque<InFlight>::const_iterator it = m_inFlight.begin(); it != m_inFlight.end(); ++it) {
+		applyWrites(state, it->commands);
+	}
+	applyWrites(state, m_queue);
+	m_currentState = state;
+	stateRefreshed();
+	return true;
+}
+
+void Kovan::resync()
+{
+	// Replies don't say which packet they answer, so once one is overdue a
+	// late arrival would be taken for the next packet's. Drop everything in
+	// flight and wait for stragglers until the line goes quiet.
+	s_acksLost.increment(m_inFlight.size());
+	for(std::deque<InFlight>::const_iterator it = m_inFlight.begin(); it != m_inFlight.end(); ++it) {
+		applyWrites(m_currentState, it->commands);
+	}
+	m_inFlight.clear();
+	s_inFlight.set(0);
+	
+	// The last straggler answers the newest packet unless that one was lost
+	State state;
+	bool received = false;
+	while(m_module->waitReadable(KOVAN_ACK_TIMEOUT) && m_module->recv(state)) received = true;
+	if(!received) return;
+	applyWrites(state, m_queue);
+	m_currentState = state;
+	stateRefreshed();
+}
+
+bool Kovan::setWindow(const unsigned window)
+{
+	Locker locker(m_mutex);
+	if(window < 1 || window > KOVAN_MAX_WINDOW) {
+		WARN("Window must be between 1 and %d", KOVAN_MAX_WINDOW);
+		return false;
+	}
+	if(window > 1 && !m_module->supportsWindow()) {
+		WARN("This connection can't have more than one packet in flight");
+		return false;
+	}
+	if(window < m_inFlight.size() && !sync()) return false;
+	m_window = window;
+	return true;
+}
+
+unsigned Kovan::window() const
+{
+	return m_window;
+}
+
+bool Kovan::sync()
+{
+	KOVAN_TRACE_SPAN("Kovan::sync");
+	Locker locker(m_mutex);
+	if(!flush()) return false;
+	while(!m_inFlight.empty()) {
+		if(m_module->waitReadable(KOVAN_ACK_TIMEOUT)) {
+			if(!receiveAck()) return false;
+			continue;
+		}
+		resync();
+	}
+	return true;
+}
+
+static Histogram s_priorityTime("kovan.priority_us", s_flushBounds, sizeof(s_flushBounds) / sizeof(double));
+
+static bool writesSameRegister(const Command &command, const std::vector<Command> &commands)
+{
+	if(command.type != WriteCommandType) return false;
+	WriteCommand write;
+	memcpy(&write, command.data, sizeof(WriteCommand));
+	
+	for(std::vector<Command>::const_iterator it = commands.begin(); it != commands.end(); ++it) {
+		if(it->type != WriteCommandType) continue;
+		WriteCommand other;
+		memcpy(&other, it->data, sizeof(WriteCommand));
+		if(other.addy == write.addy) return true;
+	}
+	return false;
+}
+
+bool Kovan::sendPriority(const std::vector<Command> &commands)
+{
+	Locker locker(m_mutex);
+	KOVAN_TRACE_SPAN("Kovan::sendPriority");
+	const unsigned long long start = Private::Time::monotonic();
+	
+	std::vector<Command>::iterator it = m_queue.begin();
+	while(it != m_queue.end()) {
+		if(writesSameRegister(*it, commands)) it = m_queue.erase(it);
+		else ++it;
+	}
+	
+	std::vector<Command> sendQueue = commands;
+	Command stateCommand;
+	stateCommand.type = StateCommandType;
+	sendQueue.push_back(stateCommand);
+	
+	if(!m_connected && !connect()) return false;
+	if(!m_module->send(sendQueue)) return false;
+	// Replies to pipelined packets come first
+	while(!m_inFlight.empty()) {
+		if(!m_module->waitReadable(KOVAN_ACK_TIMEOUT)) {
+			// Our reply is lost among the late ones, so ask again
+			resync();
+			sendQueue.assign(1, stateCommand);
+			if(!m_module->send(sendQueue)) return false;
+			break;
+		}
+		if(!receiveAck()) return false;
+	}
+	State state;
+	if(!m_module->recv(state)) return false;
+	applyWrites(state, m_queue);
+	m_currentState = state;
+	stateRefreshed();
+	s_priorityTime.observe((Private::Time::monotonic() - start) / 1000.0);
+	return true;
+}
+
+bool Kovan::subscribe(const unsigned short first, const unsigned short count,
+	const unsigned short interval, const bool changesOnly)
+{
+	Locker locker(m_mutex);
+	if(!m_connected && !connect()) return false;
+	if(!m_module->subscribe(first, count, interval, changesOnly, KOVAN_ACK_TIMEOUT)) return false;
+	if(m_module->receivePushes(m_currentState)) stateRefreshed();
+	return true;
+}
+
+void Kovan::unsubscribe()
+{
+	Locker locker(m_mutex);
+	m_module->subscribe(0, 0, 0, false, 0);
+}
+
 void Kovan::autoUpdate()
 {
-	if(m_autoFlush) flush();
+	Locker locker(m_mutex);
+	if(!m_autoFlush) return;
+	
+	// Nothing to write, so the pushed state is as fresh as a reply
+	if(m_queue.empty() && m_inFlight.empty() && m_module->subscribed()) {
+		if(m_module->receivePushes(m_currentState)) stateRefreshed();
+		return;
+	}
+	flush();
+}
+
+void Kovan::lock()
+{
+	m_mutex.lock();
+}
+
+void Kovan::unlock()
+{
+	m_mutex.unlock();
 }
 
 State &Kovan::currentState()
@@ -66,27 +327,80 @@ State &Kovan::currentState()
 	return m_currentState;
 }
 
+unsigned short Kovan::registerValue(const unsigned short address)
+{
+	Locker locker(m_mutex);
+	return m_currentState.t[address];
+}
+
+unsigned long Kovan::stateSeq() const
+{
+	return m_stateSeq;
+}
+
+unsigned long long Kovan::stateTimestamp() const
+{
+	return m_stateTimestamp;
+}
+
+void Kovan::stateRefreshed()
+{
+	++m_stateSeq;
+	m_stateTimestamp = Private::Time::monotonic();
+}
+
 Kovan *Kovan::instance()
 {
 	static Kovan s_instance;
 	return &s_instance;
 }
 
+bool Kovan::setBridge(const char *const host)
+{
+	Locker locker(m_mutex);
+	if(m_connected) {
+		WARN("Already connected");
+		return false;
+	}
+	
+	KovanModule *const module = RemoteKovanModule::create(host);
+	if(!module) return false;
+	delete m_module;
+	m_module = module;
+	if(!m_module->supportsWindow()) m_window = 1;
+	return true;
+}
+
 Kovan::Kovan()
-	// TODO: This needs to be exposed via API (remote libkovan connection)
-	: m_module(new KovanModule(inet_addr("127.0.0.1"), htons(4628))),
-	m_autoFlush(true)
+	: m_mutex(true),
+	m_module(new KovanModule(inet_addr("127.0.0.1"), htons(4628))),
+	m_connected(false),
+	m_stateSeq(0),
+	m_stateTimestamp(0),
+	m_autoFlush(true),
+	m_window(1),
+	m_seq(0)
+{
+	const char *const bridge = getenv("KOVAN_BRIDGE");
+	if(bridge && *bridge) setBridge(bridge);
+}
+
+static Gauge s_connectTime("init.kovan_us");
+
+bool Kovan::connect()
 {
+	InitTimer timer(s_connectTime, "Kovan::connect");
+	
 	// Create the socket descriptor for communication
-	if(!m_module->init()) {
-		// TODO: Error Reporting?
-		return;
-	}
+	if(!m_module->init()) return false;
 	
 	// Bind out client to an address
 	if(!m_module->bind(htonl(INADDR_ANY), htons(8374))) {
-		// TODO: Error Reporting?
-		return;
+		m_module->close();
+		return false;
 	}
+	
+	m_connected = true;
+	return true;
 }
 
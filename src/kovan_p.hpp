@@ -2,9 +2,14 @@
 #define _KOVAN_P_HPP_
 
 #include "kovan_command_p.hpp"
+#include "kovan/thread.hpp"
 
+#include <deque>
 #include <vector>
 
+#define KOVAN_MAX_WINDOW 64
+#define KOVAN_ACK_TIMEOUT 100 // ms
+
 namespace Private
 {
 	class KovanModule;
@@ -20,19 +25,88 @@ namespace Private
 		const bool &autoFlush() const;
 		bool flush();
 		
+		// Allows up to window packets to be in flight at once. flush()
+		// then only blocks when the window is full, and currentState() may
+		// be up to window replies old. 1, the default, waits for the reply
+		// to every packet. Only the local daemon supports more than 1.
+		bool setWindow(const unsigned window);
+		unsigned window() const;
+		
+		// Flushes and waits until every packet in flight has been answered
+		bool sync();
+		
+		// Sends commands right away, ahead of anything queued. Queued writes
+		// to the same registers are dropped so they can't undo these.
+		bool sendPriority(const std::vector<Command> &commands);
+		
+		// Has the daemon push changes to registers [first, first + count), at
+		// most once every interval ms. While subscribed, reads with an empty
+		// queue are answered from the pushed state instead of a round trip,
+		// so registers outside the range are only refreshed by writes.
+		bool subscribe(const unsigned short first, const unsigned short count,
+			const unsigned short interval, const bool changesOnly);
+		void unsubscribe();
+		
 		void autoUpdate();
 		
+		// Every method takes this recursive lock. Hold it as well to make a
+		// read-modify-write of currentState() atomic, or while reading it:
+		// replies replace the state under the lock from other threads.
+		void lock();
+		void unlock();
+		
 		State &currentState();
 		
+		// Reads one register of currentState() under the lock
+		unsigned short registerValue(const unsigned short address);
+		
+		// Incremented each time currentState() is refreshed by a reply or
+		// a push, along with when that happened on the Time::monotonic() clock
+		unsigned long stateSeq() const;
+		unsigned long long stateTimestamp() const;
+		
+		// Sends commands to a kovan-bridge on host instead of the local
+		// daemon. Only possible before the first flush. The KOVAN_BRIDGE
+		// environment variable does the same.
+		bool setBridge(const char *const host);
+		
 		static Kovan *instance();
 	private:
 		Kovan();
 		
+		// Creates and binds the socket on the first flush
+		bool connect();
+		
+		bool flushPipelined();
+		
+		// Receives the reply to the oldest packet in flight
+		bool receiveAck();
+		
+		// Gives up on every packet in flight after a reply is overdue
+		void resync();
+		
+		void stateRefreshed();
+		
+		struct InFlight
+		{
+			unsigned seq;
+			unsigned long long sent;
+			std::vector<Command> commands;
+		};
+		
+		Mutex m_mutex;
 		KovanModule *m_module;
+		bool m_connected;
 		State m_currentState;
+		unsigned long m_stateSeq;
+		unsigned long long m_stateTimestamp;
 		
 		bool m_autoFlush;
 		std::vector<Command> m_queue;
+		
+		unsigned m_window;
+		unsigned m_seq;
+		std::deque<InFlight> m_inFlight;
 	};
 }
 
@@ -0,0 +1,211 @@
+#include "kovan_pool_p.hpp"
+
+#include "kovan_module_p.hpp"
+#include "kovan/metrics.hpp"
+#include "kovan/trace.hpp"
+#include "time_p.hpp"
+#include "warn.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Private;
+
+static Counter s_poolTimeouts("pool.timeouts");
+static Counter s_poolLateReplies("pool.late_replies");
+static Gauge s_poolBoards("pool.boards");
+
+static const double s_flushBounds[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000 };
+static Histogram s_poolFlushTime("pool.flush_us", s_flushBounds, sizeof(s_flushBounds) / sizeof(double));
+
+KovanBoard::KovanBoard(KovanModule *const module)
+	: m_module(module),
+	m_waiting(false),
+	m_replied(false),
+	m_seq(0)
+{
+	memset(&m_state, 0, sizeof(State));
+}
+
+KovanBoard::~KovanBoard()
+{
+	delete m_module;
+}
+
+void KovanBoard::event(EventLoop *const, const int, const unsigned)
+{
+	State state;
+	if(!m_module->recv(state)) return;
+	
+	if(m_inFlight.empty()) {
+		WARN("Unexpected reply from a board");
+		return;
+	}
+	const unsigned seq = m_inFlight.front().seq;
+	m_inFlight.pop_front();
+	
+	// A reply to a packet from a flush that already timed out
+	if(!m_waiting || seq != m_seq) {
+		s_poolLateReplies.increment();
+		return;
+	}
+	m_state = state;
+	m_waiting = false;
+	m_replied = true;
+	--KovanPool::instance()->m_pending;
+}
+
+void KovanBoard::expire(const unsigned long long now)
+{
+	while(!m_inFlight.empty() && now - m_inFlight.front().sent >= KOVAN_POOL_EXPIRE * 1000000ULL) {
+		m_inFlight.pop_front();
+	}
+}
+
+KovanPool::~KovanPool()
+{
+	for(std::vector<KovanBoard *>::iterator it = m_boards.begin(); it != m_boards.end(); ++it) {
+		m_loop.remove((*it)->m_module->descriptor());
+		delete *it;
+	}
+}
+
+KovanBoard *KovanPool::open(const char *const address)
+{
+	uint64_t host = 0;
+	uint16_t port = 0;
+	if(!KovanModule::resolve(address, 4628, host, port)) return 0;
+	
+	KovanModule *const module = new KovanModule(host, port);
+	if(!module->init() || !module->bind(htonl(INADDR_ANY), 0)) {
+		delete module;
+		return 0;
+	}
+	
+	KovanBoard *const board = new KovanBoard(module);
+	m_mutex.lock();
+	if(!m_loop.add(module->descriptor(), EventLoop::Readable, board)) {
+		m_mutex.unlock();
+		delete board;
+		return 0;
+	}
+	m_boards.push_back(board);
+	s_poolBoards.set(m_boards.size());
+	m_mutex.unlock();
+	
+	// Start with the board's actual state
+	if(!flush(board)) {
+		close(board);
+		return 0;
+	}
+	return board;
+}
+
+void KovanPool::close(KovanBoard *const board)
+{
+	if(!board) return;
+	m_mutex.lock();
+	std::vector<KovanBoard *>::iterator it = std::find(m_boards.begin(), m_boards.end(), board);
+	if(it != m_boards.end()) {
+		m_boards.erase(it);
+		m_loop.remove(board->m_module->descriptor());
+		delete board;
+	}
+	s_poolBoards.set(m_boards.size());
+	m_mutex.unlock();
+}
+
+void KovanPool::write(KovanBoard *const board, const unsigned short address, const unsigned short value)
+{
+	if(address >= TOTAL_REGS) return;
+	m_mutex.lock();
+	board->m_state.t[address] = value;
+	board->m_queue.push_back(createWriteCommand(address, value));
+	m_mutex.unlock();
+}
+
+unsigned short KovanPool::read(KovanBoard *const board, const unsigned short address)
+{
+	if(address >= TOTAL_REGS) return 0;
+	m_mutex.lock();
+	const unsigned short ret = board->m_state.t[address];
+	m_mutex.unlock();
+	return ret;
+}
+
+bool KovanPool::flush(KovanBoard *const board)
+{
+	m_mutex.lock();
+	const bool ret = flush(std::vector<KovanBoard *>(1, board)) == 1;
+	m_mutex.unlock();
+	return ret;
+}
+
+unsigned KovanPool::flushAll()
+{
+	m_mutex.lock();
+	const unsigned ret = flush(m_boards);
+	m_mutex.unlock();
+	return ret;
+}
+
+KovanPool *KovanPool::instance()
+{
+	static KovanPool s_instance;
+	return &s_instance;
+}
+
+KovanPool::KovanPool()
+	: m_pending(0)
+{
+}
+
+unsigned KovanPool::flush(const std::vector<KovanBoard *> &boards)
+{
+	KOVAN_TRACE_SPAN("KovanPool::flush");
+	const unsigned long long start = Private::Time::monotonic();
+	
+	// Late replies from an earlier flush
+	m_loop.runOnce(0);
+	
+	Command stateCommand;
+	stateCommand.type = StateCommandType;
+	
+	m_pending = 0;
+	for(std::vector<KovanBoard *>::const_iterator it = boards.begin(); it != boards.end(); ++it) {
+		KovanBoard *const board = *it;
+		board->m_replied = false;
+		board->m_queue.push_back(stateCommand);
+		board->m_waiting = board->m_module->send(board->m_queue);
+		board->m_queue.clear();
+		if(!board->m_waiting) continue;
+		
+		board->expire(start);
+		KovanBoard::InFlight packet;
+		packet.seq = ++board->m_seq;
+		packet.sent = start;
+		board->m_inFlight.push_back(packet);
+		++m_pending;
+	}
+	
+	const unsigned long long deadline = start + KOVAN_POOL_TIMEOUT * 1000000ULL;
+	while(m_pending) {
+		const unsigned long long now = Private::Time::monotonic();
+		if(now >= deadline) break;
+		m_loop.runOnce((deadline - now + 999999ULL) / 1000000ULL);
+	}
+	
+	unsigned replied = 0;
+	for(std::vector<KovanBoard *>::const_iterator it = boards.begin(); it != boards.end(); ++it) {
+		if((*it)->m_replied) ++replied;
+		if(!(*it)->m_waiting) continue;
+		s_poolTimeouts.increment();
+		(*it)->m_waiting = false;
+	}
+	if(m_pending) WARN("%u of %lu boards didn't reply within %d ms", m_pending,
+		(unsigned long)boards.size(), KOVAN_POOL_TIMEOUT);
+	m_pending = 0;
+	
+	s_poolFlushTime.observe((Private::Time::monotonic() - start) / 1000.0);
+	return replied;
+}
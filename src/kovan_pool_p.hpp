@@ -0,0 +1,87 @@
+#ifndef _KOVAN_POOL_P_HPP_
+#define _KOVAN_POOL_P_HPP_
+
+#include "kovan_command_p.hpp"
+#include "kovan/event_loop.hpp"
+#include "kovan/thread.hpp"
+
+#include <deque>
+#include <vector>
+
+#define KOVAN_POOL_TIMEOUT 100 // ms
+#define KOVAN_POOL_EXPIRE 1000 // ms, after which an unanswered packet is assumed lost
+
+namespace Private
+{
+	class KovanModule;
+	
+	// One Kovan in a KovanPool, with its own command queue and state
+	class KovanBoard : public EventHandler
+	{
+	public:
+		KovanBoard(KovanModule *const module);
+		~KovanBoard();
+		
+		virtual void event(EventLoop *const loop, const int fd, const unsigned events);
+		
+	private:
+		friend class KovanPool;
+		
+		// Forgets packets whose replies have been overdue for too long
+		void expire(const unsigned long long now);
+		
+		struct InFlight
+		{
+			unsigned seq;
+			unsigned long long sent;
+		};
+		
+		KovanModule *m_module;
+		std::vector<Command> m_queue;
+		State m_state;
+		bool m_waiting;
+		bool m_replied;
+		
+		// The daemon answers in order, so each reply belongs to the oldest
+		// packet still in flight. Only a reply to m_seq is current.
+		unsigned m_seq;
+		std::deque<InFlight> m_inFlight;
+	};
+	
+	// Drives several Kovans from one process. Boards are flushed together:
+	// every packet is sent first and the replies are collected on one event
+	// loop, so a flush takes one round trip however many boards there are.
+	class KovanPool
+	{
+	public:
+		~KovanPool();
+		
+		// address is "host[:port]"; the port defaults to the daemon's
+		KovanBoard *open(const char *const address);
+		void close(KovanBoard *const board);
+		
+		void write(KovanBoard *const board, const unsigned short address, const unsigned short value);
+		unsigned short read(KovanBoard *const board, const unsigned short address);
+		
+		bool flush(KovanBoard *const board);
+		
+		// Returns the number of boards that replied
+		unsigned flushAll();
+		
+		static KovanPool *instance();
+		
+	private:
+		friend class KovanBoard;
+		
+		KovanPool();
+		
+		unsigned flush(const std::vector<KovanBoard *> &boards);
+		
+		EventLoop m_loop;
+		Mutex m_mutex;
+		std::vector<KovanBoard *> m_boards;
+		unsigned m_pending;
+	};
+}
+
+#endif
@@ -0,0 +1,283 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/log.hpp"
+#include "kovan/queue.hpp"
+#include "kovan/thread.hpp"
+
+#include <cstdarg>
+#include <cstdlib>
+
+#include "time_p.hpp"
+
+#define LOG_QUEUE_SIZE 256
+#define LOG_MESSAGE_SIZE 192
+#define LOG_DRAIN_INTERVAL 20
+
+namespace
+{
+	struct LogRecord
+	{
+		int level;
+		const char *where;
+		char text[LOG_MESSAGE_SIZE];
+	};
+	
+	class LogWriter : public Thread
+	{
+	public:
+		LogWriter();
+		~LogWriter();
+		
+		void push(const LogRecord &record);
+		void flush();
+		void setOutput(FILE *const fp, const bool owned);
+		
+		unsigned long dropped() const;
+		
+		virtual void run();
+		
+	private:
+		void drain();
+		
+		MpscQueue<LogRecord> m_queue;
+		
+		Mutex m_outputMutex;
+		FILE *m_output;
+		bool m_ownsOutput;
+		
+		Mutex m_mutex;
+		ConditionVariable m_wake;
+		ConditionVariable m_drained;
+		volatile bool m_stop;
+		bool m_idle; // Set while the writer may sleep on m_wake
+		
+		unsigned long m_queued;
+		unsigned long m_written;
+		unsigned long m_dropped;
+	};
+}
+
+static const char *const s_levelNames[] = { "debug", "info", "warning", "error" };
+
+static int initialLevel()
+{
+	const char *const env = getenv("KOVAN_LOG_LEVEL");
+	if(!env) return Log::Info;
+	const int level = atoi(env);
+	return level < Log::Debug || level > Log::Off ? Log::Info : level;
+}
+
+volatile int Log::s_level = initialLevel();
+
+// Set once the writer has been destroyed at exit. Later messages are written directly.
+static volatile bool s_writerGone = false;
+
+static void writeRecord(FILE *const fp, const LogRecord &record)
+{
+	fprintf(fp, "%s: %s: %s\n", record.where, s_levelNames[record.level], record.text);
+}
+
+LogWriter::LogWriter()
+	: m_queue(LOG_QUEUE_SIZE),
+	m_output(stderr),
+	m_ownsOutput(false),
+	m_stop(false),
+	m_idle(false),
+	m_queued(0),
+	m_written(0),
+	m_dropped(0)
+{
+	start();
+}
+
+LogWriter::~LogWriter()
+{
+	m_mutex.lock();
+	m_stop = true;
+	m_wake.signal();
+	m_mutex.unlock();
+	join();
+	
+	drain();
+	s_writerGone = true;
+	if(m_ownsOutput) fclose(m_output);
+}
+
+void LogWriter::push(const LogRecord &record)
+{
+	if(!m_queue.push(record)) {
+		__sync_fetch_and_add(&m_dropped, 1);
+		return;
+	}
+	__sync_fetch_and_add(&m_queued, 1);
+	
+	// Only an idle writer needs the mutex taken to wake it
+	if(__atomic_load_n(&m_idle, __ATOMIC_SEQ_CST)) {
+		m_mutex.lock();
+		m_wake.signal();
+		m_mutex.unlock();
+	}
+}
+
+void LogWriter::flush()
+{
+	const unsigned long target = __atomic_load_n(&m_queued, __ATOMIC_ACQUIRE);
+	m_mutex.lock();
+	m_wake.signal();
+	while(m_written < target && !m_stop) m_drained.wait(m_mutex, LOG_DRAIN_INTERVAL);
+	m_mutex.unlock();
+}
+
+void LogWriter::setOutput(FILE *const fp, const bool owned)
+{
+	m_outputMutex.lock();
+	if(m_ownsOutput) fclose(m_output);
+	m_output = fp;
+	m_ownsOutput = owned;
+	m_outputMutex.unlock();
+}
+
+unsigned long LogWriter::dropped() const
+{
+	return m_dropped;
+}
+
+void LogWriter::run()
+{
+	m_mutex.lock();
+	while(!m_stop) {
+		// Announce we're idle before checking the count, so a producer
+		// either sees the flag or we see its record
+		__atomic_store_n(&m_idle, true, __ATOMIC_SEQ_CST);
+		if(__atomic_load_n(&m_queued, __ATOMIC_SEQ_CST) <= m_written) m_wake.wait(m_mutex);
+		__atomic_store_n(&m_idle, false, __ATOMIC_SEQ_CST);
+		m_mutex.unlock();
+		drain();
+		m_mutex.lock();
+	}
+	m_mutex.unlock();
+}
+
+void LogWriter::drain()
+{
+	LogRecord record;
+	unsigned long count = 0;
+	
+	m_outputMutex.lock();
+	while(m_queue.pop(record)) {
+		writeRecord(m_output, record);
+		++count;
+	}
+	if(count) fflush(m_output);
+	m_outputMutex.unlock();
+	
+	if(!count) return;
+	m_mutex.lock();
+	m_written += count;
+	m_drained.broadcast();
+	m_mutex.unlock();
+}
+
+static LogWriter *writer()
+{
+	static LogWriter s_writer;
+	return &s_writer;
+}
+
+void Log::setLevel(const Level level)
+{
+	s_level = level;
+}
+
+Log::Level Log::level()
+{
+	return (Level)s_level;
+}
+
+void Log::setOutput(FILE *const fp)
+{
+	writer()->setOutput(fp, false);
+}
+
+bool Log::setFile(const char *const path)
+{
+	FILE *const fp = fopen(path, "a");
+	if(!fp) return false;
+	writer()->setOutput(fp, true);
+	return true;
+}
+
+void Log::write(const Level level, const char *const where, const char *const format, ...)
+{
+	if(!isEnabled(level) || level >= Off) return;
+	
+	LogRecord record;
+	record.level = level;
+	record.where = where;
+	
+	va_list args;
+	va_start(args, format);
+	vsnprintf(record.text, sizeof(record.text), format, args);
+	va_end(args);
+	
+	if(s_writerGone) {
+		writeRecord(stderr, record);
+		return;
+	}
+	writer()->push(record);
+}
+
+void Log::flush()
+{
+	if(!s_writerGone) writer()->flush();
+}
+
+unsigned long Log::dropped()
+{
+	return writer()->dropped();
+}
+
+LogLimiter::LogLimiter()
+	: m_windowStart(0),
+	m_count(0),
+	m_suppressed(0)
+{
+}
+
+bool LogLimiter::allow(unsigned long &suppressed)
+{
+	// Races between threads only blur the counts, which is fine for a limiter
+	const unsigned long long now = Private::Time::monotonic();
+	if(now - m_windowStart >= 1000000000ULL) {
+		m_windowStart = now;
+		m_count = 0;
+	}
+	
+	if(m_count >= LOG_RATE_LIMIT) {
+		++m_suppressed;
+		return false;
+	}
+	
+	++m_count;
+	suppressed = m_suppressed;
+	m_suppressed = 0;
+	return true;
+}
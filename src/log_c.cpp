@@ -0,0 +1,65 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/log.h"
+#include "kovan/log.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+
+void log_set_level(int level)
+{
+	if(level < Log::Debug) level = Log::Debug;
+	if(level > Log::Off) level = Log::Off;
+	Log::setLevel((Log::Level)level);
+}
+
+int log_get_level()
+{
+	return Log::level();
+}
+
+int log_set_file(const char *path)
+{
+	return Log::setFile(path) ? 1 : 0;
+}
+
+void log_message(int level, const char *format, ...)
+{
+	if(level < Log::Debug || level >= Log::Off || !Log::isEnabled((Log::Level)level)) return;
+	
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	
+	Log::write((Log::Level)level, "user", "%s", buffer);
+}
+
+void log_flush()
+{
+	Log::flush();
+}
+
+unsigned long log_dropped()
+{
+	return Log::dropped();
+}
@@ -0,0 +1,322 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/metrics.hpp"
+#include "kovan/periodic.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "warn.hpp"
+
+static unsigned long long doubleBits(const double value)
+{
+	unsigned long long ret;
+	memcpy(&ret, &value, sizeof(ret));
+	return ret;
+}
+
+static double bitsDouble(const unsigned long long bits)
+{
+	double ret;
+	memcpy(&ret, &bits, sizeof(ret));
+	return ret;
+}
+
+static void writeJsonString(FILE *const fp, const char *s)
+{
+	fputc('"', fp);
+	for(; *s; ++s) {
+		if(*s == '"' || *s == '\\') fputc('\\', fp);
+		if((unsigned char)*s < 0x20) continue;
+		fputc(*s, fp);
+	}
+	fputc('"', fp);
+}
+
+class MetricsDumper : public PeriodicTask
+{
+public:
+	MetricsDumper(const char *const path, const bool json)
+		: m_path(path && strcmp(path, "-") ? path : ""),
+		m_json(json)
+	{
+	}
+	
+	~MetricsDumper()
+	{
+		// period() drops to 0 if the executor has already been destroyed
+		if(period()) PeriodicExecutor::instance()->remove(this);
+	}
+	
+	virtual void run()
+	{
+		if(m_path.empty()) {
+			MetricsRegistry::instance()->dump(stdout, m_json);
+			fflush(stdout);
+			return;
+		}
+		
+		// Write a temporary file and rename it so readers never see a partial dump
+		const std::string temp = m_path + ".tmp";
+		if(!MetricsRegistry::instance()->dump(temp.c_str(), m_json)) return;
+		if(rename(temp.c_str(), m_path.c_str()) < 0) PWARN("rename %s", m_path.c_str());
+	}
+	
+private:
+	std::string m_path;
+	bool m_json;
+};
+
+Metric::Metric(const char *const name, const Type type)
+	: m_name(name),
+	m_type(type)
+{
+	MetricsRegistry::instance()->add(this);
+}
+
+Metric::~Metric()
+{
+	MetricsRegistry::instance()->remove(this);
+}
+
+const char *Metric::name() const
+{
+	return m_name;
+}
+
+Metric::Type Metric::type() const
+{
+	return m_type;
+}
+
+Counter::Counter(const char *const name)
+	: Metric(name, CounterType),
+	m_count(0)
+{
+}
+
+unsigned long long Counter::count() const
+{
+	return __atomic_load_n(&m_count, __ATOMIC_RELAXED);
+}
+
+double Counter::value() const
+{
+	return count();
+}
+
+Gauge::Gauge(const char *const name)
+	: Metric(name, GaugeType),
+	m_bits(doubleBits(0.0))
+{
+}
+
+void Gauge::set(const double value)
+{
+	__atomic_store_n(&m_bits, doubleBits(value), __ATOMIC_RELAXED);
+}
+
+double Gauge::value() const
+{
+	return bitsDouble(__atomic_load_n(&m_bits, __ATOMIC_RELAXED));
+}
+
+Histogram::Histogram(const char *const name, const double *const bounds, const unsigned count)
+	: Metric(name, HistogramType),
+	m_buckets(std::min(count, (unsigned)METRICS_MAX_BUCKETS - 1) + 1),
+	m_total(0),
+	m_sumBits(doubleBits(0.0))
+{
+	for(unsigned i = 0; i + 1 < m_buckets; ++i) m_bounds[i] = bounds[i];
+	m_bounds[m_buckets - 1] = 1.0 / 0.0;
+	memset(m_counts, 0, sizeof(m_counts));
+}
+
+void Histogram::observe(const double value)
+{
+	unsigned bucket = 0;
+	while(bucket + 1 < m_buckets && value > m_bounds[bucket]) ++bucket;
+	__atomic_fetch_add(&m_counts[bucket], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&m_total, 1, __ATOMIC_RELAXED);
+	
+	unsigned long long expected = __atomic_load_n(&m_sumBits, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(&m_sumBits, &expected, doubleBits(bitsDouble(expected) + value),
+		true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+unsigned Histogram::buckets() const
+{
+	return m_buckets;
+}
+
+double Histogram::bound(const unsigned i) const
+{
+	return i < m_buckets ? m_bounds[i] : 0.0;
+}
+
+unsigned long long Histogram::bucketCount(const unsigned i) const
+{
+	return i < m_buckets ? __atomic_load_n(&m_counts[i], __ATOMIC_RELAXED) : 0;
+}
+
+double Histogram::sum() const
+{
+	return bitsDouble(__atomic_load_n(&m_sumBits, __ATOMIC_RELAXED));
+}
+
+double Histogram::value() const
+{
+	return __atomic_load_n(&m_total, __ATOMIC_RELAXED);
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+	stopDumping();
+}
+
+std::vector<Metric *> MetricsRegistry::metrics() const
+{
+	m_mutex.lock();
+	const std::vector<Metric *> ret = m_metrics;
+	m_mutex.unlock();
+	return ret;
+}
+
+Metric *MetricsRegistry::find(const char *const name) const
+{
+	Metric *ret = 0;
+	m_mutex.lock();
+	for(std::vector<Metric *>::const_iterator it = m_metrics.begin(); it != m_metrics.end(); ++it) {
+		if(strcmp((*it)->name(), name)) continue;
+		ret = *it;
+		break;
+	}
+	m_mutex.unlock();
+	return ret;
+}
+
+void MetricsRegistry::dump(FILE *const fp, const bool json, const char *const prefix) const
+{
+	const size_t prefixLength = prefix ? strlen(prefix) : 0;
+	bool first = true;
+	
+	// Hold the lock so no metric is destroyed while it is being printed
+	m_mutex.lock();
+	if(json) fputc('{', fp);
+	for(std::vector<Metric *>::const_iterator it = m_metrics.begin(); it != m_metrics.end(); ++it) {
+		const Metric *const metric = *it;
+		if(prefixLength && strncmp(metric->name(), prefix, prefixLength)) continue;
+		
+		if(json) {
+			if(!first) fputc(',', fp);
+			writeJsonString(fp, metric->name());
+			fputc(':', fp);
+		} else fprintf(fp, "%s ", metric->name());
+		first = false;
+		
+		if(metric->type() != Metric::HistogramType) {
+			fprintf(fp, json ? "%.17g" : "%.17g\n", metric->value());
+			continue;
+		}
+		
+		const Histogram *const histogram = static_cast<const Histogram *>(metric);
+		if(json) {
+			fprintf(fp, "{\"count\":%.0f,\"sum\":%.17g,\"buckets\":[", histogram->value(), histogram->sum());
+			for(unsigned i = 0; i < histogram->buckets(); ++i) {
+				fprintf(fp, "%s%llu", i ? "," : "", histogram->bucketCount(i));
+			}
+			fprintf(fp, "],\"bounds\":[");
+			for(unsigned i = 0; i + 1 < histogram->buckets(); ++i) {
+				fprintf(fp, "%s%.17g", i ? "," : "", histogram->bound(i));
+			}
+			fprintf(fp, "]}");
+		} else {
+			fprintf(fp, "count=%.0f sum=%.17g", histogram->value(), histogram->sum());
+			for(unsigned i = 0; i < histogram->buckets(); ++i) {
+				if(i + 1 < histogram->buckets()) fprintf(fp, " le%g=%llu", histogram->bound(i), histogram->bucketCount(i));
+				else fprintf(fp, " inf=%llu", histogram->bucketCount(i));
+			}
+			fputc('\n', fp);
+		}
+	}
+	if(json) fprintf(fp, "}\n");
+	m_mutex.unlock();
+}
+
+bool MetricsRegistry::dump(const char *const path, const bool json) const
+{
+	FILE *const fp = fopen(path, "w");
+	if(!fp) return false;
+	dump(fp, json);
+	return fclose(fp) == 0;
+}
+
+bool MetricsRegistry::startDumping(const char *const path, const bool json, const unsigned long msecs)
+{
+	stopDumping();
+	
+	MetricsDumper *const dumper = new MetricsDumper(path, json);
+	if(!PeriodicExecutor::instance()->add(dumper, msecs * 1000UL)) {
+		delete dumper;
+		return false;
+	}
+	
+	m_mutex.lock();
+	m_dumper = dumper;
+	m_mutex.unlock();
+	return true;
+}
+
+void MetricsRegistry::stopDumping()
+{
+	m_mutex.lock();
+	MetricsDumper *const dumper = m_dumper;
+	m_dumper = 0;
+	m_mutex.unlock();
+	delete dumper;
+}
+
+MetricsRegistry *MetricsRegistry::instance()
+{
+	static MetricsRegistry s_instance;
+	return &s_instance;
+}
+
+MetricsRegistry::MetricsRegistry()
+	: m_dumper(0)
+{
+}
+
+void MetricsRegistry::add(Metric *const metric)
+{
+	m_mutex.lock();
+	m_metrics.push_back(metric);
+	m_mutex.unlock();
+}
+
+void MetricsRegistry::remove(Metric *const metric)
+{
+	m_mutex.lock();
+	std::vector<Metric *>::iterator it = std::find(m_metrics.begin(), m_metrics.end(), metric);
+	if(it != m_metrics.end()) m_metrics.erase(it);
+	m_mutex.unlock();
+}
@@ -0,0 +1,115 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/metrics.h"
+#include "kovan/metrics.hpp"
+
+#include <cstring>
+
+static Metric *metricAt(const int i)
+{
+	const std::vector<Metric *> metrics = MetricsRegistry::instance()->metrics();
+	if(i < 0 || i >= (int)metrics.size()) return 0;
+	return metrics[i];
+}
+
+static Histogram *histogramAt(const int i)
+{
+	Metric *const metric = metricAt(i);
+	if(!metric || metric->type() != Metric::HistogramType) return 0;
+	return static_cast<Histogram *>(metric);
+}
+
+int metrics_count()
+{
+	return MetricsRegistry::instance()->metrics().size();
+}
+
+const char *metric_name(int i)
+{
+	Metric *const metric = metricAt(i);
+	return metric ? metric->name() : 0;
+}
+
+int metric_type(int i)
+{
+	Metric *const metric = metricAt(i);
+	return metric ? metric->type() : -1;
+}
+
+double metric_value(int i)
+{
+	Metric *const metric = metricAt(i);
+	return metric ? metric->value() : 0.0;
+}
+
+double metric_value_by_name(const char *name)
+{
+	Metric *const metric = MetricsRegistry::instance()->find(name);
+	return metric ? metric->value() : 0.0;
+}
+
+int metric_histogram_buckets(int i)
+{
+	Histogram *const histogram = histogramAt(i);
+	return histogram ? histogram->buckets() : 0;
+}
+
+double metric_histogram_bound(int i, int bucket)
+{
+	Histogram *const histogram = histogramAt(i);
+	return histogram && bucket >= 0 ? histogram->bound(bucket) : 0.0;
+}
+
+unsigned long metric_histogram_count(int i, int bucket)
+{
+	Histogram *const histogram = histogramAt(i);
+	return histogram && bucket >= 0 ? histogram->bucketCount(bucket) : 0;
+}
+
+double metric_histogram_sum(int i)
+{
+	Histogram *const histogram = histogramAt(i);
+	return histogram ? histogram->sum() : 0.0;
+}
+
+int metrics_dump(const char *path, int json)
+{
+	if(!path || !strcmp(path, "-")) {
+		MetricsRegistry::instance()->dump(stdout, json);
+		return 1;
+	}
+	return MetricsRegistry::instance()->dump(path, json) ? 1 : 0;
+}
+
+int metrics_start_dump(const char *path, int json, unsigned long msecs)
+{
+	return MetricsRegistry::instance()->startDumping(path, json, msecs) ? 1 : 0;
+}
+
+void metrics_stop_dump()
+{
+	MetricsRegistry::instance()->stopDumping();
+}
+
+void print_startup_profile()
+{
+	MetricsRegistry::instance()->dump(stdout, false, "init.");
+}
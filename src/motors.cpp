@@ -21,6 +21,8 @@
 #include "kovan/motors.hpp"
 #include "kovan/util.h"
 #include "motors_p.hpp"
+#include "stall_p.hpp"
+#include "kovan_p.hpp"
 #include <cstdlib>
 #include <math.h>
 
@@ -79,8 +81,15 @@ bool Motor::isMotorDone() const
 
 void Motor::blockMotorDone() const
 {
-	msleep(50);
-	while(isMotorDone()) msleep(40);
+	Private::StallMonitor *const monitor = Private::StallMonitor::instance();
+	do {
+		if(monitor->waitForStall(m_port, 50)) return;
+	} while(!isMotorDone());
+}
+
+bool Motor::isStalled() const
+{
+	return Private::StallMonitor::instance()->stalled(m_port);
 }
 
 void Motor::forward()
@@ -121,6 +130,15 @@ int BackEMF::value() const
 	return Private::Motor::instance()->backEMF(m_port);
 }
 
+Sample<int> BackEMF::sample() const
+{
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	const Sample<int> ret(value(), kovan->stateTimestamp(), kovan->stateSeq());
+	kovan->unlock();
+	return ret;
+}
+
 unsigned char BackEMF::port() const
 {
 	return m_port;
@@ -20,7 +20,11 @@
 
 #include "kovan/motors.h"
 #include "kovan/util.h"
+#include "kovan/motors.hpp"
 #include "motors_p.hpp"
+#include "stop_p.hpp"
+#include "stall_p.hpp"
+#include "sample_p.hpp"
 
 #include <iostream>
 #include <cstdlib>
@@ -31,6 +35,12 @@ int get_motor_position_counter(int motor)
 	return Private::Motor::instance()->backEMF(motor);
 }
 
+int get_motor_position_counter_sample(int motor, sensor_sample *sample)
+{
+	if(!sample) return 0;
+	return Private::copySample(BackEMF(motor).sample(), sample);
+}
+
 void clear_motor_position_counter(int motor)
 {
 	Private::Motor::instance()->clearBemf(motor);
@@ -103,7 +113,13 @@ int get_motor_done(int motor)
 
 void block_motor_done(int motor)
 {
-	while(!get_motor_done(motor));
+	if(motor < 0 || motor > 3) return;
+	Private::StallMonitor *const monitor = Private::StallMonitor::instance();
+	
+	// Give the PID control loop time to run, but wake up as soon as a stall is seen
+	do {
+		if(monitor->waitForStall(motor, 50)) return;
+	} while(Private::Motor::instance()->isPidActive(motor));
 }
 
 void bmd(int motor)
@@ -111,6 +127,22 @@ void bmd(int motor)
 	block_motor_done(motor);
 }
 
+int get_motor_stalled(int motor)
+{
+	return Private::StallMonitor::instance()->stalled(motor) ? 1 : 0;
+}
+
+void set_motor_stall_time(int motor, int msecs)
+{
+	if(msecs < 0) return;
+	Private::StallMonitor::instance()->setStallTime(motor, msecs);
+}
+
+void set_motor_stall_stop(int on)
+{
+	Private::StallMonitor::instance()->setStopOnStall(on);
+}
+
 int setpwm(int motor, int pwm)
 {
 	Private::Motor::instance()->setPwm(motor, pwm);
@@ -153,5 +185,5 @@ void alloff()
 
 void ao()
 {
-	for(unsigned char i = 0; i < 4; ++i) off(i);
+	Private::EmergencyStop::trigger(Private::EmergencyStop::Motors);
 }
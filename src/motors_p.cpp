@@ -21,8 +21,8 @@
 #include "motors_p.hpp"
 #include "kovan_p.hpp"
 #include "kovan_regs_p.hpp"
-#include <iostream> // FIXME: tmp
-#include <cstdio> // FIXME: tmp
+#include "stall_p.hpp"
+#include "warn.hpp"
 #include <cstring>
 #include "nyi.h"
 
@@ -98,14 +98,20 @@ void Private::Motor::clearBemf(unsigned char port)
 {
 	port = fixPort(port);
 	if(port > 3) return;
-	Private::Kovan::instance()->autoUpdate();
-	const Private::State &s = Private::Kovan::instance()->currentState();
+	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
+	kovan->autoUpdate();
+	const Private::State &s = kovan->currentState();
 	m_cleared[port] = (((int)s.t[bemfHighRegisters[port]]) << 16 | s.t[bemfLowRegisters[port]]);
+	kovan->unlock();
 }
 
-void Private::Motor::setControlMode(port_t port, Private::Motor::ControlMode controlMode)
+void Private::Motor::setControlMode(port_t port, Private::Motor::ControlMode controlMode, bool autoFlush)
 {
+	if(controlMode != Inactive) StallMonitor::instance()->watch(port);
+	
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	kovan->autoUpdate();
 	
 	port = fixPort(port);
@@ -117,20 +123,20 @@ void Private::Motor::setControlMode(port_t port, Private::Motor::ControlMode con
 	// Add new drive code
 	modes |= ((int)(controlMode)) << offset;
 	
-	kovan->enqueueCommand(createWriteCommand(PID_MODES, modes));
+	kovan->enqueueCommand(createWriteCommand(PID_MODES, modes), autoFlush);
+	kovan->unlock();
 }
 
 Private::Motor::ControlMode Private::Motor::controlMode(port_t port) const
 {
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	kovan->autoUpdate();
 	
 	port = fixPort(port);
 	const unsigned short offset = (3 - port) << 1;
-	unsigned short &modes = kovan->currentState().t[PID_MODES];
-	
-	// Clear old drive code
-	modes &= ~(0x3 << offset);
+	const unsigned short modes = kovan->currentState().t[PID_MODES];
+	kovan->unlock();
 	
 	return (Private::Motor::ControlMode)((modes >> offset) & 0x3);
 }
@@ -138,23 +144,30 @@ Private::Motor::ControlMode Private::Motor::controlMode(port_t port) const
 bool Private::Motor::isPidActive(port_t port) const
 {
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	kovan->autoUpdate();
-	return (kovan->currentState().t[PID_STATUS] >> (3 - fixPort(port))) & 0x1;
+	const unsigned short status = kovan->currentState().t[PID_STATUS];
+	kovan->unlock();
+	return (status >> (3 - fixPort(port))) & 0x1;
 }
 
-void Private::Motor::setPidVelocity(port_t port, const int &ticks)
+void Private::Motor::setPidVelocity(port_t port, const int &ticks, bool autoFlush)
 {
 	Private::Kovan *kovan = Private::Kovan::instance();
 	port = fixPort(port);
 	kovan->enqueueCommand(createWriteCommand(goalSpeedLowRegisters[port], ticks & 0x0000FFFF), false);
-	kovan->enqueueCommand(createWriteCommand(goalSpeedHighRegisters[port], (ticks & 0xFFFF0000) >> 16));
+	kovan->enqueueCommand(createWriteCommand(goalSpeedHighRegisters[port], (ticks & 0xFFFF0000) >> 16), autoFlush);
 }
 
 int Private::Motor::pidVelocity(port_t port) const
 {
-	const State &state = Private::Kovan::instance()->currentState();
+	Private::Kovan *kovan = Private::Kovan::instance();
 	port = fixPort(port);
-	return state.t[goalSpeedHighRegisters[port]] << 16 || state.t[goalSpeedLowRegisters[port]];
+	kovan->lock();
+	const State &state = kovan->currentState();
+	const int ret = state.t[goalSpeedHighRegisters[port]] << 16 || state.t[goalSpeedLowRegisters[port]];
+	kovan->unlock();
+	return ret;
 }
 
 void Private::Motor::setPidGoalPos(port_t port, int pos)
@@ -168,44 +181,74 @@ void Private::Motor::setPidGoalPos(port_t port, int pos)
 
 int Private::Motor::pidGoalPos(port_t port) const
 {
-	Private::Kovan::instance()->autoUpdate();
+	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
+	kovan->autoUpdate();
 	const uint64_t off = m_cleared[port];
 	port = fixPort(port);
-	const State &state = Private::Kovan::instance()->currentState();
-	return (state.t[goalPosHighRegisters[port]] << 16 || state.t[goalPosLowRegisters[port]]) + off;
+	const State &state = kovan->currentState();
+	const int ret = (state.t[goalPosHighRegisters[port]] << 16 || state.t[goalPosLowRegisters[port]]) + off;
+	kovan->unlock();
+	return ret;
 }
 
 void Private::Motor::pidGains(port_t port, short &p, short &i, short &d, short &pd, short &id, short &dd)
 {
-	Private::Kovan::instance()->autoUpdate();
 	port = fixPort(port);
 	if(port > 3) return;
-	const State &state = Private::Kovan::instance()->currentState();
+	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
+	kovan->autoUpdate();
+	const State &state = kovan->currentState();
 	p = state.t[PID_PN_0 + port];
 	i = state.t[PID_IN_0 + port];
 	d = state.t[PID_DN_0 + port];
 	pd = state.t[PID_PD_0 + port];
 	id = state.t[PID_ID_0 + port];
 	dd = state.t[PID_DD_0 + port];
+	kovan->unlock();
 }
 
 void Private::Motor::setPwm(port_t port, const unsigned char &speed)
 {
-	port = fixPort(port);
 	setControlMode(port, Private::Motor::Inactive);
+	port = fixPort(port);
+	if(port > 3) return;
 	Private::Kovan *kovan = Private::Kovan::instance();
-	const unsigned int adjustedSpeed = speed > 100 ? 100 : speed; 
-	kovan->enqueueCommand(createWriteCommand(motorRegisters[port], adjustedSpeed * 2600 / 100));
+	kovan->lock();
+	m_pwm[port] = speed > 100 ? 100 : speed;
+	kovan->enqueueCommand(createWriteCommand(motorRegisters[port], scaledPwm(port)));
+	kovan->unlock();
 }
 
-void Private::Motor::setPwmDirection(port_t port, const Motor::Direction &dir)
+void Private::Motor::applyCompensation(const double factor)
+{
+	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
+	m_factor = factor;
+	
+	const unsigned short dcs = kovan->currentState().t[MOTOR_DRIVE_CODE_T];
+	bool changed = false;
+	for(port_t hw = 0; hw < 4; ++hw) {
+		const unsigned direction = (dcs >> ((3 - hw) << 1)) & 0x3;
+		if(!m_pwm[hw] || (direction != Forward && direction != Reverse)) continue;
+		kovan->enqueueCommand(createWriteCommand(motorRegisters[hw], scaledPwm(hw)), false);
+		changed = true;
+	}
+	if(changed) kovan->autoUpdate();
+	kovan->unlock();
+}
+
+void Private::Motor::setPwmDirection(port_t port, const Motor::Direction &dir, bool autoFlush)
 {
 	// FIXME: This assumes that our current state is the latest.
 	// If somebody has altered the motor drive codes in the mean time,
 	// this will undo their work.
 	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
 	
-	setControlMode(port, Private::Motor::Inactive);
+	setControlMode(port, Private::Motor::Inactive, false);
+	if(dir == Forward || dir == Reverse) StallMonitor::instance()->watch(port);
 	port = fixPort(port);
 	const unsigned short offset = (3 - port) << 1;
 	unsigned short &dcs = kovan->currentState().t[MOTOR_DRIVE_CODE_T];
@@ -216,32 +259,39 @@ void Private::Motor::setPwmDirection(port_t port, const Motor::Direction &dir)
 	// Add new drive code
 	dcs |= dir << offset;
 	
-#ifdef LIBKOVAN_DEBUG
-	std::cout << "PWM Directions: " << std::hex << dcs << std::endl;
-#endif
+	DEBUG_LOG("PWM Directions: %x", dcs);
 	
-	kovan->enqueueCommand(createWriteCommand(MOTOR_DRIVE_CODE_T, dcs));
+	kovan->enqueueCommand(createWriteCommand(MOTOR_DRIVE_CODE_T, dcs), autoFlush);
+	kovan->unlock();
 }
 
 unsigned char Private::Motor::pwm(port_t port)
 {
-	Private::Kovan::instance()->autoUpdate();
-	return Private::Kovan::instance()->currentState().t[motorRegisters[fixPort(port)]];
+	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
+	kovan->autoUpdate();
+	const unsigned short ret = kovan->currentState().t[motorRegisters[fixPort(port)]];
+	kovan->unlock();
+	return ret;
 }
 
-void Private::Motor::stop(port_t port)
+void Private::Motor::stop(port_t port, bool autoFlush)
 {
-	setControlMode(port, Private::Motor::Inactive);
-	setPwmDirection(port, PassiveStop);
+	setControlMode(port, Private::Motor::Inactive, false);
+	setPwmDirection(port, PassiveStop, autoFlush);
 }
 
-int Private::Motor::backEMF(port_t port)
+int Private::Motor::backEMF(port_t port, bool update)
 {
-	Private::Kovan::instance()->autoUpdate();
 	port = fixPort(port);
 	if(port > 3) return 0xFFFF;
-	const Private::State &s = Private::Kovan::instance()->currentState();
-	return (((int)s.t[bemfHighRegisters[port]]) << 16 | s.t[bemfLowRegisters[port]]) - m_cleared[port];
+	Private::Kovan *kovan = Private::Kovan::instance();
+	kovan->lock();
+	if(update) kovan->autoUpdate();
+	const Private::State &s = kovan->currentState();
+	const int ret = (((int)s.t[bemfHighRegisters[port]]) << 16 | s.t[bemfLowRegisters[port]]) - m_cleared[port];
+	kovan->unlock();
+	return ret;
 }
 
 Private::Motor *Private::Motor::instance()
@@ -251,8 +301,16 @@ Private::Motor *Private::Motor::instance()
 }
 
 Private::Motor::Motor()
+	: m_factor(1.0)
+{
+	memset(m_cleared, 0, sizeof(m_cleared));
+	memset(m_pwm, 0, sizeof(m_pwm));
+}
+
+unsigned short Private::Motor::scaledPwm(const port_t hw) const
 {
-	memset(m_cleared, 0, sizeof(uint32_t) * 4);
+	const double duty = m_pwm[hw] * 2600 / 100 * m_factor;
+	return duty > 2600.0 ? 2600 : (unsigned short)duty;
 }
 
 port_t Private::Motor::fixPort(port_t port) const
@@ -51,12 +51,13 @@ namespace Private
 		
 		void clearBemf(unsigned char port);
 		
-		void setControlMode(port_t port, Motor::ControlMode mode);
+		// Setters taking autoFlush queue their writes like enqueueCommand()
+		void setControlMode(port_t port, Motor::ControlMode mode, bool autoFlush = true);
 		Motor::ControlMode controlMode(port_t port) const;
 		
 		bool isPidActive(port_t port) const;
 		
-		void setPidVelocity(port_t port, const int &ticks);
+		void setPidVelocity(port_t port, const int &ticks, bool autoFlush = true);
 		int pidVelocity(port_t port) const;
 		
 		void setPidGoalPos(port_t port, int pos);
@@ -67,24 +68,36 @@ namespace Private
 		
 		void pidGains(port_t port, short &p, short &i, short &d, short &pd, short &id, short &dd);
 		
+		// speed is a percentage. It is scaled by the battery compensation
+		// factor before being written.
 		void setPwm(const port_t port, const unsigned char &speed);
-		void setPwmDirection(port_t port, const Motor::Direction &dir);
+		void setPwmDirection(port_t port, const Motor::Direction &dir, bool autoFlush = true);
 		
 		unsigned char pwm(port_t port);
 		Motor::Direction pwmDirection(port_t port) const;
 		
-		void stop(port_t port);
+		void stop(port_t port, bool autoFlush = true);
 		
-		int backEMF(port_t port);
+		// update = false reads the state as it is, without a round trip
+		int backEMF(port_t port, bool update = true);
+		
+		// Rewrites the PWM of every driven motor with a new battery factor,
+		// in one packet
+		void applyCompensation(const double factor);
+		
+		// Maps a user port to the hardware's port numbering
+		port_t fixPort(port_t port) const;
 		
 		static Motor *instance();
 		
 	private:
 		Motor();
 		
-		port_t fixPort(port_t port) const;
+		unsigned short scaledPwm(const port_t hw) const;
 		
 		int64_t m_cleared[4];
+		unsigned char m_pwm[4];
+		double m_factor;
 	};
 }
 
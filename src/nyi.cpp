@@ -1,8 +1,9 @@
 #include "nyi.h"
 
-#include <iostream>
+#include "kovan/log.hpp"
 
 void nyi(const char *name)
 {
-	std::cout << "Warning: " << name << " not yet implemented." << std::endl;
-}
\ No newline at end of file
+	// name is always a literal, so it can be the origin of the message
+	Log::write(Log::Warning, name, "not yet implemented");
+}
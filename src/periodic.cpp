@@ -0,0 +1,301 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/periodic.hpp"
+
+#ifndef WIN32
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#else
+#error Windows not yet supported.
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "time_p.hpp"
+#include "warn.hpp"
+
+static __thread PeriodicExecutor *s_currentExecutor = 0;
+
+static const unsigned long long s_bucketLimits[PERIODIC_HISTOGRAM_BUCKETS - 1] = {
+	10000ULL, 50000ULL, 100000ULL, 500000ULL,
+	1000000ULL, 5000000ULL, 10000000ULL
+};
+
+PeriodicStats::PeriodicStats()
+	: runs(0),
+	overruns(0),
+	maxLatency(0),
+	totalLatency(0)
+{
+	memset(histogram, 0, sizeof(histogram));
+}
+
+double PeriodicStats::meanLatency() const
+{
+	return runs ? (double)totalLatency / runs : 0.0;
+}
+
+unsigned long long PeriodicStats::bucketLimit(const unsigned i)
+{
+	if(i >= PERIODIC_HISTOGRAM_BUCKETS - 1) return ~0ULL;
+	return s_bucketLimits[i];
+}
+
+PeriodicTask::PeriodicTask()
+	: m_executor(0),
+	m_period(0),
+	m_deadline(0),
+	m_removed(false),
+	m_dispose(false)
+{
+}
+
+PeriodicTask::~PeriodicTask()
+{
+	// Too late to be safe, since run() may already have been called on a
+	// half-destroyed task. Subclasses are expected to remove themselves.
+	if(m_executor) {
+		WARN("PeriodicTask destroyed while scheduled");
+		m_executor->remove(this);
+	}
+}
+
+unsigned long PeriodicTask::period() const
+{
+	return m_period / 1000ULL;
+}
+
+PeriodicStats PeriodicTask::stats() const
+{
+	PeriodicExecutor *const executor = m_executor;
+	if(!executor) return m_stats;
+	executor->m_mutex.lock();
+	const PeriodicStats ret = m_stats;
+	executor->m_mutex.unlock();
+	return ret;
+}
+
+void PeriodicTask::resetStats()
+{
+	PeriodicExecutor *const executor = m_executor;
+	if(executor) executor->m_mutex.lock();
+	m_stats = PeriodicStats();
+	if(executor) executor->m_mutex.unlock();
+}
+
+PeriodicExecutor::PeriodicExecutor()
+	: m_current(0),
+	m_started(false),
+	m_stop(false),
+	m_timer(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)),
+	m_event(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+	if(m_timer < 0) PWARN("timerfd_create");
+	if(m_event < 0) PWARN("eventfd");
+}
+
+PeriodicExecutor::~PeriodicExecutor()
+{
+	stop();
+	m_mutex.lock();
+	for(std::vector<PeriodicTask *>::iterator it = m_tasks.begin(); it != m_tasks.end(); ++it) {
+		(*it)->m_executor = 0;
+		(*it)->m_period = 0;
+	}
+	m_tasks.clear();
+	m_mutex.unlock();
+	if(m_timer >= 0) ::close(m_timer);
+	if(m_event >= 0) ::close(m_event);
+}
+
+bool PeriodicExecutor::add(PeriodicTask *const task, const unsigned long periodUs)
+{
+	if(!task || !periodUs) return false;
+	
+	m_mutex.lock();
+	if(task->m_executor) {
+		m_mutex.unlock();
+		return false;
+	}
+	
+	task->m_executor = this;
+	task->m_period = periodUs * 1000ULL;
+	task->m_deadline = Private::Time::monotonic() + task->m_period;
+	task->m_removed = false;
+	m_tasks.push_back(task);
+	
+	const bool needsStart = !m_started;
+	m_started = true;
+	m_stop = false;
+	m_mutex.unlock();
+	
+	if(needsStart) start();
+	else wake();
+	return true;
+}
+
+void PeriodicExecutor::remove(PeriodicTask *const task)
+{
+	m_mutex.lock();
+	if(task->m_executor != this) {
+		m_mutex.unlock();
+		return;
+	}
+	
+	std::vector<PeriodicTask *>::iterator it = std::find(m_tasks.begin(), m_tasks.end(), task);
+	if(it != m_tasks.end()) m_tasks.erase(it);
+	task->m_removed = true;
+	
+	// Removing ourselves from inside run() must not wait on ourselves
+	if(s_currentExecutor != this) {
+		while(m_current == task) m_idle.wait(m_mutex);
+	}
+	
+	task->m_executor = 0;
+	task->m_period = 0;
+	m_mutex.unlock();
+	wake();
+}
+
+void PeriodicExecutor::dispose(PeriodicTask *const task)
+{
+	if(!task) return;
+	remove(task);
+	
+	m_mutex.lock();
+	const bool running = s_currentExecutor == this && m_current == task;
+	if(running) task->m_dispose = true;
+	m_mutex.unlock();
+	
+	if(!running) delete task;
+}
+
+void PeriodicExecutor::stop()
+{
+	m_mutex.lock();
+	const bool running = m_started;
+	m_stop = true;
+	m_started = false;
+	m_mutex.unlock();
+	if(!running) return;
+	
+	wake();
+	join();
+}
+
+void PeriodicExecutor::run()
+{
+	s_currentExecutor = this;
+	
+	pollfd fds[2];
+	fds[0].fd = m_timer;
+	fds[0].events = POLLIN;
+	fds[1].fd = m_event;
+	fds[1].events = POLLIN;
+	
+	m_mutex.lock();
+	while(!m_stop) {
+		PeriodicTask *next = 0;
+		for(std::vector<PeriodicTask *>::const_iterator it = m_tasks.begin(); it != m_tasks.end(); ++it) {
+			if(!next || (*it)->m_deadline < next->m_deadline) next = *it;
+		}
+		
+		const unsigned long long now = Private::Time::monotonic();
+		if(!next || next->m_deadline > now) {
+			// Arm the timer for the earliest absolute deadline (or disarm it) and sleep
+			// until it fires or add()/remove()/stop() signals the eventfd.
+			itimerspec spec;
+			memset(&spec, 0, sizeof(spec));
+			if(next) {
+				spec.it_value.tv_sec = next->m_deadline / 1000000000ULL;
+				spec.it_value.tv_nsec = next->m_deadline % 1000000000ULL;
+			}
+			timerfd_settime(m_timer, TFD_TIMER_ABSTIME, &spec, 0);
+			m_mutex.unlock();
+			
+			if(poll(fds, 2, -1) < 0 && errno != EINTR) PWARN("poll");
+			unsigned long long count;
+			if(fds[0].revents & POLLIN) (void)!::read(m_timer, &count, sizeof(count));
+			if(fds[1].revents & POLLIN) (void)!::read(m_event, &count, sizeof(count));
+			
+			m_mutex.lock();
+			continue;
+		}
+		
+		m_current = next;
+		m_mutex.unlock();
+		next->run();
+		const unsigned long long finished = Private::Time::monotonic();
+		m_mutex.lock();
+		
+		m_current = 0;
+		if(!next->m_removed) finish(next, now, finished);
+		m_idle.broadcast();
+		
+		// The task disposed of itself from inside run()
+		if(next->m_dispose) {
+			m_mutex.unlock();
+			delete next;
+			m_mutex.lock();
+		}
+	}
+	m_mutex.unlock();
+}
+
+PeriodicExecutor *PeriodicExecutor::instance()
+{
+	static PeriodicExecutor s_instance;
+	return &s_instance;
+}
+
+void PeriodicExecutor::wake()
+{
+	const unsigned long long one = 1;
+	if(::write(m_event, &one, sizeof(one)) < 0 && errno != EAGAIN) PWARN("eventfd write");
+}
+
+void PeriodicExecutor::finish(PeriodicTask *const task, const unsigned long long started,
+	const unsigned long long finished)
+{
+	PeriodicStats &stats = task->m_stats;
+	const unsigned long long latency = started - task->m_deadline;
+	
+	++stats.runs;
+	stats.totalLatency += latency;
+	if(latency > stats.maxLatency) stats.maxLatency = latency;
+	
+	unsigned bucket = 0;
+	while(bucket < PERIODIC_HISTOGRAM_BUCKETS - 1 && latency >= s_bucketLimits[bucket]) ++bucket;
+	++stats.histogram[bucket];
+	
+	// Deadlines advance by whole periods so lateness never turns into drift.
+	// Any deadline that has already passed is skipped and counted as an overrun.
+	task->m_deadline += task->m_period;
+	if(task->m_deadline <= finished) {
+		const unsigned long long missed = (finished - task->m_deadline) / task->m_period + 1;
+		stats.overruns += missed;
+		task->m_deadline += missed * task->m_period;
+	}
+}
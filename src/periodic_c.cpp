@@ -0,0 +1,131 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/periodic.h"
+#include "kovan/periodic.hpp"
+#include "kovan/thread.h"
+
+#include <cstdio>
+
+class FunctionPeriodicTask : public PeriodicTask
+{
+public:
+	FunctionPeriodicTask(periodic_function func)
+		: m_func(func)
+	{
+	}
+	
+	~FunctionPeriodicTask()
+	{
+		PeriodicExecutor::instance()->remove(this);
+	}
+	
+	virtual void run()
+	{
+		(*m_func)();
+	}
+	
+private:
+	periodic_function m_func;
+};
+
+FunctionPeriodicTask *periodicObject(void *data)
+{
+	return reinterpret_cast<FunctionPeriodicTask *>(data);
+}
+
+periodic periodicStruct(FunctionPeriodicTask *task)
+{
+	periodic ret;
+	ret.data = reinterpret_cast<void *>(task);
+	return ret;
+}
+
+periodic run_every_us(unsigned long usecs, periodic_function func)
+{
+	FunctionPeriodicTask *const task = new FunctionPeriodicTask(func);
+	if(!PeriodicExecutor::instance()->add(task, usecs)) {
+		delete task;
+		return periodicStruct(0);
+	}
+	return periodicStruct(task);
+}
+
+periodic run_every(unsigned long msecs, periodic_function func)
+{
+	return run_every_us(msecs * 1000UL, func);
+}
+
+void periodic_stop(periodic p)
+{
+	// periodic_stop may be called from inside the function itself
+	PeriodicExecutor::instance()->dispose(periodicObject(p.data));
+}
+
+unsigned long periodic_runs(periodic p)
+{
+	if(!p.data) return 0;
+	return periodicObject(p.data)->stats().runs;
+}
+
+unsigned long periodic_overruns(periodic p)
+{
+	if(!p.data) return 0;
+	return periodicObject(p.data)->stats().overruns;
+}
+
+double periodic_max_latency(periodic p)
+{
+	if(!p.data) return 0.0;
+	return periodicObject(p.data)->stats().maxLatency / 1000000.0;
+}
+
+double periodic_mean_latency(periodic p)
+{
+	if(!p.data) return 0.0;
+	return periodicObject(p.data)->stats().meanLatency() / 1000000.0;
+}
+
+void periodic_print_stats(periodic p)
+{
+	if(!p.data) return;
+	FunctionPeriodicTask *const task = periodicObject(p.data);
+	const PeriodicStats stats = task->stats();
+	
+	printf("period %lu us: %lu runs, %lu overruns, latency mean %.3f ms max %.3f ms\n",
+		task->period(), stats.runs, stats.overruns,
+		stats.meanLatency() / 1000000.0, stats.maxLatency / 1000000.0);
+	
+	unsigned long long lower = 0;
+	for(unsigned i = 0; i < PERIODIC_HISTOGRAM_BUCKETS; ++i) {
+		const unsigned long long upper = PeriodicStats::bucketLimit(i);
+		if(i < PERIODIC_HISTOGRAM_BUCKETS - 1) printf("  %7llu - %7llu us: %lu\n", lower / 1000ULL, upper / 1000ULL, stats.histogram[i]);
+		else printf("  %7llu us and up: %lu\n", lower / 1000ULL, stats.histogram[i]);
+		lower = upper;
+	}
+}
+
+int periodic_set_priority(int policy, int priority)
+{
+	Thread::Policy p = Thread::DefaultPolicy;
+	if(policy == THREAD_POLICY_FIFO) p = Thread::FifoPolicy;
+	else if(policy == THREAD_POLICY_RR) p = Thread::RoundRobinPolicy;
+	return PeriodicExecutor::instance()->setPriority(p, priority) ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+#include "remote_kovan_module_p.hpp"
+#include "bridge_p.hpp"
+#include "kovan/metrics.hpp"
+#include "warn.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+using namespace Private;
+
+static Counter s_bytesSent("remote.bytes_sent");
+static Counter s_bytesReceived("remote.bytes_received");
+static Counter s_fullStates("remote.full_states");
+static Counter s_timeouts("remote.timeouts");
+
+RemoteKovanModule::RemoteKovanModule(const uint64_t& moduleAddress, const uint16_t& modulePort)
+	: KovanModule(moduleAddress, modulePort),
+	m_seq(0),
+	m_stateId(0)
+{
+	memset(&m_state, 0, sizeof(State));
+}
+
+bool RemoteKovanModule::init()
+{
+	if(!KovanModule::init()) return false;
+	
+	// Unlike the local daemon, the bridge can disappear, so don't wait forever
+#ifndef WIN32
+	timeval timeout;
+	timeout.tv_sec = 0;
+	timeout.tv_usec = REMOTE_TIMEOUT * 1000;
+#else
+	DWORD timeout = REMOTE_TIMEOUT;
+#endif
+	setsockopt(m_sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+	return true;
+}
+
+bool RemoteKovanModule::send(const CommandVector& commands)
+{
+	if(commands.size() > BRIDGE_MAX_COMMANDS) {
+		WARN("Can't send %lu commands at once", (unsigned long)commands.size());
+		return false;
+	}
+	
+	const size_t size = bridgeRequestSize(commands.size());
+	BridgeRequest *const request = reinterpret_cast<BridgeRequest *>(malloc(size));
+	if(!request) return false;
+	
+	request->seq = ++m_seq;
+	request->ackedState = m_stateId;
+	request->num = commands.size();
+	request->reserved = 0;
+	if(!commands.empty()) memcpy(request->commands, &commands[0], commands.size() * sizeof(Command));
+	
+	ssize_t ret = 0;
+	while((ret = sendto(m_sock, reinterpret_cast<const char *>(request), size, 0,
+		(sockaddr *)&m_out, sizeof(m_out))) < 0 && errno == EINTR);
+	free(request);
+	
+	if(ret != (ssize_t)size) {
+		PWARN("sendto failed");
+		return false;
+	}
+	s_bytesSent.increment(size);
+	return true;
+}
+
+bool RemoteKovanModule::recv(State& state)
+{
+	BridgeReply reply;
+	for(;;) {
+		const ssize_t ret = ::recv(m_sock, reinterpret_cast<char *>(&reply), sizeof(reply), 0);
+		if(ret < 0) {
+			if(errno == EINTR) continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				s_timeouts.increment();
+				WARN("No reply from the bridge within %d ms", REMOTE_TIMEOUT);
+			} else PWARN("recv failed");
+			return false;
+		}
+		s_bytesReceived.increment(ret);
+		
+		if((size_t)ret < bridgeReplySize(0) || (size_t)ret != bridgeReplySize(reply.length)) {
+			WARN("Malformed reply from the bridge");
+			continue;
+		}
+		
+		// Replies to requests that already timed out
+		if(reply.seq == m_seq) break;
+	}
+	
+	State base;
+	if(!reply.base) {
+		memset(&base, 0, sizeof(State));
+		s_fullStates.increment();
+	} else if(reply.base == m_stateId) memcpy(&base, &m_state, sizeof(State));
+	else {
+		WARN("Bridge sent a delta against unknown state %u", reply.base);
+		return false;
+	}
+	
+	if(!StateDelta::decode(base, reply.delta, reply.length, m_state)) {
+		WARN("Malformed state delta from the bridge");
+		return false;
+	}
+	m_stateId = reply.state;
+	memcpy(&state, &m_state, sizeof(State));
+	return true;
+}
+
+bool RemoteKovanModule::supportsWindow() const
+{
+	return false;
+}
+
+bool RemoteKovanModule::subscribe(const unsigned short, const unsigned short count,
+	const unsigned short, const bool, const int)
+{
+	if(!count) return true;
+	WARN("kovan-bridge can't push state");
+	return false;
+}
+
+RemoteKovanModule *RemoteKovanModule::create(const char *const host)
+{
+	uint64_t address = 0;
+	uint16_t port = 0;
+	if(!resolve(host, BRIDGE_PORT, address, port)) return 0;
+	return new RemoteKovanModule(address, port);
+}
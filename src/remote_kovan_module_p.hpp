@@ -0,0 +1,42 @@
+#ifndef _REMOTE_KOVAN_MODULE_P_HPP_
+#define _REMOTE_KOVAN_MODULE_P_HPP_
+
+#include "kovan_module_p.hpp"
+
+#define REMOTE_TIMEOUT 200 // ms
+
+namespace Private
+{
+	// Talks to kovan-bridge on another machine instead of the local Kovan
+	// daemon. Writes go out in one datagram per flush and the state comes
+	// back as a delta against the last state this module decoded.
+	class RemoteKovanModule : public KovanModule
+	{
+	public:
+		RemoteKovanModule(const uint64_t& moduleAddress, const uint16_t& modulePort);
+		
+		virtual bool init();
+		
+		using KovanModule::send;
+		virtual bool send(const CommandVector& commands);
+		virtual bool recv(State& state);
+		
+		// Deltas are taken against the last decoded state, so only one
+		// request can be in flight
+		virtual bool supportsWindow() const;
+		
+		// kovan-bridge only answers requests
+		virtual bool subscribe(const unsigned short first, const unsigned short count,
+			const unsigned short interval, const bool changesOnly, const int timeout);
+		
+		// host is an IPv4 address or name, optionally followed by ":port"
+		static RemoteKovanModule *create(const char *const host);
+		
+	private:
+		uint32_t m_seq;
+		uint32_t m_stateId;
+		State m_state;
+	};
+}
+
+#endif
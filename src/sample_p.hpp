@@ -0,0 +1,19 @@
+#ifndef _SAMPLE_P_HPP_
+#define _SAMPLE_P_HPP_
+
+#include "kovan/sensor.hpp"
+
+namespace Private
+{
+	// Fills in the C form of a sample. Returns 1 for the C functions to pass on.
+	template<typename T>
+	int copySample(const Sample<T> &from, sensor_sample *const to)
+	{
+		to->value = from.value;
+		to->timestamp = from.timestamp;
+		to->seq = from.seq;
+		return 1;
+	}
+}
+
+#endif
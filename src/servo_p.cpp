@@ -50,18 +50,21 @@ void Private::Servo::setEnabled(port_t port, const bool &enabled)
 {
 	port = fixPort(port);
 	if(port > 3) return;
-	unsigned short &allStop = Private::Kovan::instance()->currentState().t[MOTOR_ALL_STOP];
+	Private::Kovan *const kovan = Private::Kovan::instance();
+	kovan->lock();
+	unsigned short &allStop = kovan->currentState().t[MOTOR_ALL_STOP];
 	const unsigned short val = 1 << (port + 1);
 	if(enabled) allStop |= val;
 	else allStop &= ~val;
-	Private::Kovan::instance()->enqueueCommand(createWriteCommand(MOTOR_ALL_STOP, allStop));
+	kovan->enqueueCommand(createWriteCommand(MOTOR_ALL_STOP, allStop));
+	kovan->unlock();
 }
 
 bool Private::Servo::isEnabled(port_t port)
 {
 	port = fixPort(port);
 	if(port > 3) return false;
-	unsigned short &allStop = Private::Kovan::instance()->currentState().t[MOTOR_ALL_STOP];
+	const unsigned short allStop = Private::Kovan::instance()->registerValue(MOTOR_ALL_STOP);
 	const unsigned short val = 1 << (port + 1);
 	return allStop & val;
 }
@@ -80,7 +83,7 @@ unsigned short Private::Servo::position(port_t port) const
 {
 	port = fixPort(port);
 	if(port > 3) return 0xFFFF;
-	const unsigned int val = Private::Kovan::instance()->currentState().t[servoRegisters[port]];
+	const unsigned int val = Private::Kovan::instance()->registerValue(servoRegisters[port]);
 	return 1 + ((2047 * (val - 6500)) / 26000);
 }
 
@@ -5,8 +5,10 @@
 #include <netinet/in.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
 #else
 #error Windows not yet supported.
 #endif
@@ -15,6 +17,12 @@
 #include <cstdio>
 #include <cstring>
 
+#include "time_p.hpp"
+#include "warn.hpp"
+
+// Room for one SO_TIMESTAMPNS control message per datagram
+#define SOCKET_CONTROL_LENGTH CMSG_SPACE(sizeof(timespec))
+
 Address::Address(const char *const host, const unsigned short port)
 	: m_valid(true)
 {
@@ -45,7 +53,7 @@ bool Address::isValid() const
 bool Address::setHost(const char *const host)
 {
 	if(inet_aton(host, &m_addr.sin_addr) == 0) {
-		perror("inet_aton");
+		WARN("%s is not a valid address", host);
 		return false;
 	}
 	
@@ -76,6 +84,141 @@ socklen_t Address::addrLength() const
 	return sizeof(m_addr);
 }
 
+DatagramBatch::DatagramBatch(const unsigned capacity, const size_t datagramSize)
+	: m_capacity(capacity),
+	m_datagramSize(datagramSize),
+	m_size(0),
+	m_headers(new mmsghdr[capacity]),
+	m_iovecs(new iovec[capacity]),
+	m_addresses(new sockaddr_in[capacity]),
+	m_data(new unsigned char[capacity * datagramSize]),
+	m_control(new unsigned char[capacity * SOCKET_CONTROL_LENGTH]),
+	m_timestamps(new unsigned long long[capacity])
+{
+	memset(m_headers, 0, capacity * sizeof(mmsghdr));
+	memset(m_addresses, 0, capacity * sizeof(sockaddr_in));
+	memset(m_timestamps, 0, capacity * sizeof(unsigned long long));
+	for(unsigned i = 0; i < capacity; ++i) {
+		m_iovecs[i].iov_base = m_data + i * datagramSize;
+		m_iovecs[i].iov_len = datagramSize;
+		m_headers[i].msg_hdr.msg_iov = &m_iovecs[i];
+		m_headers[i].msg_hdr.msg_iovlen = 1;
+		m_headers[i].msg_hdr.msg_name = &m_addresses[i];
+	}
+}
+
+DatagramBatch::~DatagramBatch()
+{
+	delete[] m_headers;
+	delete[] m_iovecs;
+	delete[] m_addresses;
+	delete[] m_data;
+	delete[] m_control;
+	delete[] m_timestamps;
+}
+
+unsigned DatagramBatch::capacity() const
+{
+	return m_capacity;
+}
+
+size_t DatagramBatch::datagramSize() const
+{
+	return m_datagramSize;
+}
+
+unsigned DatagramBatch::size() const
+{
+	return m_size;
+}
+
+void DatagramBatch::clear()
+{
+	m_size = 0;
+}
+
+bool DatagramBatch::append(const void *const data, const size_t length, const Address &dest)
+{
+	if(m_size >= m_capacity || length > m_datagramSize || !dest.isValid()) return false;
+	
+	memcpy(m_data + m_size * m_datagramSize, data, length);
+	memcpy(&m_addresses[m_size], dest.addr(), sizeof(sockaddr_in));
+	m_iovecs[m_size].iov_len = length;
+	
+	msghdr &header = m_headers[m_size].msg_hdr;
+	header.msg_namelen = sizeof(sockaddr_in);
+	header.msg_control = 0;
+	header.msg_controllen = 0;
+	header.msg_flags = 0;
+	m_timestamps[m_size] = 0;
+	++m_size;
+	return true;
+}
+
+unsigned char *DatagramBatch::data(const unsigned i)
+{
+	return m_data + i * m_datagramSize;
+}
+
+const unsigned char *DatagramBatch::data(const unsigned i) const
+{
+	return m_data + i * m_datagramSize;
+}
+
+size_t DatagramBatch::length(const unsigned i) const
+{
+	return i < m_size ? m_iovecs[i].iov_len : 0;
+}
+
+Address DatagramBatch::address(const unsigned i) const
+{
+	return i < m_size ? Address(m_addresses[i]) : Address();
+}
+
+unsigned long long DatagramBatch::timestamp(const unsigned i) const
+{
+	return i < m_size ? m_timestamps[i] : 0;
+}
+
+void DatagramBatch::prepareReceive()
+{
+	m_size = 0;
+	for(unsigned i = 0; i < m_capacity; ++i) {
+		m_iovecs[i].iov_len = m_datagramSize;
+		msghdr &header = m_headers[i].msg_hdr;
+		header.msg_namelen = sizeof(sockaddr_in);
+		header.msg_control = m_control + i * SOCKET_CONTROL_LENGTH;
+		header.msg_controllen = SOCKET_CONTROL_LENGTH;
+		header.msg_flags = 0;
+	}
+}
+
+void DatagramBatch::finishReceive(const unsigned count)
+{
+	m_size = count;
+	if(!count) return;
+	
+	// SO_TIMESTAMPNS reports CLOCK_REALTIME. Shift it onto the monotonic
+	// clock so it can be compared against Time::now().
+	timespec realtime;
+	clock_gettime(CLOCK_REALTIME, &realtime);
+	const long long offset = (long long)Private::Time::monotonic()
+		- ((long long)realtime.tv_sec * 1000000000LL + realtime.tv_nsec);
+	
+	for(unsigned i = 0; i < count; ++i) {
+		m_iovecs[i].iov_len = m_headers[i].msg_len;
+		m_timestamps[i] = 0;
+		
+		msghdr &header = m_headers[i].msg_hdr;
+		for(cmsghdr *c = CMSG_FIRSTHDR(&header); c; c = CMSG_NXTHDR(&header, c)) {
+			if(c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_TIMESTAMPNS) continue;
+			timespec stamp;
+			memcpy(&stamp, CMSG_DATA(c), sizeof(stamp));
+			m_timestamps[i] = (long long)stamp.tv_sec * 1000000000LL + stamp.tv_nsec + offset;
+		}
+	}
+}
+
 Socket::Socket()
 	: m_fd(-1)
 {
@@ -121,6 +264,14 @@ bool Socket::bind(const unsigned short port)
 	return ::bind(m_fd, (sockaddr *)&addr, sizeof(addr)) >= 0;
 }
 
+bool Socket::setTimestamping(const bool timestamping)
+{
+	if(m_fd < 0) return false;
+	
+	const int v = timestamping ? 1 : 0;
+	return setsockopt(m_fd, SOL_SOCKET, SO_TIMESTAMPNS, &v, sizeof(v)) >= 0;
+}
+
 socket_fd_t Socket::fd() const
 {
 	return m_fd;
@@ -142,7 +293,7 @@ ssize_t Socket::recv(void *const buffer, const size_t length, int flags)
 ssize_t Socket::recvfrom(void *const buffer, const size_t length, Address &address, int flags)
 {
 	sockaddr_in rawAddress;
-	socklen_t rawAddressLength;
+	socklen_t rawAddressLength = sizeof(rawAddress);
 	ssize_t ret = ::recvfrom(m_fd, buffer, length, flags, (sockaddr *)&rawAddress, &rawAddressLength);
 	address = Address(rawAddress);
 	return ret;
@@ -158,6 +309,28 @@ ssize_t Socket::sendto(const void *const buffer, const size_t length, const Addr
 	return ::sendto(m_fd, buffer, length, 0, dest.addr(), dest.addrLength());
 }
 
+int Socket::recvBatch(DatagramBatch &batch, int flags)
+{
+	batch.prepareReceive();
+	const int ret = ::recvmmsg(m_fd, batch.m_headers, batch.m_capacity, flags, 0);
+	batch.finishReceive(ret > 0 ? ret : 0);
+	return ret;
+}
+
+int Socket::sendBatch(DatagramBatch &batch, int flags)
+{
+	unsigned sent = 0;
+	while(sent < batch.m_size) {
+		const int ret = ::sendmmsg(m_fd, batch.m_headers + sent, batch.m_size - sent, flags);
+		if(ret < 0) {
+			if(errno == EINTR) continue;
+			return sent ? (int)sent : -1;
+		}
+		sent += ret;
+	}
+	return sent;
+}
+
 Socket Socket::udp()
 {
 	Socket ret;
@@ -0,0 +1,221 @@
+#include "stall_p.hpp"
+#include "kovan_p.hpp"
+#include "kovan_regs_p.hpp"
+#include "motors_p.hpp"
+#include "kovan/metrics.hpp"
+#include "time_p.hpp"
+#include "warn.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Private;
+
+static Counter s_stalls("motor.stalls");
+
+static const unsigned short bemfLowRegisters[4] = { BEMF_0_LOW, BEMF_1_LOW, BEMF_2_LOW, BEMF_3_LOW };
+static const unsigned short bemfHighRegisters[4] = { BEMF_0_HIGH, BEMF_1_HIGH, BEMF_2_HIGH, BEMF_3_HIGH };
+static const unsigned short goalSpeedLowRegisters[4] = { GOAL_SPEED_0_LOW, GOAL_SPEED_1_LOW, GOAL_SPEED_2_LOW, GOAL_SPEED_3_LOW };
+static const unsigned short goalSpeedHighRegisters[4] = { GOAL_SPEED_0_HIGH, GOAL_SPEED_1_HIGH, GOAL_SPEED_2_HIGH, GOAL_SPEED_3_HIGH };
+
+// The slowest back EMF velocity, in ticks per second, that hardware port
+// hw can have without stalling. 0 if it isn't supposed to be moving.
+static int minimumSpeed(const State &state, const port_t hw)
+{
+	const unsigned short offset = (3 - hw) << 1;
+	
+	if((state.t[PID_MODES] >> offset) & 0x3) {
+		if(!((state.t[PID_STATUS] >> (3 - hw)) & 0x1)) return 0;
+		const int goal = (int)(state.t[goalSpeedHighRegisters[hw]] << 16 | state.t[goalSpeedLowRegisters[hw]]);
+		if(!goal) return 0;
+		const int min = std::abs(goal) / STALL_PID_FRACTION;
+		return min > STALL_MIN_SPEED ? min : STALL_MIN_SPEED;
+	}
+	
+	const unsigned direction = (state.t[MOTOR_DRIVE_CODE_T] >> offset) & 0x3;
+	if(direction != Motor::Forward && direction != Motor::Reverse) return 0;
+	return state.t[MOTOR_PWM_0 + hw] >= STALL_MIN_PWM ? STALL_MIN_SPEED : 0;
+}
+
+// Ports that could be moving, judged by what was last written
+static bool anyCommanded(const State &state)
+{
+	const unsigned short drive = state.t[MOTOR_DRIVE_CODE_T];
+	const unsigned short pid = state.t[PID_MODES];
+	for(port_t hw = 0; hw < 4; ++hw) {
+		const unsigned short offset = (3 - hw) << 1;
+		if((pid >> offset) & 0x3) return true;
+		const unsigned direction = (drive >> offset) & 0x3;
+		if(direction == Motor::Forward || direction == Motor::Reverse) return true;
+	}
+	return false;
+}
+
+StallMonitor::~StallMonitor()
+{
+	PeriodicExecutor::instance()->remove(this);
+}
+
+void StallMonitor::watch(const port_t port)
+{
+	if(port > 3) return;
+	
+	m_mutex.lock();
+	if(m_ports[port].stalled) {
+		m_ports[port].stalled = false;
+		m_ports[port].slowSince = 0;
+		m_ports[port].sampled = 0;
+	}
+	const bool schedule = !m_scheduled;
+	m_scheduled = true;
+	m_mutex.unlock();
+	
+	if(schedule) PeriodicExecutor::instance()->add(this, STALL_PERIOD);
+}
+
+bool StallMonitor::stalled(const port_t port)
+{
+	if(port > 3) return false;
+	m_mutex.lock();
+	const bool ret = m_ports[port].stalled;
+	m_mutex.unlock();
+	return ret;
+}
+
+void StallMonitor::setStallTime(const port_t port, const unsigned msecs)
+{
+	if(port > 3) return;
+	m_mutex.lock();
+	m_ports[port].stallTime = msecs;
+	m_ports[port].slowSince = 0;
+	m_mutex.unlock();
+}
+
+unsigned StallMonitor::stallTime(const port_t port)
+{
+	if(port > 3) return 0;
+	m_mutex.lock();
+	const unsigned ret = m_ports[port].stallTime;
+	m_mutex.unlock();
+	return ret;
+}
+
+void StallMonitor::setStopOnStall(const bool stop)
+{
+	m_mutex.lock();
+	m_stopOnStall = stop;
+	m_mutex.unlock();
+}
+
+bool StallMonitor::stopOnStall()
+{
+	m_mutex.lock();
+	const bool ret = m_stopOnStall;
+	m_mutex.unlock();
+	return ret;
+}
+
+bool StallMonitor::waitForStall(const port_t port, const unsigned long msecs)
+{
+	if(port > 3) return false;
+	m_mutex.lock();
+	if(!m_ports[port].stalled) m_condition.wait(m_mutex, msecs);
+	const bool ret = m_ports[port].stalled;
+	m_mutex.unlock();
+	return ret;
+}
+
+void StallMonitor::run()
+{
+	Kovan *const kovan = Kovan::instance();
+	Motor *const motor = Motor::instance();
+	
+	kovan->lock();
+	if(!anyCommanded(kovan->currentState())) {
+		kovan->unlock();
+		m_mutex.lock();
+		for(port_t port = 0; port < 4; ++port) m_ports[port].sampled = 0;
+		m_mutex.unlock();
+		return;
+	}
+	
+	// Programs waiting on a motor poll the Kovan themselves, so a flush of
+	// our own is only needed when nobody else has for a while
+	if(Private::Time::monotonic() - kovan->stateTimestamp() >= STALL_REFRESH * 1000000ULL) {
+		kovan->autoUpdate();
+	}
+	
+	// The back EMF can't have moved without a new reply or push, which is
+	// the case on every tick while auto publishing is off. Such a tick says
+	// nothing about the motors, so it isn't counted as slow.
+	const unsigned long seq = kovan->stateSeq();
+	if(seq == m_stateSeq) {
+		kovan->unlock();
+		return;
+	}
+	m_stateSeq = seq;
+	const State state = kovan->currentState();
+	const unsigned long long now = kovan->stateTimestamp();
+	
+	bool stalledPorts[4] = { false, false, false, false };
+	m_mutex.lock();
+	for(port_t port = 0; port < 4; ++port) {
+		Port &p = m_ports[port];
+		const port_t hw = motor->fixPort(port);
+		const int position = (int)(state.t[bemfHighRegisters[hw]] << 16 | state.t[bemfLowRegisters[hw]]);
+		const int min = minimumSpeed(state, hw);
+		
+		if(!min || !p.stallTime || p.stalled || !p.sampled) {
+			p.slowSince = 0;
+			p.position = position;
+			p.sampled = now;
+			continue;
+		}
+		
+		const double speed = std::abs(position - p.position) * 1e9 / (now - p.sampled);
+		p.position = position;
+		p.sampled = now;
+		
+		if(speed >= min) {
+			p.slowSince = 0;
+			continue;
+		}
+		if(!p.slowSince) p.slowSince = now;
+		if(now - p.slowSince < p.stallTime * 1000000ULL) continue;
+		
+		p.stalled = true;
+		stalledPorts[port] = true;
+	}
+	const bool stop = m_stopOnStall;
+	m_mutex.unlock();
+	
+	bool any = false;
+	for(port_t port = 0; port < 4; ++port) {
+		if(!stalledPorts[port]) continue;
+		any = true;
+		s_stalls.increment();
+		WARN("Motor %d stalled", (int)port);
+		if(stop) motor->stop(port);
+	}
+	kovan->unlock();
+	
+	if(!any) return;
+	m_mutex.lock();
+	m_condition.broadcast();
+	m_mutex.unlock();
+}
+
+StallMonitor *StallMonitor::instance()
+{
+	static StallMonitor s_instance;
+	return &s_instance;
+}
+
+StallMonitor::StallMonitor()
+	: m_scheduled(false),
+	m_stopOnStall(true),
+	m_stateSeq(0)
+{
+	memset(m_ports, 0, sizeof(m_ports));
+	for(port_t port = 0; port < 4; ++port) m_ports[port].stallTime = STALL_DEFAULT_TIME;
+}
@@ -0,0 +1,69 @@
+#ifndef _STALL_P_HPP_
+#define _STALL_P_HPP_
+
+#include "kovan/periodic.hpp"
+#include "kovan/port.hpp"
+#include "kovan/thread.hpp"
+
+#define STALL_PERIOD 20000 // us
+#define STALL_REFRESH 100 // ms, how stale the state may get before the monitor flushes
+#define STALL_DEFAULT_TIME 500 // ms
+#define STALL_MIN_PWM 260 // 10% of full power
+#define STALL_MIN_SPEED 20 // ticks per second
+#define STALL_PID_FRACTION 10 // Stalled below 1/10 of the PID goal speed
+
+namespace Private
+{
+	// Compares each commanded motor's back EMF velocity with what it was told
+	// to do. A motor that stays below the threshold for the stall time is
+	// flagged, stopped if stopOnStall() is set, and anyone waiting on it is
+	// woken. Ports that aren't commanded cost nothing; the task only polls
+	// the Kovan while some motor is supposed to be moving, and then only
+	// when no other thread has refreshed the state recently.
+	class StallMonitor : public PeriodicTask
+	{
+	public:
+		~StallMonitor();
+		
+		// Called on every new motor command. Clears the port's stall flag and
+		// starts the monitor if needed.
+		void watch(const port_t port);
+		
+		bool stalled(const port_t port);
+		
+		// 0 disables stall detection on port
+		void setStallTime(const port_t port, const unsigned msecs);
+		unsigned stallTime(const port_t port);
+		
+		void setStopOnStall(const bool stop);
+		bool stopOnStall();
+		
+		// Returns true if port stalls, or already has, within msecs
+		bool waitForStall(const port_t port, const unsigned long msecs);
+		
+		virtual void run();
+		
+		static StallMonitor *instance();
+		
+	private:
+		StallMonitor();
+		
+		struct Port
+		{
+			int position;
+			unsigned long long sampled;
+			unsigned long long slowSince;
+			unsigned stallTime;
+			bool stalled;
+		};
+		
+		Mutex m_mutex;
+		ConditionVariable m_condition;
+		bool m_scheduled;
+		bool m_stopOnStall;
+		unsigned long m_stateSeq;
+		Port m_ports[4];
+	};
+}
+
+#endif
@@ -0,0 +1,43 @@
+#include "stop_p.hpp"
+#include "kovan_p.hpp"
+#include "kovan_regs_p.hpp"
+
+#include <vector>
+
+using namespace Private;
+
+// Lower byte of each register: two bits per motor, or one bit per port
+#define ALL_PORTS 0x00FF
+// Servo enable bits 1 - 4 of MOTOR_ALL_STOP
+#define ALL_SERVOS 0x001E
+
+static void set(State &state, std::vector<Command> &commands, const unsigned short reg, const unsigned short value)
+{
+	state.t[reg] = value;
+	commands.push_back(createWriteCommand(reg, value));
+}
+
+bool EmergencyStop::trigger(const unsigned scope)
+{
+	Kovan *const kovan = Kovan::instance();
+	kovan->lock();
+	State &state = kovan->currentState();
+	
+	std::vector<Command> commands;
+	if(scope & EmergencyStop::Motors) {
+		set(state, commands, PID_MODES, state.t[PID_MODES] & ~ALL_PORTS);
+		set(state, commands, MOTOR_DRIVE_CODE_T, state.t[MOTOR_DRIVE_CODE_T] & ~ALL_PORTS);
+	}
+	if(scope & EmergencyStop::Ports) {
+		set(state, commands, AN_PULLUPS, state.t[AN_PULLUPS] | ALL_PORTS);
+		set(state, commands, DIG_OUT_ENABLE, state.t[DIG_OUT_ENABLE] & ~ALL_PORTS);
+		set(state, commands, DIG_PULLUPS, state.t[DIG_PULLUPS] | ALL_PORTS);
+	}
+	if(scope & EmergencyStop::Servos) {
+		set(state, commands, MOTOR_ALL_STOP, state.t[MOTOR_ALL_STOP] & ~ALL_SERVOS);
+	}
+	
+	const bool ret = kovan->sendPriority(commands);
+	kovan->unlock();
+	return ret;
+}
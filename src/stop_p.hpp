@@ -0,0 +1,22 @@
+#ifndef _STOP_P_HPP_
+#define _STOP_P_HPP_
+
+namespace Private
+{
+	// Computes the final register values of ao(), freeze_halt() and halt()
+	// locally and sends them as one priority packet, instead of one round
+	// trip per port.
+	class EmergencyStop
+	{
+	public:
+		enum Scope {
+			Motors = 1, // PID off and passive stop on every motor
+			Ports = 2, // Digital ports to inputs, pullups on every port
+			Servos = 4 // Servos disabled
+		};
+		
+		static bool trigger(const unsigned scope);
+	};
+}
+
+#endif
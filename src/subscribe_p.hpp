@@ -0,0 +1,33 @@
+#ifndef _SUBSCRIBE_P_HPP_
+#define _SUBSCRIBE_P_HPP_
+
+#include "kovan_command_p.hpp"
+#include "delta_p.hpp"
+
+#include <stdint.h>
+
+// A subscription ends unless it is renewed within this time
+#define SUBSCRIBE_LEASE 10000 // ms
+#define SUBSCRIBE_RENEW (SUBSCRIBE_LEASE / 2)
+
+namespace Private
+{
+	// Pushed by the daemon to a subscriber. seq 1 is encoded against an
+	// all-zero state and starts every subscription and renewal; each later
+	// push is a StateDelta against the previous one. Registers outside the
+	// subscribed range are always zero.
+	struct StatePush
+	{
+		uint32_t seq;
+		uint16_t length;
+		uint16_t reserved;
+		unsigned char delta[STATE_DELTA_MAX_SIZE];
+	};
+	
+	inline size_t statePushSize(const uint16_t length)
+	{
+		return sizeof(StatePush) - STATE_DELTA_MAX_SIZE + length;
+	}
+}
+
+#endif
@@ -0,0 +1,339 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/task.hpp"
+
+#ifndef WIN32
+#include <unistd.h>
+#else
+#error Windows not yet supported.
+#endif
+
+#include <cstdlib>
+
+static __thread int s_currentWorker = -1;
+
+class TaskWorker : public Thread
+{
+public:
+	TaskWorker(ThreadPool *const pool, const int index)
+		: m_pool(pool),
+		m_index(index)
+	{
+	}
+	
+	virtual void run()
+	{
+		s_currentWorker = m_index;
+		while(!m_pool->m_stop) {
+			if(m_pool->runOne(m_index)) continue;
+			m_pool->idle(m_index);
+		}
+	}
+	
+private:
+	ThreadPool *m_pool;
+	int m_index;
+};
+
+class ParallelForChunk : public Task
+{
+public:
+	ParallelForChunk()
+		: m_body(0),
+		m_begin(0),
+		m_end(0)
+	{
+	}
+	
+	void set(ParallelForBody *const body, const int begin, const int end)
+	{
+		m_body = body;
+		m_begin = begin;
+		m_end = end;
+	}
+	
+	virtual void run()
+	{
+		m_body->run(m_begin, m_end);
+	}
+	
+private:
+	ParallelForBody *m_body;
+	int m_begin;
+	int m_end;
+};
+
+// Task //
+
+Task::Task()
+	: m_done(true),
+	m_autoDelete(false)
+{
+}
+
+Task::~Task()
+{
+}
+
+bool Task::isDone() const
+{
+	return m_done;
+}
+
+void Task::wait()
+{
+	ThreadPool *const pool = ThreadPool::instance();
+	const int self = ThreadPool::currentWorker();
+	while(!m_done) {
+		// Help out instead of sleeping. This also keeps nested
+		// waits from starving a small pool.
+		if(pool->runOne(self)) continue;
+		
+		// Sleep until some task finishes. The timeout covers work that
+		// shows up while we sleep and only we could run.
+		pool->m_sleepMutex.lock();
+		if(!m_done) pool->m_taskFinished.wait(pool->m_sleepMutex, 10);
+		pool->m_sleepMutex.unlock();
+	}
+	__sync_synchronize();
+}
+
+Task::Task(const Task &)
+{
+}
+
+Task &Task::operator=(const Task &)
+{
+	return *this;
+}
+
+ParallelForBody::~ParallelForBody()
+{
+}
+
+// ThreadPool //
+
+ThreadPool::~ThreadPool()
+{
+	stopWorkers();
+}
+
+void ThreadPool::setWorkerCount(const unsigned workers)
+{
+	m_resize.lock();
+	stopWorkers();
+	startWorkers(workers);
+	m_resize.unlock();
+}
+
+unsigned ThreadPool::workerCount() const
+{
+	return m_workers.size();
+}
+
+void ThreadPool::submit(Task *const task, const bool autoDelete)
+{
+	if(!task) return;
+	task->m_done = false;
+	task->m_autoDelete = autoDelete;
+	
+	// Workers push onto their own queue so that related work stays
+	// on the same thread. Everybody else spreads work round robin.
+	int index = currentWorker();
+	if(index < 0) index = __sync_fetch_and_add(&m_next, 1) % m_queueCount;
+	
+	Queue &queue = m_queues[index];
+	queue.mutex.lock();
+	queue.tasks.push_back(task);
+	queue.mutex.unlock();
+	
+	m_sleepMutex.lock();
+	++m_pending;
+	m_workAvailable.signal();
+	m_sleepMutex.unlock();
+}
+
+void ThreadPool::parallelFor(const int begin, const int end, ParallelForBody *const body,
+	const int grain)
+{
+	if(!body || end <= begin) return;
+	
+	const int count = end - begin;
+	int chunkSize = grain;
+	if(chunkSize <= 0) {
+		chunkSize = count / (workerCount() * 4);
+		if(chunkSize < 1) chunkSize = 1;
+	}
+	
+	const int chunks = (count + chunkSize - 1) / chunkSize;
+	ParallelForChunk *const work = new ParallelForChunk[chunks];
+	for(int i = 0; i < chunks; ++i) {
+		const int chunkBegin = begin + i * chunkSize;
+		const int chunkEnd = chunkBegin + chunkSize < end ? chunkBegin + chunkSize : end;
+		work[i].set(body, chunkBegin, chunkEnd);
+	}
+	
+	// The first chunk is run inline by the caller
+	for(int i = 1; i < chunks; ++i) submit(&work[i]);
+	work[0].run();
+	for(int i = 1; i < chunks; ++i) work[i].wait();
+	
+	delete[] work;
+}
+
+ThreadPool *ThreadPool::instance()
+{
+	static ThreadPool s_instance;
+	return &s_instance;
+}
+
+ThreadPool::ThreadPool()
+	: m_queueCount(0),
+	m_next(0),
+	m_stop(false),
+	m_pending(0)
+{
+	long workers = 0;
+	const char *const env = getenv("KOVAN_WORKERS");
+	if(env) workers = strtol(env, 0, 10);
+	if(workers <= 0) workers = sysconf(_SC_NPROCESSORS_ONLN);
+	startWorkers(workers > 0 ? workers : 1);
+}
+
+ThreadPool::ThreadPool(const ThreadPool &)
+{
+}
+
+ThreadPool &ThreadPool::operator=(const ThreadPool &)
+{
+	return *this;
+}
+
+Task *ThreadPool::take(const int self)
+{
+	const unsigned queues = m_queueCount;
+	
+	// Newest work from our own queue first
+	if(self >= 0) {
+		Queue &own = m_queues[self];
+		own.mutex.lock();
+		if(!own.tasks.empty()) {
+			Task *const task = own.tasks.back();
+			own.tasks.pop_back();
+			own.mutex.unlock();
+			__sync_fetch_and_sub(&m_pending, 1);
+			return task;
+		}
+		own.mutex.unlock();
+	}
+	
+	// Then steal the oldest work from somebody else
+	const unsigned start = self >= 0 ? self + 1 : 0;
+	for(unsigned i = 0; i < queues; ++i) {
+		const unsigned victim = (start + i) % queues;
+		if((int)victim == self) continue;
+		Queue &queue = m_queues[victim];
+		if(!queue.mutex.tryLock()) continue;
+		if(!queue.tasks.empty()) {
+			Task *const task = queue.tasks.front();
+			queue.tasks.pop_front();
+			queue.mutex.unlock();
+			__sync_fetch_and_sub(&m_pending, 1);
+			return task;
+		}
+		queue.mutex.unlock();
+	}
+	
+	return 0;
+}
+
+bool ThreadPool::runOne(const int self)
+{
+	Task *const task = take(self);
+	if(!task) return false;
+	execute(task);
+	return true;
+}
+
+void ThreadPool::execute(Task *const task)
+{
+	const bool autoDelete = task->m_autoDelete;
+	task->run();
+	if(autoDelete) {
+		delete task;
+		return;
+	}
+	__sync_synchronize();
+	task->m_done = true;
+	notifyFinished();
+}
+
+void ThreadPool::startWorkers(const unsigned workers)
+{
+	unsigned count = workers;
+	if(count < 1) count = 1;
+	if(count > TASK_MAX_WORKERS) count = TASK_MAX_WORKERS;
+	
+	// Queues are never removed, so work left in the queue of a
+	// retired worker is still found by stealing.
+	if(count > m_queueCount) m_queueCount = count;
+	
+	m_stop = false;
+	for(unsigned i = 0; i < count; ++i) {
+		TaskWorker *const worker = new TaskWorker(this, i);
+		m_workers.push_back(worker);
+		worker->start();
+	}
+}
+
+void ThreadPool::stopWorkers()
+{
+	m_sleepMutex.lock();
+	m_stop = true;
+	m_workAvailable.broadcast();
+	m_sleepMutex.unlock();
+	
+	std::vector<TaskWorker *>::iterator it = m_workers.begin();
+	for(; it != m_workers.end(); ++it) {
+		(*it)->join();
+		delete *it;
+	}
+	m_workers.clear();
+}
+
+void ThreadPool::idle(const int self)
+{
+	m_sleepMutex.lock();
+	while(!m_stop && m_pending <= 0) m_workAvailable.wait(m_sleepMutex);
+	m_sleepMutex.unlock();
+}
+
+void ThreadPool::notifyFinished()
+{
+	m_sleepMutex.lock();
+	m_taskFinished.broadcast();
+	m_sleepMutex.unlock();
+}
+
+int ThreadPool::currentWorker()
+{
+	return s_currentWorker;
+}
@@ -0,0 +1,115 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/task.h"
+#include "kovan/task.hpp"
+
+class FunctionTask : public Task
+{
+public:
+	FunctionTask(task_function func, void *arg)
+		: m_func(func),
+		m_arg(arg)
+	{
+	}
+	
+	void run()
+	{
+		(*m_func)(m_arg);
+	}
+	
+private:
+	task_function m_func;
+	void *m_arg;
+};
+
+class FunctionBody : public ParallelForBody
+{
+public:
+	FunctionBody(parallel_for_function func, void *arg)
+		: m_func(func),
+		m_arg(arg)
+	{
+	}
+	
+	void run(const int begin, const int end)
+	{
+		(*m_func)(begin, end, m_arg);
+	}
+	
+private:
+	parallel_for_function m_func;
+	void *m_arg;
+};
+
+FunctionTask *taskObject(void *data)
+{
+	return reinterpret_cast<FunctionTask *>(data);
+}
+
+task taskStruct(FunctionTask *t)
+{
+	task ret;
+	ret.data = reinterpret_cast<void *>(t);
+	return ret;
+}
+
+void task_set_worker_count(int count)
+{
+	ThreadPool::instance()->setWorkerCount(count > 0 ? count : 1);
+}
+
+int task_worker_count()
+{
+	return ThreadPool::instance()->workerCount();
+}
+
+task task_submit(task_function func, void *arg)
+{
+	FunctionTask *const t = new FunctionTask(func, arg);
+	ThreadPool::instance()->submit(t);
+	return taskStruct(t);
+}
+
+void task_wait(task t)
+{
+	if(!t.data) return;
+	taskObject(t.data)->wait();
+}
+
+int task_done(task t)
+{
+	if(!t.data) return 1;
+	return taskObject(t.data)->isDone() ? 1 : 0;
+}
+
+void task_destroy(task t)
+{
+	if(!t.data) return;
+	taskObject(t.data)->wait();
+	delete taskObject(t.data);
+}
+
+void parallel_for(int begin, int end, int grain, parallel_for_function func, void *arg)
+{
+	if(!func) return;
+	FunctionBody body(func, arg);
+	ThreadPool::instance()->parallelFor(begin, end, &body, grain);
+}
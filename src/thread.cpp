@@ -1,9 +1,25 @@
 #include "kovan/thread.hpp"
+#include "warn.hpp"
 
 #ifdef WIN32
 #include <windows.h>
 #else
 #include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+// sem_clockwait appeared in glibc 2.30
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+#define HAVE_SEM_CLOCKWAIT
+#else
+#define SEMAPHORE_WAIT_SLICE 10 // ms, how far a wall clock change can stretch a timed wait
+#endif
 #endif
 
 Mutex::Mutex()
@@ -15,6 +31,20 @@ Mutex::Mutex()
 #endif
 }
 
+Mutex::Mutex(const bool recursive)
+{
+#ifdef WIN32
+	// Critical sections are always recursive
+	InitializeCriticalSection(&m_handle);
+#else
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	if(recursive) pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&m_handle, &attr);
+	pthread_mutexattr_destroy(&attr);
+#endif
+}
+
 Mutex::~Mutex()
 {
 #ifdef WIN32
@@ -55,6 +85,286 @@ Mutex::Mutex(const Mutex &)
 {
 }
 
+#ifndef WIN32
+static timespec deadlineAfter(const clockid_t clock, const unsigned long msecs)
+{
+	timespec ret;
+	clock_gettime(clock, &ret);
+	ret.tv_sec += msecs / 1000UL;
+	ret.tv_nsec += (msecs % 1000UL) * 1000000L;
+	if(ret.tv_nsec >= 1000000000L) {
+		++ret.tv_sec;
+		ret.tv_nsec -= 1000000000L;
+	}
+	return ret;
+}
+#endif
+
+ConditionVariable::ConditionVariable()
+{
+#ifdef WIN32
+	InitializeConditionVariable(&m_handle);
+#else
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&m_handle, &attr);
+	pthread_condattr_destroy(&attr);
+#endif
+}
+
+ConditionVariable::~ConditionVariable()
+{
+#ifndef WIN32
+	pthread_cond_destroy(&m_handle);
+#endif
+}
+
+void ConditionVariable::wait(Mutex &mutex)
+{
+#ifdef WIN32
+	SleepConditionVariableCS(&m_handle, &mutex.m_handle, INFINITE);
+#else
+	pthread_cond_wait(&m_handle, &mutex.m_handle);
+#endif
+}
+
+bool ConditionVariable::wait(Mutex &mutex, const unsigned long msecs)
+{
+#ifdef WIN32
+	return SleepConditionVariableCS(&m_handle, &mutex.m_handle, msecs);
+#else
+	const timespec deadline = deadlineAfter(CLOCK_MONOTONIC, msecs);
+	return pthread_cond_timedwait(&m_handle, &mutex.m_handle, &deadline) != ETIMEDOUT;
+#endif
+}
+
+void ConditionVariable::signal()
+{
+#ifdef WIN32
+	WakeConditionVariable(&m_handle);
+#else
+	pthread_cond_signal(&m_handle);
+#endif
+}
+
+void ConditionVariable::broadcast()
+{
+#ifdef WIN32
+	WakeAllConditionVariable(&m_handle);
+#else
+	pthread_cond_broadcast(&m_handle);
+#endif
+}
+
+ConditionVariable::ConditionVariable(const ConditionVariable &)
+{
+}
+
+Semaphore::Semaphore(const unsigned initial)
+{
+#ifdef WIN32
+	m_handle = CreateSemaphore(NULL, initial, 0x7FFFFFFF, NULL);
+#else
+	sem_init(&m_handle, 0, initial);
+#endif
+}
+
+Semaphore::~Semaphore()
+{
+#ifdef WIN32
+	CloseHandle(m_handle);
+#else
+	sem_destroy(&m_handle);
+#endif
+}
+
+void Semaphore::wait()
+{
+#ifdef WIN32
+	WaitForSingleObject(m_handle, INFINITE);
+#else
+	while(sem_wait(&m_handle) < 0 && errno == EINTR);
+#endif
+}
+
+bool Semaphore::wait(const unsigned long msecs)
+{
+#ifdef WIN32
+	return WaitForSingleObject(m_handle, msecs) == WAIT_OBJECT_0;
+#else
+	const timespec deadline = deadlineAfter(CLOCK_MONOTONIC, msecs);
+#ifdef HAVE_SEM_CLOCKWAIT
+	int ret = 0;
+	while((ret = sem_clockwait(&m_handle, CLOCK_MONOTONIC, &deadline)) < 0 && errno == EINTR);
+	return ret == 0;
+#else
+	// sem_timedwait only understands the realtime clock, so wait in short
+	// realtime slices until the monotonic deadline has passed
+	for(;;) {
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		const long long leftNs = (deadline.tv_sec - now.tv_sec) * 1000000000LL
+			+ (deadline.tv_nsec - now.tv_nsec);
+		if(leftNs <= 0) return tryWait();
+		const long long left = (leftNs + 999999LL) / 1000000LL;
+		
+		const timespec slice = deadlineAfter(CLOCK_REALTIME,
+			left < SEMAPHORE_WAIT_SLICE ? left : SEMAPHORE_WAIT_SLICE);
+		if(sem_timedwait(&m_handle, &slice) == 0) return true;
+		if(errno != ETIMEDOUT && errno != EINTR) return false;
+	}
+#endif
+#endif
+}
+
+bool Semaphore::tryWait()
+{
+#ifdef WIN32
+	return WaitForSingleObject(m_handle, 0) == WAIT_OBJECT_0;
+#else
+	return sem_trywait(&m_handle) == 0;
+#endif
+}
+
+void Semaphore::post()
+{
+#ifdef WIN32
+	ReleaseSemaphore(m_handle, 1, NULL);
+#else
+	sem_post(&m_handle);
+#endif
+}
+
+Semaphore::Semaphore(const Semaphore &)
+{
+}
+
+RwLock::RwLock()
+{
+#ifdef WIN32
+	InitializeSRWLock(&m_handle);
+	m_exclusive = false;
+#else
+	pthread_rwlock_init(&m_handle, NULL);
+#endif
+}
+
+RwLock::~RwLock()
+{
+#ifndef WIN32
+	pthread_rwlock_destroy(&m_handle);
+#endif
+}
+
+void RwLock::readLock()
+{
+#ifdef WIN32
+	AcquireSRWLockShared(&m_handle);
+#else
+	pthread_rwlock_rdlock(&m_handle);
+#endif
+}
+
+bool RwLock::tryReadLock()
+{
+#ifdef WIN32
+	return TryAcquireSRWLockShared(&m_handle);
+#else
+	return pthread_rwlock_tryrdlock(&m_handle) == 0;
+#endif
+}
+
+void RwLock::writeLock()
+{
+#ifdef WIN32
+	AcquireSRWLockExclusive(&m_handle);
+	m_exclusive = true;
+#else
+	pthread_rwlock_wrlock(&m_handle);
+#endif
+}
+
+bool RwLock::tryWriteLock()
+{
+#ifdef WIN32
+	if(!TryAcquireSRWLockExclusive(&m_handle)) return false;
+	m_exclusive = true;
+	return true;
+#else
+	return pthread_rwlock_trywrlock(&m_handle) == 0;
+#endif
+}
+
+void RwLock::unlock()
+{
+#ifdef WIN32
+	if(m_exclusive) {
+		m_exclusive = false;
+		ReleaseSRWLockExclusive(&m_handle);
+	} else ReleaseSRWLockShared(&m_handle);
+#else
+	pthread_rwlock_unlock(&m_handle);
+#endif
+}
+
+RwLock::RwLock(const RwLock &)
+{
+}
+
+#ifndef WIN32
+static int nativePolicy(const Thread::Policy policy)
+{
+	switch(policy) {
+	case Thread::FifoPolicy: return SCHED_FIFO;
+	case Thread::RoundRobinPolicy: return SCHED_RR;
+	default: break;
+	}
+	return SCHED_OTHER;
+}
+
+static sched_param nativeParam(const Thread::Policy policy, const int priority)
+{
+	sched_param ret;
+	memset(&ret, 0, sizeof(ret));
+	if(policy == Thread::DefaultPolicy) return ret;
+	
+	const int native = nativePolicy(policy);
+	const int min = sched_get_priority_min(native);
+	const int max = sched_get_priority_max(native);
+	ret.sched_priority = priority < min ? min : (priority > max ? max : priority);
+	return ret;
+}
+
+static bool applyPriority(const pthread_t thread, const Thread::Policy policy, const int priority)
+{
+	const sched_param param = nativeParam(policy, priority);
+	const int ret = pthread_setschedparam(thread, nativePolicy(policy), &param);
+	if(ret != 0) {
+		errno = ret;
+		PWARN("failed to set scheduling policy %d, priority %d", policy, priority);
+		return false;
+	}
+	return true;
+}
+
+static bool applyAffinity(const pthread_t thread, const unsigned long mask)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(unsigned i = 0; i < sizeof(mask) * 8; ++i) {
+		if(!mask || (mask & (1UL << i))) CPU_SET(i, &set);
+	}
+	const int ret = pthread_setaffinity_np(thread, sizeof(set), &set);
+	if(ret != 0) {
+		errno = ret;
+		PWARN("failed to set CPU affinity mask 0x%lx", mask);
+		return false;
+	}
+	return true;
+}
+#endif
+
 static void *__runThread(void *data)
 {
 	Thread *t = reinterpret_cast<Thread *>(data);
@@ -65,9 +375,15 @@ static void *__runThread(void *data)
 
 
 Thread::Thread()
+	:
 #ifdef WIN32
-	: m_thread(-1)
+	m_thread(-1),
 #endif
+	m_running(false),
+	m_policy(Thread::DefaultPolicy),
+	m_priority(0),
+	m_affinity(0),
+	m_stackSize(0)
 {
 	
 }
@@ -77,7 +393,8 @@ Thread::~Thread()
 #ifdef WIN32
 	if(m_thread != INVALID_HANDLE) CloseHandle(m_thread);
 #else
-	pthread_cancel(m_thread);
+	// Never cancel a thread id that was already joined; it may have been reused.
+	if(m_running) pthread_cancel(m_thread);
 #endif
 }
 
@@ -87,8 +404,41 @@ void Thread::start()
 	CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)__runThread,
 		reinterpret_cast<LPVOID>(this), 0, NULL);
 #else
-	pthread_create(&m_thread, NULL, &__runThread,
-		reinterpret_cast<void *>(this));
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	if(m_stackSize) {
+		const unsigned long stackSize = m_stackSize < (unsigned long)PTHREAD_STACK_MIN
+			? PTHREAD_STACK_MIN : m_stackSize;
+		if(pthread_attr_setstacksize(&attr, stackSize) != 0) {
+			WARN("invalid stack size %lu, using the default", m_stackSize);
+		}
+	}
+	
+	if(m_policy != Thread::DefaultPolicy) {
+		const sched_param param = nativeParam(m_policy, m_priority);
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, nativePolicy(m_policy));
+		pthread_attr_setschedparam(&attr, &param);
+	}
+	
+	int ret = pthread_create(&m_thread, &attr, &__runThread, reinterpret_cast<void *>(this));
+	if(ret == EPERM && m_policy != Thread::DefaultPolicy) {
+		// Not privileged enough for real-time scheduling. Run anyway.
+		WARN("insufficient privileges for real-time priority %d, using default scheduling", m_priority);
+		pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+		m_policy = Thread::DefaultPolicy;
+		ret = pthread_create(&m_thread, &attr, &__runThread, reinterpret_cast<void *>(this));
+	}
+	pthread_attr_destroy(&attr);
+	
+	m_running = ret == 0;
+	if(!m_running) {
+		errno = ret;
+		PWARN("pthread_create failed");
+		return;
+	}
+	
+	if(m_affinity) applyAffinity(m_thread, m_affinity);
 #endif
 }
 
@@ -97,6 +447,96 @@ void Thread::join()
 #ifdef WIN32
 	WaitForSingleObject(m_thread, INFINITE);
 #else
+	if(!m_running) return;
 	pthread_join(m_thread, NULL);
+	m_running = false;
 #endif
-}
\ No newline at end of file
+}
+
+bool Thread::setPriority(const Thread::Policy policy, const int priority)
+{
+	m_policy = policy;
+	m_priority = priority;
+#ifndef WIN32
+	if(!m_running) return true;
+	return applyPriority(m_thread, policy, priority);
+#else
+	return false;
+#endif
+}
+
+Thread::Policy Thread::policy() const
+{
+	return m_policy;
+}
+
+int Thread::priority() const
+{
+	return m_priority;
+}
+
+bool Thread::setAffinity(const unsigned long mask)
+{
+	m_affinity = mask;
+#ifndef WIN32
+	if(!m_running) return true;
+	return applyAffinity(m_thread, mask);
+#else
+	return false;
+#endif
+}
+
+unsigned long Thread::affinity() const
+{
+	return m_affinity;
+}
+
+void Thread::setStackSize(const unsigned long bytes)
+{
+	m_stackSize = bytes;
+}
+
+unsigned long Thread::stackSize() const
+{
+	return m_stackSize;
+}
+
+bool Thread::setCurrentPriority(const Thread::Policy policy, const int priority)
+{
+#ifndef WIN32
+	return applyPriority(pthread_self(), policy, priority);
+#else
+	return false;
+#endif
+}
+
+bool Thread::setCurrentAffinity(const unsigned long mask)
+{
+#ifndef WIN32
+	return applyAffinity(pthread_self(), mask);
+#else
+	return false;
+#endif
+}
+
+bool Thread::lockMemory()
+{
+#ifndef WIN32
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+		PWARN("mlockall failed");
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Thread::unlockMemory()
+{
+#ifndef WIN32
+	return munlockall() == 0;
+#else
+	return false;
+#endif
+}
@@ -1,5 +1,8 @@
 #include "kovan/thread.h"
 #include "kovan/thread.hpp"
+#include "kovan/queue.hpp"
+
+#include <sched.h>
 
 class FunctionThread : public Thread
 {
@@ -18,11 +21,69 @@ private:
 	thread_function m_func;
 };
 
+class PointerQueue
+{
+public:
+	PointerQueue(const size_t capacity)
+		: m_queue(capacity)
+	{
+	}
+	
+	bool push(void *const item)
+	{
+		if(!m_queue.push(item)) return false;
+		m_available.post();
+		return true;
+	}
+	
+	bool pop(void *&item, const long msecs)
+	{
+		if(msecs < 0) m_available.wait();
+		else if(msecs == 0) {
+			if(!m_available.tryWait()) return false;
+		} else if(!m_available.wait(msecs)) return false;
+		
+		// A count was taken, so an item is on its way. It may still
+		// be in the middle of being written by its producer.
+		while(!m_queue.pop(item)) sched_yield();
+		return true;
+	}
+	
+	size_t size() const
+	{
+		return m_queue.size();
+	}
+	
+private:
+	MpscQueue<void *> m_queue;
+	Semaphore m_available;
+};
+
 Mutex *mutexObject(void *data)
 {
 	return reinterpret_cast<Mutex *>(data);
 }
 
+ConditionVariable *condObject(void *data)
+{
+	return reinterpret_cast<ConditionVariable *>(data);
+}
+
+Semaphore *semaphoreObject(void *data)
+{
+	return reinterpret_cast<Semaphore *>(data);
+}
+
+RwLock *rwlockObject(void *data)
+{
+	return reinterpret_cast<RwLock *>(data);
+}
+
+PointerQueue *queueObject(void *data)
+{
+	return reinterpret_cast<PointerQueue *>(data);
+}
+
 FunctionThread *threadObject(void *data)
 {
 	return reinterpret_cast<FunctionThread *>(data);
@@ -35,6 +96,34 @@ mutex mutexStruct(Mutex *m)
 	return ret;
 }
 
+cond condStruct(ConditionVariable *c)
+{
+	cond ret;
+	ret.data = reinterpret_cast<void *>(c);
+	return ret;
+}
+
+semaphore semaphoreStruct(Semaphore *s)
+{
+	semaphore ret;
+	ret.data = reinterpret_cast<void *>(s);
+	return ret;
+}
+
+rwlock rwlockStruct(RwLock *l)
+{
+	rwlock ret;
+	ret.data = reinterpret_cast<void *>(l);
+	return ret;
+}
+
+queue queueStruct(PointerQueue *q)
+{
+	queue ret;
+	ret.data = reinterpret_cast<void *>(q);
+	return ret;
+}
+
 thread threadStruct(FunctionThread *t)
 {
 	thread ret;
@@ -67,6 +156,133 @@ void mutex_destroy(mutex m)
 	delete mutexObject(m.data);
 }
 
+cond cond_create(void)
+{
+	return condStruct(new ConditionVariable());
+}
+
+void cond_wait(cond c, mutex m)
+{
+	condObject(c.data)->wait(*mutexObject(m.data));
+}
+
+int cond_wait_timeout(cond c, mutex m, long msecs)
+{
+	if(msecs < 0) msecs = 0;
+	return condObject(c.data)->wait(*mutexObject(m.data), msecs) ? 1 : 0;
+}
+
+void cond_signal(cond c)
+{
+	condObject(c.data)->signal();
+}
+
+void cond_broadcast(cond c)
+{
+	condObject(c.data)->broadcast();
+}
+
+void cond_destroy(cond c)
+{
+	delete condObject(c.data);
+}
+
+semaphore semaphore_create(int initial)
+{
+	return semaphoreStruct(new Semaphore(initial > 0 ? initial : 0));
+}
+
+void semaphore_wait(semaphore s)
+{
+	semaphoreObject(s.data)->wait();
+}
+
+int semaphore_wait_timeout(semaphore s, long msecs)
+{
+	if(msecs < 0) msecs = 0;
+	return semaphoreObject(s.data)->wait(msecs) ? 1 : 0;
+}
+
+int semaphore_trywait(semaphore s)
+{
+	return semaphoreObject(s.data)->tryWait() ? 1 : 0;
+}
+
+void semaphore_post(semaphore s)
+{
+	semaphoreObject(s.data)->post();
+}
+
+void semaphore_destroy(semaphore s)
+{
+	delete semaphoreObject(s.data);
+}
+
+rwlock rwlock_create(void)
+{
+	return rwlockStruct(new RwLock());
+}
+
+void rwlock_read_lock(rwlock l)
+{
+	rwlockObject(l.data)->readLock();
+}
+
+void rwlock_write_lock(rwlock l)
+{
+	rwlockObject(l.data)->writeLock();
+}
+
+void rwlock_unlock(rwlock l)
+{
+	rwlockObject(l.data)->unlock();
+}
+
+void rwlock_destroy(rwlock l)
+{
+	delete rwlockObject(l.data);
+}
+
+queue queue_create(int capacity)
+{
+	return queueStruct(new PointerQueue(capacity > 0 ? capacity : 1));
+}
+
+int queue_push(queue q, void *item)
+{
+	return queueObject(q.data)->push(item) ? 1 : 0;
+}
+
+void *queue_pop(queue q)
+{
+	void *item = 0;
+	queueObject(q.data)->pop(item, -1);
+	return item;
+}
+
+int queue_pop_timeout(queue q, void **item, long msecs)
+{
+	void *ret = 0;
+	if(!queueObject(q.data)->pop(ret, msecs < 0 ? 0 : msecs)) return 0;
+	if(item) *item = ret;
+	return 1;
+}
+
+int queue_trypop(queue q, void **item)
+{
+	return queue_pop_timeout(q, item, 0);
+}
+
+int queue_size(queue q)
+{
+	return queueObject(q.data)->size();
+}
+
+void queue_destroy(queue q)
+{
+	delete queueObject(q.data);
+}
+
 thread thread_create(thread_function func)
 {
 	return threadStruct(new FunctionThread(func));
@@ -85,4 +301,48 @@ void thread_wait(thread id)
 void thread_destroy(thread id)
 {
 	delete threadObject(id.data);
-}
\ No newline at end of file
+}
+
+static Thread::Policy threadPolicy(int policy)
+{
+	switch(policy) {
+	case THREAD_POLICY_FIFO: return Thread::FifoPolicy;
+	case THREAD_POLICY_RR: return Thread::RoundRobinPolicy;
+	}
+	return Thread::DefaultPolicy;
+}
+
+int thread_set_priority(thread id, int policy, int priority)
+{
+	return threadObject(id.data)->setPriority(threadPolicy(policy), priority) ? 1 : 0;
+}
+
+int thread_set_affinity(thread id, unsigned long mask)
+{
+	return threadObject(id.data)->setAffinity(mask) ? 1 : 0;
+}
+
+void thread_set_stack_size(thread id, unsigned long bytes)
+{
+	threadObject(id.data)->setStackSize(bytes);
+}
+
+int set_current_thread_priority(int policy, int priority)
+{
+	return Thread::setCurrentPriority(threadPolicy(policy), priority) ? 1 : 0;
+}
+
+int set_current_thread_affinity(unsigned long mask)
+{
+	return Thread::setCurrentAffinity(mask) ? 1 : 0;
+}
+
+int lock_memory()
+{
+	return Thread::lockMemory() ? 1 : 0;
+}
+
+int unlock_memory()
+{
+	return Thread::unlockMemory() ? 1 : 0;
+}
@@ -19,9 +19,11 @@
  **************************************************************************/
 
 #include "time_p.hpp"
+#include "warn.hpp"
 
 #include <unistd.h>
 #include <sys/time.h>
+#include <time.h>
 #include <errno.h>
 #include <string.h>
 #include <algorithm>
@@ -34,7 +36,7 @@ void Private::Time::microsleep(unsigned long microsecs)
 	while(microsecs) {
 		const unsigned long current = std::min(microsecs, 999999UL);
 		if(usleep(current)) {
-			perror("usleep");
+			PWARN("usleep failed");
 			return;
 		}
 		microsecs -= current;
@@ -47,3 +49,10 @@ unsigned long Private::Time::systime()
 	gettimeofday(&t, 0);
 	return ((unsigned long)t.tv_sec) * 1000L + t.tv_usec / 1000L;
 }
+
+unsigned long long Private::Time::monotonic()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return ((unsigned long long)t.tv_sec) * 1000000000ULL + t.tv_nsec;
+}
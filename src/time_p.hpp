@@ -27,6 +27,7 @@ namespace Private
 	{
 		void microsleep(unsigned long microsecs);
 		unsigned long systime();
+		unsigned long long monotonic();
 	}
 }
 
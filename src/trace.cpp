@@ -0,0 +1,141 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/trace.hpp"
+
+#ifndef WIN32
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#error Windows not yet supported.
+#endif
+
+#include <cstdio>
+
+#include "time_p.hpp"
+
+// Must be a power of two
+#define TRACE_RING_SIZE 8192
+
+namespace
+{
+	struct TraceRecord
+	{
+		const char *name;
+		unsigned long long begin;
+		unsigned long long end;
+	};
+	
+	// Written only by its owning thread. Readers use the published
+	// write count to find the valid records.
+	struct TraceRing
+	{
+		TraceRecord records[TRACE_RING_SIZE];
+		unsigned long long written;
+		unsigned long long cleared;
+		long tid;
+		TraceRing *next;
+	};
+}
+
+volatile bool Trace::s_enabled = false;
+
+static __thread TraceRing *s_ring = 0;
+static TraceRing *s_rings = 0;
+
+static TraceRing *createRing()
+{
+	TraceRing *const ring = new TraceRing;
+	ring->written = 0;
+	ring->cleared = 0;
+	ring->tid = syscall(SYS_gettid);
+	
+	// Rings outlive their threads so a dump still sees their records
+	ring->next = __atomic_load_n(&s_rings, __ATOMIC_ACQUIRE);
+	while(!__atomic_compare_exchange_n(&s_rings, &ring->next, ring, true,
+		__ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+	return ring;
+}
+
+static void writeEscaped(FILE *const fp, const char *s)
+{
+	for(; *s; ++s) {
+		if(*s == '"' || *s == '\\') fputc('\\', fp);
+		if((unsigned char)*s < 0x20) continue;
+		fputc(*s, fp);
+	}
+}
+
+void Trace::setEnabled(const bool enabled)
+{
+	s_enabled = enabled;
+}
+
+void Trace::record(const char *const name, const unsigned long long begin, const unsigned long long end)
+{
+	TraceRing *ring = s_ring;
+	if(!ring) ring = s_ring = createRing();
+	
+	const unsigned long long index = ring->written;
+	TraceRecord &record = ring->records[index & (TRACE_RING_SIZE - 1)];
+	record.name = name;
+	record.begin = begin;
+	record.end = end;
+	__atomic_store_n(&ring->written, index + 1, __ATOMIC_RELEASE);
+}
+
+bool Trace::dump(const char *const path)
+{
+	FILE *const fp = fopen(path, "w");
+	if(!fp) return false;
+	
+	const int pid = getpid();
+	bool first = true;
+	fprintf(fp, "{\"traceEvents\":[");
+	for(TraceRing *ring = __atomic_load_n(&s_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+		const unsigned long long written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+		unsigned long long i = written > TRACE_RING_SIZE ? written - TRACE_RING_SIZE : 0;
+		if(i < ring->cleared) i = ring->cleared;
+		
+		for(; i < written; ++i) {
+			const TraceRecord &record = ring->records[i & (TRACE_RING_SIZE - 1)];
+			fprintf(fp, "%s\n{\"name\":\"", first ? "" : ",");
+			writeEscaped(fp, record.name);
+			fprintf(fp, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%ld}",
+				record.begin / 1000.0, (record.end - record.begin) / 1000.0, pid, ring->tid);
+			first = false;
+		}
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ns\"}\n");
+	
+	return fclose(fp) == 0;
+}
+
+void Trace::clear()
+{
+	for(TraceRing *ring = __atomic_load_n(&s_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+		ring->cleared = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+	}
+}
+
+unsigned long long TraceSpan::now()
+{
+	return Private::Time::monotonic();
+}
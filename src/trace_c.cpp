@@ -0,0 +1,49 @@
+/**************************************************************************
+ *  Copyright 2013 KISS Institute for Practical Robotics                  *
+ *                                                                        *
+ *  This file is part of libkovan.                                        *
+ *                                                                        *
+ *  libkovan is free software: you can redistribute it and/or modify      *
+ *  it under the terms of the GNU General Public License as published by  *
+ *  the Free Software Foundation, either version 2 of the License, or     *
+ *  (at your option) any later version.                                   *
+ *                                                                        *
+ *  libkovan is distributed in the hope that it will be useful,           *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *  GNU General Public License for more details.                          *
+ *                                                                        *
+ *  You should have received a copy of the GNU General Public License     *
+ *  along with libkovan. Check the LICENSE file in the project root.      *
+ *  If not, see <http://www.gnu.org/licenses/>.                           *
+ **************************************************************************/
+
+#include "kovan/trace.h"
+#include "kovan/trace.hpp"
+#include "time_p.hpp"
+
+void trace_enable(int enabled)
+{
+	Trace::setEnabled(enabled);
+}
+
+unsigned long long trace_begin()
+{
+	return Trace::isEnabled() ? Private::Time::monotonic() : 0;
+}
+
+void trace_end(const char *name, unsigned long long token)
+{
+	if(!token) return;
+	Trace::record(name, token, Private::Time::monotonic());
+}
+
+int trace_dump(const char *path)
+{
+	return Trace::dump(path) ? 1 : 0;
+}
+
+void trace_clear()
+{
+	Trace::clear();
+}
@@ -19,6 +19,7 @@
  **************************************************************************/
 
 #include "kovan/util.h"
+#include "kovan/util.hpp"
 #include "time_p.hpp"
 
 void msleep(long msecs)
@@ -34,4 +35,29 @@ unsigned long systime()
 double seconds()
 {
 	return systime() / 1000.0;
-}
\ No newline at end of file
+}
+
+double seconds_monotonic()
+{
+	return Time::seconds();
+}
+
+unsigned long long Time::now()
+{
+	return Private::Time::monotonic();
+}
+
+double Time::seconds()
+{
+	return now() / 1000000000.0;
+}
+
+unsigned long long Time::since(const unsigned long long then)
+{
+	return now() - then;
+}
+
+unsigned long Time::msecsSince(const unsigned long long then)
+{
+	return since(then) / 1000000ULL;
+}
@@ -1,4 +1,6 @@
 #include "uvlc_video_decoder_p.hpp"
+#include "kovan/trace.hpp"
+#include "warn.hpp"
 
 #include <vector>
 #include <iostream>
@@ -482,7 +484,7 @@ void UvlcVideoDecoder::blockBytes(short dataBlockBuffer[64], bool acCoefficients
 	
 	unsigned int dcCoefficient = readStreamData(10);
 	if(QuantizerMode != CONST_TableQuantization) {
-		std::cout << "Constant quantizer mode is not yet implemented" << std::endl;
+		WARN("Constant quantizer mode is not yet implemented");
 		return;
 	}
 	
@@ -509,7 +511,7 @@ bool UvlcVideoDecoder::readHeader(cv::Mat &image, MacroBlockVector &imageSlice)
 	unsigned int startCode = code & ~0x1F;
 	
 	if (startCode != UVLC_START_CODE) {
-		std::cout << "Not a UVLC header!" << std::endl;
+		WARN("Not a UVLC header");
 		return false;
 	}
 	
@@ -608,13 +610,14 @@ void UvlcVideoDecoder::processStream(cv::Mat &image)
 
 bool UvlcVideoDecoder::decode(const unsigned char *const buffer, const size_t length, cv::Mat &image)
 {
+	KOVAN_TRACE_SPAN("UvlcVideoDecoder::decode");
 	ImageStream = buffer;
 	ImageStreamLength = length;
 	processStream(image);
 	ImageStream = 0;
 	
 	if(image.empty()) {
-		std::cout << "image decoding FAIL!!" << std::endl;
+		WARN("Image decoding failed");
 		return false;
 	}
 	
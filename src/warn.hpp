@@ -1,20 +1,19 @@
 #ifndef _WARN_HPP_
 #define _WARN_HPP_
 
-#include <cstdio>
+#include <cerrno>
+#include <cstring>
 
-#define MAX_MESSAGE_SIZE 256
+#include "kovan/log.hpp"
 
-#define WARN(x, ...) \
-	do { \
-		fprintf(stderr, "%s: warning: " x "\n", __PRETTY_FUNCTION__, ##__VA_ARGS__); \
-	} while(0)
+#define WARN(x, ...) KOVAN_LOG(Log::Warning, x, ##__VA_ARGS__)
 
 #define PWARN(x, ...) \
 	do { \
-		char buffer[MAX_MESSAGE_SIZE]; \
-		sprintf(buffer, "%s: warning: " x "\n", __PRETTY_FUNCTION__, ##__VA_ARGS__); \
-		perror(buffer); \
+		const int __pwarnErrno = errno; \
+		KOVAN_LOG(Log::Warning, x ": %s", ##__VA_ARGS__, strerror(__pwarnErrno)); \
 	} while(0)
 
+#define DEBUG_LOG(x, ...) KOVAN_LOG(Log::Debug, x, ##__VA_ARGS__)
+
 #endif
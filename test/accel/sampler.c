@@ -0,0 +1,38 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+#define BLOCK 32
+
+// Off the board, run with KOVAN_I2C=mock:mma7455_mock.cfg
+// to read scripted values from the mock i2c bus.
+
+int main(int argc, char *argv[])
+{
+	accel_sample samples[BLOCK];
+	unsigned long long last = 0;
+	int total = 0;
+	int i;
+	int n;
+	
+	if(!accel_sampler_start(125, 256)) {
+		printf("Failed to start the accelerometer sampler\n");
+		return 1;
+	}
+	
+	// Collect roughly two seconds of data in blocks
+	while(total < 250) {
+		msleep(100);
+		n = accel_read_block(samples, BLOCK);
+		for(i = 0; i < n; ++i) {
+			printf("%8.3f ms  x %4d  y %4d  z %4d\n",
+				last ? (samples[i].timestamp - last) / 1000000.0 : 0.0,
+				samples[i].x, samples[i].y, samples[i].z);
+			last = samples[i].timestamp;
+		}
+		total += n;
+	}
+	
+	printf("%d samples, %lu dropped\n", total, accel_sampler_dropped());
+	accel_sampler_stop();
+	return 0;
+}
@@ -0,0 +1,31 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Runs motor 0 at half power for a few seconds with and without battery
+// compensation and prints its speed each second. Run against
+// kovan-sim -d 40, or on a Kovan with a draining battery.
+
+static void run(const char *name)
+{
+	int second;
+	int last;
+	
+	motor(0, 50);
+	last = get_motor_position_counter(0);
+	for(second = 0; second < 4; ++second) {
+		msleep(1000);
+		printf("%-15s battery %4.0f, factor %.3f, %5d ticks/s\n", name, power_level(),
+			get_battery_compensation(), get_motor_position_counter(0) - last);
+		last = get_motor_position_counter(0);
+	}
+	off(0);
+}
+
+int main(int argc, char *argv[])
+{
+	run("uncompensated");
+	set_battery_compensation(1);
+	run("compensated");
+	set_battery_compensation(0);
+	return 0;
+}
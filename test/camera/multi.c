@@ -0,0 +1,44 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Opens every USB camera it can find, up to four, and compares updating
+// them one after another with updating them together on the worker pool.
+
+#define MAX_CAMERAS 4
+#define FRAMES 100
+
+int main(int argc, char *argv[])
+{
+	camera cameras[MAX_CAMERAS];
+	int count = 0;
+	int i;
+	int frame;
+	double start;
+	
+	for(i = 0; i < MAX_CAMERAS; ++i) {
+		cameras[count] = camera_open_handle(i, LOW_RES);
+		if(cameras[count].data) ++count;
+	}
+	if(!count) {
+		printf("no cameras\n");
+		return 1;
+	}
+	
+	start = seconds_monotonic();
+	for(frame = 0; frame < FRAMES; ++frame) {
+		for(i = 0; i < count; ++i) camera_update_h(cameras[i]);
+	}
+	printf("%d cameras, one at a time: %.1f fps\n", count,
+		FRAMES / (seconds_monotonic() - start));
+	
+	start = seconds_monotonic();
+	for(frame = 0; frame < FRAMES; ++frame) camera_update_all(cameras, count);
+	printf("%d cameras, together:      %.1f fps\n", count,
+		FRAMES / (seconds_monotonic() - start));
+	
+	for(i = 0; i < count; ++i) {
+		printf("camera %d: %lu frames\n", i, get_camera_frame_seq_h(cameras[i]));
+		camera_close_handle(cameras[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Prints a coarse grid of where channel 0's color is, and how long that
+// takes compared to finding its objects. Pass the name of a config with
+// an HSV channel 0.
+
+#define COLUMNS 4
+#define ROWS 3
+#define FRAMES 50
+
+int main(int argc, char *argv[])
+{
+	double cells[COLUMNS * ROWS];
+	double grid = 0.0;
+	double blobs = 0.0;
+	double start;
+	int frame;
+	int r;
+	int c;
+	
+	if(argc < 2) {
+		printf("usage: %s <config>\n", argv[0]);
+		return 1;
+	}
+	if(!camera_open(LOW_RES) || !camera_load_config(argv[1])) return 1;
+	
+	for(frame = 0; frame < FRAMES; ++frame) {
+		if(!camera_update()) continue;
+		
+		start = seconds_monotonic();
+		if(!get_channel_occupancy(0, COLUMNS, ROWS, cells)) return 1;
+		get_channel_area_in_rect(0, create_rectangle(40, 30, 80, 60));
+		grid += seconds_monotonic() - start;
+		
+		start = seconds_monotonic();
+		get_object_count(0);
+		blobs += seconds_monotonic() - start;
+	}
+	camera_close();
+	
+	for(r = 0; r < ROWS; ++r) {
+		for(c = 0; c < COLUMNS; ++c) printf("%5.2f ", cells[r * COLUMNS + c]);
+		printf("\n");
+	}
+	printf("grid: %.2f ms/frame, objects: %.2f ms/frame\n",
+		1000.0 * grid / FRAMES, 1000.0 * blobs / FRAMES);
+	return 0;
+}
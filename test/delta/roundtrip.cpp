@@ -0,0 +1,86 @@
+#include "delta_p.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Private;
+
+static unsigned s_failures = 0;
+
+static void check(const bool ok, const char *const what)
+{
+	if(ok) return;
+	printf("FAIL: %s\n", what);
+	++s_failures;
+}
+
+// Encodes current against base, decodes it again and compares
+static size_t roundTrip(const State &base, const State &current, const char *const what)
+{
+	unsigned char buffer[STATE_DELTA_MAX_SIZE];
+	const size_t size = StateDelta::encode(base, current, buffer, sizeof(buffer));
+	
+	State decoded;
+	memset(&decoded, 0xAA, sizeof(State));
+	check(StateDelta::decode(base, buffer, size, decoded), what);
+	check(memcmp(&decoded, &current, sizeof(State)) == 0, what);
+	return size;
+}
+
+static void fill(State &state, const unsigned short seed)
+{
+	for(unsigned i = 0; i < TOTAL_REGS; ++i) state.t[i] = seed + i * 31;
+}
+
+int main()
+{
+	State base;
+	State current;
+	fill(base, 7);
+	
+	// Nothing changed
+	memcpy(&current, &base, sizeof(State));
+	check(roundTrip(base, current, "empty delta") == 0, "empty delta is zero bytes");
+	
+	// Every register changed
+	for(unsigned i = 0; i < TOTAL_REGS; ++i) current.t[i] = ~base.t[i];
+	const size_t full = roundTrip(base, current, "full-state delta");
+	check(full <= STATE_DELTA_MAX_SIZE, "full-state delta fits");
+	unsigned char small[16];
+	check(StateDelta::encode(base, current, small, sizeof(small)) == 0, "full-state delta into a small buffer");
+	
+	// Unchanged and changed runs longer than one count can hold
+	memcpy(&current, &base, sizeof(State));
+	for(unsigned i = TOTAL_REGS / 2; i < TOTAL_REGS; ++i) current.t[i] ^= 0x8001;
+	roundTrip(base, current, "long runs");
+	
+	memcpy(&current, &base, sizeof(State));
+	current.t[TOTAL_REGS - 1] ^= 1;
+	roundTrip(base, current, "last register only");
+	
+	// Runs of every length around the limit
+	srand(1);
+	for(unsigned n = 0; n < 1000; ++n) {
+		memcpy(&current, &base, sizeof(State));
+		unsigned i = rand() % (STATE_DELTA_MAX_RUN * 2 + 2);
+		while(i < TOTAL_REGS) {
+			const unsigned changed = 1 + rand() % (STATE_DELTA_MAX_RUN * 2 + 1);
+			for(unsigned j = 0; j < changed && i < TOTAL_REGS; ++j, ++i) current.t[i] ^= 1 + rand() % 0xFFFF;
+			i += rand() % (STATE_DELTA_MAX_RUN * 2 + 2);
+		}
+		roundTrip(base, current, "random runs");
+	}
+	
+	// Malformed deltas leave the state alone
+	const unsigned char truncated[] = { 0, 2, 0x01 };
+	memcpy(&current, &base, sizeof(State));
+	check(!StateDelta::decode(base, truncated, sizeof(truncated), current), "truncated delta is rejected");
+	const unsigned char overrun[] = { TOTAL_REGS - 1, 2, 0, 0, 0, 0 };
+	check(!StateDelta::decode(base, overrun, sizeof(overrun), current), "delta past the last register is rejected");
+	check(memcmp(&current, &base, sizeof(State)) == 0, "rejected delta leaves the state alone");
+	
+	if(s_failures) return EXIT_FAILURE;
+	printf("StateDelta round trips passed (runs of up to %d)\n", STATE_DELTA_MAX_RUN);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Drives a square of straight lines and turns, then an arc and a move that
+// can't finish before its deadline. Run against kovan-sim or on a robot
+// with motors 0 and 3 driving 56 mm wheels 150 mm apart.
+
+#define TICKS_PER_REVOLUTION 1100.0
+#define WHEEL_DIAMETER 56.0
+
+static const char *status_name(int status)
+{
+	switch(status) {
+	case DRIVE_RUNNING: return "running";
+	case DRIVE_DONE: return "done";
+	case DRIVE_TIMED_OUT: return "timed out";
+	case DRIVE_CANCELLED: return "cancelled";
+	case DRIVE_STALLED: return "stalled";
+	case DRIVE_UNSETTLED: return "unsettled";
+	}
+	return "?";
+}
+
+static void run(const char *name, drive_move move)
+{
+	const double start = seconds_monotonic();
+	const int left = get_motor_position_counter(0);
+	const int right = get_motor_position_counter(3);
+	const double mm = WHEEL_DIAMETER * 3.14159265 / TICKS_PER_REVOLUTION;
+	const int status = drive_wait(move);
+	
+	printf("%-16s %-9s %6.0f ms, left %7.1f mm, right %7.1f mm\n", name, status_name(status),
+		(seconds_monotonic() - start) * 1000.0, (get_motor_position_counter(0) - left) * mm,
+		(get_motor_position_counter(3) - right) * mm);
+	drive_free(move);
+}
+
+int main(int argc, char *argv[])
+{
+	int i;
+	
+	drive_set_geometry(0, 3, WHEEL_DIAMETER, 150.0, TICKS_PER_REVOLUTION);
+	drive_set_limits(200.0, 400.0);
+	
+	for(i = 0; i < 4; ++i) {
+		run("drive 300 mm", drive_distance(300.0, 150.0, 0));
+		run("turn 90 degrees", turn_angle(90.0, 100.0, 0));
+	}
+	run("arc r=200 180", drive_arc(200.0, 180.0, 150.0, 0));
+	run("deadline 500 ms", drive_distance(1000.0, 150.0, 500));
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include <kovan/event_loop.hpp>
+#include <kovan/socket.hpp>
+#include <kovan/util.hpp>
+#include <cstdio>
+
+#define PORT 9123
+#define BURST 16
+
+// Sends a burst of datagrams to itself on every timer tick and drains
+// them in batches, reporting how many arrived per wakeup and how long
+// they sat in the kernel before being read.
+class Echo : public EventHandler
+{
+public:
+	Echo(Socket &socket)
+		: m_socket(socket),
+		m_out(BURST, 64),
+		m_in(BURST, 64),
+		m_timer(-1),
+		m_ticks(0),
+		m_wakeups(0),
+		m_received(0),
+		m_latency(0)
+	{
+	}
+	
+	void setTimer(const int timer)
+	{
+		m_timer = timer;
+	}
+	
+	virtual void event(EventLoop *const loop, const int fd, const unsigned events)
+	{
+		if(fd == m_timer) {
+			if(++m_ticks > 100) {
+				loop->quit();
+				return;
+			}
+			
+			const Address self("127.0.0.1", PORT);
+			m_out.clear();
+			for(int i = 0; i < BURST; ++i) m_out.append(&i, sizeof(i), self);
+			m_socket.sendBatch(m_out);
+			return;
+		}
+		
+		const int count = m_socket.recvBatch(m_in);
+		if(count <= 0) return;
+		
+		const unsigned long long now = Time::now();
+		for(int i = 0; i < count; ++i) {
+			if(m_in.timestamp(i)) m_latency += now - m_in.timestamp(i);
+		}
+		++m_wakeups;
+		m_received += count;
+	}
+	
+	void report() const
+	{
+		printf("%lu datagrams in %lu wakeups (%.1f per wakeup)\n", m_received, m_wakeups,
+			m_wakeups ? (double)m_received / m_wakeups : 0.0);
+		printf("mean time in socket buffer: %.1f us\n",
+			m_received ? m_latency / 1000.0 / m_received : 0.0);
+	}
+	
+private:
+	Socket &m_socket;
+	DatagramBatch m_out;
+	DatagramBatch m_in;
+	int m_timer;
+	unsigned long m_ticks;
+	unsigned long m_wakeups;
+	unsigned long m_received;
+	unsigned long long m_latency;
+};
+
+int main(int argc, char *argv[])
+{
+	Socket socket = Socket::udp();
+	if(!socket.bind(PORT) || !socket.setBlocking(false) || !socket.setTimestamping(true)) {
+		perror("socket");
+		return 1;
+	}
+	
+	EventLoop loop;
+	Echo echo(socket);
+	loop.add(socket, &echo);
+	echo.setTimer(loop.addTimer(10000000ULL, &echo));
+	loop.run();
+	
+	echo.report();
+	socket.close();
+	return 0;
+}
@@ -0,0 +1,51 @@
+#include <kovan/kovan.hpp>
+#include <cstdio>
+
+#define BURST 200
+
+// Compares what a burst of messages costs the caller when written directly
+// and through the log, then shows a busy call site being rate limited.
+
+static double directBurst(FILE *fp)
+{
+	const unsigned long long start = Time::now();
+	for(int i = 0; i < BURST; ++i) fprintf(fp, "direct: warning: message %d\n", i);
+	fflush(fp);
+	return Time::since(start) / 1000.0 / BURST;
+}
+
+static double loggedBurst()
+{
+	const unsigned long long start = Time::now();
+	for(int i = 0; i < BURST; ++i) Log::write(Log::Warning, "logged", "message %d", i);
+	const double perMessage = Time::since(start) / 1000.0 / BURST;
+	Log::flush();
+	return perMessage;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *const path = argc > 1 ? argv[1] : "log.txt";
+	FILE *const fp = fopen(path, "w");
+	if(!fp) {
+		perror(path);
+		return 1;
+	}
+	Log::setOutput(fp);
+	
+	printf("fprintf: %.2f us per message\n", directBurst(fp));
+	printf("Log::write: %.2f us per message\n", loggedBurst());
+	
+	Log::setOutput(stderr);
+	
+	// Only LOG_RATE_LIMIT of these get through each second
+	for(int i = 0; i < 50; ++i) {
+		KOVAN_LOG(Log::Warning, "busy loop iteration %d", i);
+		msleep(50);
+	}
+	Log::flush();
+	
+	printf("dropped: %lu\n", Log::dropped());
+	fclose(fp);
+	return 0;
+}
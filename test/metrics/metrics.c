@@ -0,0 +1,40 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+static const char *type_name(int type)
+{
+	switch(type) {
+	case METRIC_COUNTER: return "counter";
+	case METRIC_GAUGE: return "gauge";
+	case METRIC_HISTOGRAM: return "histogram";
+	}
+	return "?";
+}
+
+int main(int argc, char *argv[])
+{
+	int i;
+	int b;
+	
+	// Generate some traffic so there is something to report
+	for(i = 0; i < 20; ++i) {
+		motor(0, 50);
+		msleep(10);
+	}
+	ao();
+	
+	for(i = 0; i < metrics_count(); ++i) {
+		printf("%-28s %-9s %.0f\n", metric_name(i), type_name(metric_type(i)), metric_value(i));
+		if(metric_type(i) != METRIC_HISTOGRAM) continue;
+		for(b = 0; b < metric_histogram_buckets(i); ++b) {
+			if(b + 1 < metric_histogram_buckets(i)) printf("    <= %-8g %lu\n", metric_histogram_bound(i, b), metric_histogram_count(i, b));
+			else printf("    >  %-8g %lu\n", metric_histogram_bound(i, b - 1), metric_histogram_count(i, b));
+		}
+	}
+	
+	// Report as JSON twice a second for two seconds
+	metrics_start_dump("-", 1, 500);
+	msleep(2000);
+	metrics_stop_dump();
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include "microbench.hpp"
+
+#include <kovan/config.hpp>
+#include <kovan/create.hpp>
+#include <kovan/datalog.hpp>
+
+#include "kovan_command_p.hpp"
+#include "kovan_module_p.hpp"
+#include "bits_p.hpp"
+#include "delta_p.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+using namespace Private;
+
+static void createWriteCommandBench(const unsigned long iterations)
+{
+	unsigned long sum = 0;
+	for(unsigned long i = 0; i < iterations; ++i) {
+		const Command command = createWriteCommand(i & 0x3F, i);
+		sum += command.data[0];
+	}
+	benchmarkSink(sum);
+}
+BENCHMARK("command.createWriteCommand", createWriteCommandBench);
+
+// What Kovan::flush does before the packet goes out: a queue of writes plus
+// the state request, copied into a freshly allocated packet
+static void packetBuildBench(const unsigned long iterations)
+{
+	for(unsigned long i = 0; i < iterations; ++i) {
+		CommandVector commands;
+		for(unsigned short j = 0; j < 8; ++j) commands.push_back(createWriteCommand(j, i));
+		Command state;
+		state.type = StateCommandType;
+		commands.push_back(state);
+		
+		uint32_t size = 0;
+		Packet *const packet = KovanModule::createPacket(commands.size(), size);
+		memcpy(packet->commands, &commands[0], commands.size() * sizeof(Command));
+		benchmarkSink(packet->num);
+		free(packet);
+	}
+}
+BENCHMARK("command.buildPacket", packetBuildBench);
+
+static void bitsLeadingZerosBench(const unsigned long iterations)
+{
+	unsigned long sum = 0;
+	for(unsigned long i = 0; i < iterations; ++i) sum += Bits::leadingZeros(i * 2654435761U);
+	benchmarkSink(sum);
+}
+BENCHMARK("bits.leadingZeros", bitsLeadingZerosBench);
+
+static Config makeCameraConfig()
+{
+	Config config;
+	config.beginGroup("camera");
+	config.setValue("num_channels", 4);
+	for(int i = 0; i < 4; ++i) {
+		std::stringstream group;
+		group << "channel_" << i;
+		config.beginGroup(group.str());
+		config.setValue("type", "hsv");
+		config.setValue("th", 20);
+		config.setValue("ts", 255);
+		config.setValue("tv", 255);
+		config.setValue("bh", 0);
+		config.setValue("bs", 100);
+		config.setValue("bv", 100);
+		config.endGroup();
+	}
+	config.endGroup();
+	return config;
+}
+
+// The per-frame lookups HsvChannelImpl::findObjects does
+static void configLookupBench(const unsigned long iterations)
+{
+	Config config = makeCameraConfig();
+	config.beginGroup("camera");
+	config.beginGroup("channel_2");
+	
+	unsigned long sum = 0;
+	for(unsigned long i = 0; i < iterations; ++i) {
+		sum += config.intValue("th") + config.intValue("ts") + config.intValue("tv");
+		sum += config.intValue("bh") + config.intValue("bs") + config.intValue("bv");
+	}
+	benchmarkSink(sum);
+}
+BENCHMARK("config.intValue6", configLookupBench);
+
+static void dataLogAppendBench(const unsigned long iterations)
+{
+	DataLog log;
+	Category *const category = log.category("value");
+	for(unsigned long i = 0; i < iterations; ++i) category->append((double)i);
+	benchmarkSink(category->entries().size());
+}
+BENCHMARK("datalog.append", dataLogAppendBench);
+
+static void dataLogWriteBench(const unsigned long iterations)
+{
+	DataLog log;
+	Category *const a = log.category("a");
+	Category *const b = log.category("b");
+	for(int i = 0; i < 100; ++i) {
+		a->append((double)i);
+		b->append(i * 0.5);
+	}
+	
+	CsvWriter writer("/dev/null");
+	for(unsigned long i = 0; i < iterations; ++i) benchmarkSink(log.write(&writer));
+}
+BENCHMARK("datalog.writeCsv", dataLogWriteBench);
+
+static void createScriptBench(const unsigned long iterations)
+{
+	static const unsigned char drive[] = { 137, 0, 200, 128, 0 };
+	for(unsigned long i = 0; i < iterations; ++i) {
+		CreateScript script;
+		for(int j = 0; j < 8; ++j) {
+			script.append(drive, sizeof(drive));
+			script.append(155);
+			script.append(10);
+		}
+		CreateScript copy(script);
+		benchmarkSink(copy.size());
+	}
+}
+BENCHMARK("create.buildScript", createScriptBench);
+
+// A typical flush: a motor position counter, a few sensors and a button change
+static void touchState(State &state, const unsigned long i)
+{
+	state.t[3] = i;
+	state.t[4] = i >> 16;
+	state.t[20] ^= 1;
+	state.t[30] = i & 0x3FF;
+	state.t[31] = (i * 7) & 0x3FF;
+}
+
+static void deltaEncodeBench(const unsigned long iterations)
+{
+	State base;
+	State current;
+	memset(&base, 0, sizeof(State));
+	memset(&current, 0, sizeof(State));
+	
+	unsigned char out[STATE_DELTA_MAX_SIZE];
+	for(unsigned long i = 0; i < iterations; ++i) {
+		touchState(current, i);
+		benchmarkSink(StateDelta::encode(base, current, out, sizeof(out)));
+		memcpy(&base, &current, sizeof(State));
+	}
+}
+BENCHMARK("delta.encode", deltaEncodeBench);
+
+static void deltaDecodeBench(const unsigned long iterations)
+{
+	State base;
+	State current;
+	memset(&base, 0, sizeof(State));
+	memcpy(&current, &base, sizeof(State));
+	touchState(current, 12345);
+	
+	unsigned char delta[STATE_DELTA_MAX_SIZE];
+	const size_t length = StateDelta::encode(base, current, delta, sizeof(delta));
+	State decoded;
+	for(unsigned long i = 0; i < iterations; ++i) {
+		StateDelta::decode(base, delta, length, decoded);
+		benchmarkSink(decoded.t[3]);
+	}
+}
+BENCHMARK("delta.decode", deltaDecodeBench);
@@ -0,0 +1,223 @@
+#include "microbench.hpp"
+
+#include <kovan/util.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+
+// Runs every registered benchmark and reports ns/op and allocations/op.
+//
+//   kovan_microbench [-f filter] [-b baseline] [-w baseline] [-t tolerance]
+//
+// -b compares against a baseline file and exits with 1 if a benchmark
+// allocates more. ns/op depends on the machine, so its change is only shown
+// unless -t is given, which also fails benchmarks that got slower by more
+// than tolerance percent. Use -t with a baseline written on the same machine
+// by -w. Benchmark names must not contain spaces.
+
+#define MIN_RUN_TIME 200000000ULL // ns
+#define MEASURED_RUNS 3
+
+static unsigned long s_allocations = 0;
+
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING noexcept
+#else
+#define THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define THROWS_NOTHING throw()
+#endif
+
+void *operator new(size_t size) THROWS_BAD_ALLOC
+{
+	__sync_fetch_and_add(&s_allocations, 1);
+	void *const ret = malloc(size ? size : 1);
+	if(!ret) throw std::bad_alloc();
+	return ret;
+}
+
+void *operator new[](size_t size) THROWS_BAD_ALLOC
+{
+	return operator new(size);
+}
+
+void operator delete(void *ptr) THROWS_NOTHING
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) THROWS_NOTHING
+{
+	free(ptr);
+}
+
+static Benchmark *s_first = 0;
+static Benchmark *s_last = 0;
+static volatile unsigned long s_sink = 0;
+
+Benchmark::Benchmark(const char *const name, BenchmarkFunction function)
+	: m_name(name),
+	m_function(function),
+	m_next(0)
+{
+	// Keep registration order so related benchmarks are listed together
+	if(s_last) s_last->m_next = this;
+	else s_first = this;
+	s_last = this;
+}
+
+const char *Benchmark::name() const
+{
+	return m_name;
+}
+
+BenchmarkFunction Benchmark::function() const
+{
+	return m_function;
+}
+
+Benchmark *Benchmark::next() const
+{
+	return m_next;
+}
+
+Benchmark *Benchmark::first()
+{
+	return s_first;
+}
+
+void benchmarkSink(const unsigned long value)
+{
+	s_sink += value;
+}
+
+struct Result
+{
+	double nsPerOp;
+	double allocsPerOp;
+};
+
+typedef std::map<std::string, Result> ResultMap;
+
+static Result run(const Benchmark *const benchmark)
+{
+	// Warm up, then grow the iteration count until a run is long enough to time
+	benchmark->function()(1);
+	
+	unsigned long iterations = 1;
+	unsigned long long elapsed = 0;
+	unsigned long allocations = 0;
+	for(;;) {
+		const unsigned long allocationsBefore = s_allocations;
+		const unsigned long long start = Time::now();
+		benchmark->function()(iterations);
+		elapsed = Time::since(start);
+		allocations = s_allocations - allocationsBefore;
+		
+		if(elapsed >= MIN_RUN_TIME) break;
+		iterations *= elapsed ? std::min(100ULL, MIN_RUN_TIME * 2 / elapsed + 1) : 100;
+	}
+	
+	// Report the fastest of a few runs; slower ones mostly measure other load
+	for(int i = 1; i < MEASURED_RUNS; ++i) {
+		const unsigned long long start = Time::now();
+		benchmark->function()(iterations);
+		elapsed = std::min(elapsed, Time::since(start));
+	}
+	
+	Result ret;
+	ret.nsPerOp = (double)elapsed / iterations;
+	ret.allocsPerOp = (double)allocations / iterations;
+	return ret;
+}
+
+static bool readBaseline(const char *const path, ResultMap &baseline)
+{
+	FILE *const fp = fopen(path, "r");
+	if(!fp) return false;
+	
+	char line[256];
+	char name[128];
+	Result result;
+	while(fgets(line, sizeof(line), fp)) {
+		if(line[0] == '#') continue;
+		if(sscanf(line, "%127s %lf %lf", name, &result.nsPerOp, &result.allocsPerOp) != 3) continue;
+		baseline[name] = result;
+	}
+	fclose(fp);
+	return true;
+}
+
+static bool writeBaseline(const char *const path, const ResultMap &results)
+{
+	FILE *const fp = fopen(path, "w");
+	if(!fp) return false;
+	
+	fprintf(fp, "# name ns/op allocs/op\n");
+	fprintf(fp, "# ns/op only compares meaningfully on the machine that wrote this file\n");
+	for(ResultMap::const_iterator it = results.begin(); it != results.end(); ++it) {
+		fprintf(fp, "%s %.2f %.2f\n", it->first.c_str(), it->second.nsPerOp, it->second.allocsPerOp);
+	}
+	return fclose(fp) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filter = 0;
+	const char *baselinePath = 0;
+	const char *writePath = 0;
+	double tolerance = -1.0; // ns/op is informational unless set
+	
+	for(int i = 1; i < argc; ++i) {
+		if(!strcmp(argv[i], "-f") && i + 1 < argc) filter = argv[++i];
+		else if(!strcmp(argv[i], "-b") && i + 1 < argc) baselinePath = argv[++i];
+		else if(!strcmp(argv[i], "-w") && i + 1 < argc) writePath = argv[++i];
+		else if(!strcmp(argv[i], "-t") && i + 1 < argc) tolerance = atof(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [-f filter] [-b baseline] [-w baseline] [-t tolerance]\n", argv[0]);
+			return 2;
+		}
+	}
+	
+	ResultMap baseline;
+	if(baselinePath && !readBaseline(baselinePath, baseline)) {
+		perror(baselinePath);
+		return 2;
+	}
+	
+	ResultMap results;
+	bool regressed = false;
+	printf("%-32s %12s %10s %12s %8s\n", "benchmark", "ns/op", "allocs/op", "baseline", "change");
+	for(const Benchmark *benchmark = Benchmark::first(); benchmark; benchmark = benchmark->next()) {
+		if(filter && !strstr(benchmark->name(), filter)) continue;
+		
+		const Result result = run(benchmark);
+		results[benchmark->name()] = result;
+		printf("%-32s %12.2f %10.2f", benchmark->name(), result.nsPerOp, result.allocsPerOp);
+		
+		ResultMap::const_iterator it = baseline.find(benchmark->name());
+		if(it == baseline.end()) {
+			printf("\n");
+			continue;
+		}
+		
+		const double change = (result.nsPerOp / it->second.nsPerOp - 1.0) * 100.0;
+		const bool slower = tolerance >= 0.0 && change > tolerance;
+		const bool allocates = result.allocsPerOp > it->second.allocsPerOp + 0.01;
+		printf(" %12.2f %+7.1f%%%s%s\n", it->second.nsPerOp, change,
+			slower ? " SLOWER" : "", allocates ? " MORE ALLOCS" : "");
+		regressed |= slower || allocates;
+	}
+	
+	if(writePath && !writeBaseline(writePath, results)) {
+		perror(writePath);
+		return 2;
+	}
+	
+	return regressed ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+#ifndef _MICROBENCH_HPP_
+#define _MICROBENCH_HPP_
+
+// Benchmarks are plain functions that run their operation iterations times.
+// They register themselves through a static Benchmark, so each source file
+// only has to be linked in to be run.
+
+typedef void (*BenchmarkFunction)(const unsigned long iterations);
+
+class Benchmark
+{
+public:
+	Benchmark(const char *const name, BenchmarkFunction function);
+	
+	const char *name() const;
+	BenchmarkFunction function() const;
+	Benchmark *next() const;
+	
+	static Benchmark *first();
+	
+private:
+	const char *m_name;
+	BenchmarkFunction m_function;
+	Benchmark *m_next;
+};
+
+// Keeps the compiler from optimizing away results nobody reads
+void benchmarkSink(const unsigned long value);
+
+#define BENCHMARK(name, function) static Benchmark __benchmark_##function(name, function)
+
+#endif
@@ -0,0 +1,101 @@
+#include "microbench.hpp"
+
+#include <kovan/camera.hpp>
+#include <kovan/config.hpp>
+
+#include "channel_p.hpp"
+#include "uvlc_video_decoder_p.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Private;
+
+// A 320x240 BGR frame with a few orange blobs on a gray background
+static cv::Mat syntheticFrame()
+{
+	cv::Mat frame(240, 320, CV_8UC3, cv::Scalar(128, 128, 128));
+	for(int i = 0; i < 6; ++i) {
+		const cv::Point center(30 + i * 50, 60 + (i % 3) * 60);
+		cv::circle(frame, center, 8 + i * 2, cv::Scalar(0, 128, 255), -1);
+	}
+	return frame;
+}
+
+static Config orangeConfig()
+{
+	Config config;
+	config.setValue("th", 20);
+	config.setValue("ts", 255);
+	config.setValue("tv", 255);
+	config.setValue("bh", 5);
+	config.setValue("bs", 100);
+	config.setValue("bv", 100);
+	return config;
+}
+
+static void hsvClassifyBench(const unsigned long iterations)
+{
+	const cv::Mat frame = syntheticFrame();
+	cv::Mat hsv;
+	cv::Mat mask;
+	for(unsigned long i = 0; i < iterations; ++i) {
+		cv::cvtColor(frame, hsv, CV_BGR2HSV);
+		cv::inRange(hsv, cv::Scalar(5, 100, 100), cv::Scalar(20, 255, 255), mask);
+		benchmarkSink(mask.data[0]);
+	}
+}
+BENCHMARK("vision.hsvClassify", hsvClassifyBench);
+
+// HsvChannelImpl end to end: conversion, thresholding and contours to objects
+static void hsvBlobsBench(const unsigned long iterations)
+{
+	const cv::Mat frame = syntheticFrame();
+	const Config config = orangeConfig();
+	Private::Camera::HsvChannelImpl impl;
+	for(unsigned long i = 0; i < iterations; ++i) {
+		impl.setImage(frame);
+		benchmarkSink(impl.objects(config).size());
+	}
+}
+BENCHMARK("vision.hsvBlobs", hsvBlobsBench);
+
+// UVLC frames have to come from a real drone. KOVAN_UVLC_FRAMES names a file
+// of frames, each prefixed by its length as a native 32-bit integer.
+static std::vector<std::vector<unsigned char> > s_frames;
+
+static void uvlcDecodeBench(const unsigned long iterations)
+{
+	UvlcVideoDecoder decoder;
+	cv::Mat image;
+	for(unsigned long i = 0; i < iterations; ++i) {
+		const std::vector<unsigned char> &frame = s_frames[i % s_frames.size()];
+		benchmarkSink(decoder.decode(&frame[0], frame.size(), image));
+	}
+}
+
+static bool loadFrames()
+{
+	const char *const path = getenv("KOVAN_UVLC_FRAMES");
+	if(!path) return false;
+	
+	FILE *const fp = fopen(path, "rb");
+	if(!fp) return false;
+	
+	unsigned int length = 0;
+	while(fread(&length, sizeof(length), 1, fp) == 1 && length) {
+		std::vector<unsigned char> frame(length);
+		if(fread(&frame[0], 1, length, fp) != length) break;
+		s_frames.push_back(frame);
+	}
+	fclose(fp);
+	
+	if(s_frames.empty()) return false;
+	static Benchmark benchmark("vision.uvlcDecode", uvlcDecodeBench);
+	return true;
+}
+static const bool s_framesLoaded = loadFrames();
@@ -0,0 +1,34 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+static volatile int fast_count = 0;
+static volatile int slow_count = 0;
+
+void fast()
+{
+	++fast_count;
+}
+
+void slow()
+{
+	// Sleeps past its own 20 ms period every fifth call to show overruns
+	++slow_count;
+	if(slow_count % 5 == 0) msleep(30);
+}
+
+int main(int argc, char *argv[])
+{
+	periodic f = run_every(2, fast);
+	periodic s = run_every(20, slow);
+	
+	msleep(2000);
+	
+	printf("fast task (2 ms):\n");
+	periodic_print_stats(f);
+	printf("slow task (20 ms):\n");
+	periodic_print_stats(s);
+	
+	periodic_stop(f);
+	periodic_stop(s);
+	return 0;
+}
@@ -0,0 +1,52 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Publishes to several boards one at a time and then all at once, and
+// reports the rounds per second of each. Pass the boards' addresses, or
+// start kovan-sim -p 4700 through -p 4703 to use the defaults.
+
+#define MAX_BOARDS 16
+#define SERVO_COMMAND_0 25
+
+static board boards[MAX_BOARDS];
+
+static void measure(int count, int together)
+{
+	const int rounds = 200;
+	double start;
+	int i;
+	int b;
+	
+	start = seconds_monotonic();
+	for(i = 0; i < rounds; ++i) {
+		for(b = 0; b < count; ++b) board_set_register(boards[b], SERVO_COMMAND_0, i);
+		if(together) boards_publish();
+		else for(b = 0; b < count; ++b) board_publish(boards[b]);
+	}
+	
+	printf("%d boards, %-12s %6.0f rounds/s\n", count, together ? "together" : "one at a time",
+		rounds / (seconds_monotonic() - start));
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *defaults[] = { "127.0.0.1:4700", "127.0.0.1:4701", "127.0.0.1:4702", "127.0.0.1:4703" };
+	const char **addresses = argc > 1 ? (const char **)argv + 1 : defaults;
+	const int count = argc > 1 ? argc - 1 : 4;
+	int b;
+	
+	if(count > MAX_BOARDS) return 1;
+	for(b = 0; b < count; ++b) {
+		boards[b] = board_open(addresses[b]);
+		if(!boards[b].data) {
+			printf("Can't open %s\n", addresses[b]);
+			return 1;
+		}
+	}
+	
+	measure(count, 0);
+	measure(count, 1);
+	
+	for(b = 0; b < count; ++b) board_close(boards[b]);
+	return 0;
+}
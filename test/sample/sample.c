@@ -0,0 +1,41 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Follows a running motor's position counter for a second while
+// subscribed, and counts how many reads brought a new refresh and how
+// old each new value was. Run against kovan-sim or on a Kovan.
+
+int main(int argc, char *argv[])
+{
+	sensor_sample sample;
+	unsigned long seq = 0;
+	int reads = 0;
+	int fresh = 0;
+	double age = 0.0;
+	double start;
+	
+	if(!subscribe_state(100, 0)) {
+		printf("subscriptions not supported\n");
+		return 1;
+	}
+	
+	motor(0, 50);
+	start = seconds_monotonic();
+	while(seconds_monotonic() - start < 1.0) {
+		if(!get_motor_position_counter_sample(0, &sample)) break;
+		++reads;
+		if(sample.seq != seq) {
+			seq = sample.seq;
+			++fresh;
+			age += seconds_monotonic() - sample.timestamp / 1e9;
+		}
+		msleep(1);
+	}
+	off(0);
+	unsubscribe_state();
+	
+	printf("%d reads, %d new values, %.2f ms average age\n", reads, fresh,
+		fresh ? 1000.0 * age / fresh : 0.0);
+	printf("last: %d at seq %lu\n", sample.value, sample.seq);
+	return 0;
+}
@@ -0,0 +1,29 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Drives motor 0 into a hard stop and reports how long bmd() took to give
+// up. Run against kovan-sim -s 1000, or on a Kovan with the motor blocked.
+
+int main(int argc, char *argv[])
+{
+	double start;
+	
+	set_motor_stall_time(0, 300);
+	clear_motor_position_counter(0);
+	
+	start = seconds_monotonic();
+	mtp(0, 1000, 5000);
+	bmd(0);
+	
+	printf("bmd returned after %.0f ms at position %d, stalled %d, %.0f stalls counted\n",
+		(seconds_monotonic() - start) * 1000.0, get_motor_position_counter(0),
+		get_motor_stalled(0), metric_value_by_name("motor.stalls"));
+	
+	// An unobstructed move completes normally
+	start = seconds_monotonic();
+	mtp(0, 1000, 0);
+	bmd(0);
+	printf("return move took %.0f ms, stalled %d\n", (seconds_monotonic() - start) * 1000.0,
+		get_motor_stalled(0));
+	return 0;
+}
@@ -0,0 +1,20 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Touches a few subsystems and prints how long each took to initialize.
+// Nothing is set up until it is first used, so the order below is the
+// order the times are spent in.
+
+int main(int argc, char *argv[])
+{
+	double start = seconds_monotonic();
+	printf("analog(0) = %d\n", analog(0));
+	printf("first sensor read: %.2f ms\n", (seconds_monotonic() - start) * 1000.0);
+	
+	start = seconds_monotonic();
+	printf("accel_x() = %d\n", accel_x());
+	printf("first accelerometer read: %.2f ms\n", (seconds_monotonic() - start) * 1000.0);
+	
+	print_startup_profile();
+	return 0;
+}
@@ -0,0 +1,57 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define RUNS 50
+
+// Measures how long it takes to start a program linked against libkovan and
+// how much memory it has resident once it is running. Build it against
+// kovan-core and against kovan-vision to compare the two.
+
+#ifdef STARTUP_VISION
+static void *volatile s_used = (void *)camera_update;
+#else
+static void *volatile s_used = (void *)seconds_monotonic;
+#endif
+
+static long resident_kb()
+{
+	char line[128];
+	long kb = -1;
+	FILE *fp = fopen("/proc/self/status", "r");
+	if(!fp) return -1;
+	while(fgets(line, sizeof(line), fp)) {
+		if(strncmp(line, "VmRSS:", 6) == 0) {
+			kb = atol(line + 6);
+			break;
+		}
+	}
+	fclose(fp);
+	return kb;
+}
+
+int main(int argc, char *argv[])
+{
+	double start;
+	int i;
+	
+	if(argc > 1 && strcmp(argv[1], "--child") == 0) return s_used ? 0 : 1;
+	
+	start = seconds_monotonic();
+	for(i = 0; i < RUNS; ++i) {
+		int status = 0;
+		pid_t pid = fork();
+		if(pid == 0) {
+			execl(argv[0], argv[0], "--child", (char *)0);
+			_exit(1);
+		}
+		waitpid(pid, &status, 0);
+	}
+	
+	printf("startup: %.2f ms\n", (seconds_monotonic() - start) * 1000.0 / RUNS);
+	printf("resident: %ld kB\n", resident_kb());
+	return 0;
+}
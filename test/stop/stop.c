@@ -0,0 +1,56 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Compares the per-port stop sequence freeze_halt() used to run against
+// the single priority packet it sends now. Run against kovan-sim or a
+// Kovan; each stop is timed after all four motors have been started.
+
+static void start_motors()
+{
+	int i;
+	for(i = 0; i < 4; ++i) motor(i, 100);
+	msleep(50);
+}
+
+static void legacy_freeze_halt()
+{
+	int i;
+	for(i = 0; i < 4; ++i) off(i);
+	for(i = 0; i < 8; ++i) set_analog_pullup(i, 1);
+	for(i = 8; i < 16; ++i) {
+		set_digital_output(i, 0);
+		set_digital_pullup(i, 1);
+	}
+	// The legacy sequence only reaches the daemon on the next flush
+	publish();
+}
+
+static void measure(const char *name, void (*stop)())
+{
+	const int runs = 20;
+	double total = 0.0;
+	double packets = 0.0;
+	double start;
+	double sent;
+	int i;
+	
+	for(i = 0; i < runs; ++i) {
+		start_motors();
+		sent = metric_value_by_name("kovan.packets_sent");
+		start = seconds_monotonic();
+		stop();
+		total += seconds_monotonic() - start;
+		packets += metric_value_by_name("kovan.packets_sent") - sent;
+	}
+	
+	printf("%-20s %8.3f ms %6.1f packets\n", name, total / runs * 1000.0, packets / runs);
+}
+
+int main(int argc, char *argv[])
+{
+	measure("legacy freeze_halt", legacy_freeze_halt);
+	measure("ao", ao);
+	measure("freeze_halt", freeze_halt);
+	measure("halt", halt);
+	return 0;
+}
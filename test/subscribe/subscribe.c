@@ -0,0 +1,53 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Counts the packets needed to follow a running motor and to wait on a
+// sensor that doesn't change, first by polling and then with a state
+// subscription. Run against kovan-sim or on a Kovan.
+
+static void follow(const char *name)
+{
+	double start;
+	double packets;
+	double pushes;
+	int reads = 0;
+	
+	packets = metric_value_by_name("kovan.packets_sent");
+	pushes = metric_value_by_name("kovan.pushes");
+	motor(0, 50);
+	start = seconds_monotonic();
+	while(seconds_monotonic() - start < 1.0) {
+		get_motor_position_counter(0);
+		++reads;
+		msleep(1);
+	}
+	off(0);
+	printf("%-12s moving: %5d reads, %5.0f packets, %5.0f pushes\n", name, reads,
+		metric_value_by_name("kovan.packets_sent") - packets,
+		metric_value_by_name("kovan.pushes") - pushes);
+	
+	msleep(50);
+	packets = metric_value_by_name("kovan.packets_sent");
+	pushes = metric_value_by_name("kovan.pushes");
+	start = seconds_monotonic();
+	while(seconds_monotonic() - start < 1.0) {
+		analog10(0);
+		msleep(1);
+	}
+	printf("%-12s idle:   %5.0f packets, %5.0f pushes\n", name,
+		metric_value_by_name("kovan.packets_sent") - packets,
+		metric_value_by_name("kovan.pushes") - pushes);
+}
+
+int main(int argc, char *argv[])
+{
+	follow("polling");
+	
+	if(!subscribe_state(100, 1)) {
+		printf("subscriptions not supported\n");
+		return 1;
+	}
+	follow("subscribed");
+	unsubscribe_state();
+	return 0;
+}
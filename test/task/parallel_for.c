@@ -0,0 +1,41 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+#define COUNT 4000000
+
+static double values[COUNT];
+
+void fill(int begin, int end, void *arg)
+{
+	int i;
+	(void)arg;
+	for(i = begin; i < end; ++i) values[i] = i * 0.5;
+}
+
+void hello(void *arg)
+{
+	printf("Hello from task %d\n", *(int *)arg);
+}
+
+int main(int argc, char *argv[])
+{
+	int ids[4] = { 0, 1, 2, 3 };
+	task tasks[4];
+	int i;
+	double start;
+	
+	printf("Running on %d worker(s)\n", task_worker_count());
+	
+	for(i = 0; i < 4; ++i) tasks[i] = task_submit(hello, &ids[i]);
+	for(i = 0; i < 4; ++i) task_destroy(tasks[i]);
+	
+	start = seconds();
+	fill(0, COUNT, 0);
+	printf("serial fill: %f s\n", seconds() - start);
+	
+	start = seconds();
+	parallel_for(0, COUNT, 0, fill, 0);
+	printf("parallel_for fill: %f s\n", seconds() - start);
+	
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+#include <time.h>
+
+#define PERIOD_NS 1000000L
+#define ITERATIONS 2000
+#define HOGS 2
+
+static volatile int running = 1;
+static long worst_ns;
+static double average_ns;
+
+static long elapsed_ns(const struct timespec *a, const struct timespec *b)
+{
+	return (b->tv_sec - a->tv_sec) * 1000000000L + (b->tv_nsec - a->tv_nsec);
+}
+
+void control_loop()
+{
+	struct timespec deadline;
+	struct timespec now;
+	long late;
+	double total = 0.0;
+	int i;
+	
+	worst_ns = 0;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	for(i = 0; i < ITERATIONS; ++i) {
+		deadline.tv_nsec += PERIOD_NS;
+		if(deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_nsec -= 1000000000L;
+			++deadline.tv_sec;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, 0);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		late = elapsed_ns(&deadline, &now);
+		total += late;
+		if(late > worst_ns) worst_ns = late;
+	}
+	average_ns = total / ITERATIONS;
+}
+
+void hog()
+{
+	volatile unsigned long x = 0;
+	while(running) ++x;
+}
+
+static void measure(const char *name, int policy, int priority)
+{
+	thread t = thread_create(control_loop);
+	thread_set_priority(t, policy, priority);
+	thread_start(t);
+	thread_wait(t);
+	thread_destroy(t);
+	printf("%-10s average wakeup latency: %8.1f us, worst: %8.1f us\n",
+		name, average_ns / 1000.0, worst_ns / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+	thread hogs[HOGS];
+	int i;
+	
+	// Keep every CPU busy so the scheduler has to choose
+	for(i = 0; i < HOGS; ++i) {
+		hogs[i] = thread_create(hog);
+		thread_start(hogs[i]);
+	}
+	
+	measure("default", THREAD_POLICY_DEFAULT, 0);
+	
+	lock_memory();
+	measure("SCHED_FIFO", THREAD_POLICY_FIFO, 80);
+	
+	running = 0;
+	for(i = 0; i < HOGS; ++i) {
+		thread_wait(hogs[i]);
+		thread_destroy(hogs[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,35 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+#define ITEMS 20
+
+static queue work;
+
+void producer()
+{
+	long i;
+	for(i = 1; i <= ITEMS; ++i) {
+		queue_push(work, (void *)i);
+		msleep(100);
+	}
+	queue_push(work, 0);
+}
+
+int main(int argc, char *argv[])
+{
+	thread t;
+	void *item;
+	
+	work = queue_create(16);
+	t = thread_create(producer);
+	thread_start(t);
+	
+	// queue_pop sleeps until the producer hands something over,
+	// so this loop uses no CPU while waiting.
+	while((item = queue_pop(work))) printf("Consumed %ld\n", (long)item);
+	
+	thread_wait(t);
+	thread_destroy(t);
+	queue_destroy(work);
+	return 0;
+}
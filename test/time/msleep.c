@@ -4,10 +4,10 @@
 int main(int argc, char *argv[])
 {
 	const static unsigned long diff = 12341UL;
-	const double start = seconds();
+	const double start = seconds_monotonic();
 	msleep(diff);
-	const double end = seconds();
-	printf("Expected diff = %lu, actual diff = %lu\n", diff, (unsigned long)((end - start) * 1000.0));
+	const double end = seconds_monotonic();
+	printf("Expected diff = %lu, actual diff = %.3f\n", diff, (end - start) * 1000.0);
 	
 	return 0;
 }
\ No newline at end of file
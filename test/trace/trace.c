@@ -0,0 +1,49 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+#define ITERATIONS 1000000
+
+// Records spans from a loop and a periodic task, measures what an idle and
+// an active span cost, and writes trace.json for chrome://tracing.
+
+void tick()
+{
+	unsigned long long t = trace_begin();
+	msleep(1);
+	trace_end("tick", t);
+}
+
+static double span_cost()
+{
+	double start = seconds_monotonic();
+	int i;
+	for(i = 0; i < ITERATIONS; ++i) trace_end("cost", trace_begin());
+	return (seconds_monotonic() - start) * 1e9 / ITERATIONS;
+}
+
+int main(int argc, char *argv[])
+{
+	periodic p;
+	int i;
+	
+	printf("idle span: %.1f ns\n", span_cost());
+	trace_enable(1);
+	printf("recording span: %.1f ns\n", span_cost());
+	trace_clear();
+	
+	p = run_every(10, tick);
+	for(i = 0; i < 50; ++i) {
+		unsigned long long t = trace_begin();
+		msleep(5);
+		trace_end("main loop", t);
+	}
+	periodic_stop(p);
+	
+	trace_enable(0);
+	if(!trace_dump("trace.json")) {
+		printf("Failed to write trace.json\n");
+		return 1;
+	}
+	printf("Wrote trace.json\n");
+	return 0;
+}
@@ -0,0 +1,37 @@
+#include <kovan/kovan.h>
+#include <stdio.h>
+
+// Streams a servo sweep with different publish windows and reports how many
+// writes per second get through. Run against kovan-sim -l 1000 to see the
+// effect of latency, or on a Kovan.
+
+static void stream(int window)
+{
+	const int writes = 500;
+	double start;
+	double elapsed;
+	int i;
+	
+	if(!set_publish_window(window)) {
+		printf("window %2d not supported\n", window);
+		return;
+	}
+	
+	start = seconds_monotonic();
+	for(i = 0; i < writes; ++i) set_servo_position(0, i % 2048);
+	publish_and_wait();
+	elapsed = seconds_monotonic() - start;
+	
+	printf("window %2d %8.0f writes/s, last position %d\n", window, writes / elapsed,
+		get_servo_position(0));
+}
+
+int main(int argc, char *argv[])
+{
+	stream(1);
+	stream(4);
+	stream(16);
+	stream(64);
+	set_publish_window(1);
+	return 0;
+}
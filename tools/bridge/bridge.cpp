@@ -0,0 +1,162 @@
+#include "kovan_module_p.hpp"
+#include "bridge_p.hpp"
+#include "delta_p.hpp"
+
+#include <kovan/util.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unistd.h>
+
+// kovan-bridge runs on the board and lets libkovan programs on another
+// machine use it. Each request carries the commands of one flush. They are
+// forwarded to the local Kovan daemon, and the state that comes back is
+// returned as a delta against the newest state the client acknowledged.
+//
+//   kovan-bridge [-p port] [-v]
+
+#define CLIENT_TIMEOUT 60 // seconds
+
+using namespace Private;
+
+struct Client
+{
+	Client()
+		: nextId(1),
+		lastSeen(0)
+	{
+		memset(ids, 0, sizeof(ids));
+	}
+	
+	const State *find(const uint32_t id) const
+	{
+		if(!id) return 0;
+		for(int i = 0; i < BRIDGE_HISTORY; ++i) if(ids[i] == id) return &history[i];
+		return 0;
+	}
+	
+	uint32_t add(const State &state)
+	{
+		const uint32_t id = nextId++;
+		const int slot = id % BRIDGE_HISTORY;
+		ids[slot] = id;
+		memcpy(&history[slot], &state, sizeof(State));
+		return id;
+	}
+	
+	uint32_t nextId;
+	uint32_t ids[BRIDGE_HISTORY];
+	State history[BRIDGE_HISTORY];
+	double lastSeen;
+};
+
+typedef std::map<uint64_t, Client> ClientMap;
+
+static uint64_t clientKey(const sockaddr_in &addr)
+{
+	return ((uint64_t)addr.sin_addr.s_addr << 16) | addr.sin_port;
+}
+
+static void forgetIdleClients(ClientMap &clients, const double now)
+{
+	ClientMap::iterator it = clients.begin();
+	while(it != clients.end()) {
+		if(now - it->second.lastSeen > CLIENT_TIMEOUT) clients.erase(it++);
+		else ++it;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned short port = BRIDGE_PORT;
+	bool verbose = false;
+	for(int i = 1; i < argc; ++i) {
+		if(!strcmp(argv[i], "-p") && i + 1 < argc) port = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-v")) verbose = true;
+		else {
+			fprintf(stderr, "usage: %s [-p port] [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+	
+	KovanModule module(inet_addr("127.0.0.1"), htons(4628));
+	if(!module.init() || !module.bind(htonl(INADDR_ANY), htons(8374))) {
+		fprintf(stderr, "Failed to connect to the Kovan daemon\n");
+		return 1;
+	}
+	
+	const int sock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if(sock < 0 || bind(sock, (sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("bind");
+		return 1;
+	}
+	printf("kovan-bridge listening on port %u\n", port);
+	
+	const size_t maxRequestSize = bridgeRequestSize(BRIDGE_MAX_COMMANDS);
+	BridgeRequest *const request = reinterpret_cast<BridgeRequest *>(malloc(maxRequestSize));
+	BridgeReply reply;
+	ClientMap clients;
+	State zero;
+	memset(&zero, 0, sizeof(State));
+	
+	for(;;) {
+		sockaddr_in from;
+		socklen_t fromLength = sizeof(from);
+		const ssize_t size = recvfrom(sock, reinterpret_cast<char *>(request), maxRequestSize, 0,
+			(sockaddr *)&from, &fromLength);
+		if(size < 0) {
+			if(errno == EINTR) continue;
+			perror("recvfrom");
+			return 1;
+		}
+		if((size_t)size < bridgeRequestSize(0) || request->num > BRIDGE_MAX_COMMANDS
+			|| (size_t)size != bridgeRequestSize(request->num)) {
+			fprintf(stderr, "Dropping malformed request from %s\n", inet_ntoa(from.sin_addr));
+			continue;
+		}
+		
+		// The reply needs the state, so make sure the daemon sends it back
+		CommandVector commands(request->commands, request->commands + request->num);
+		if(commands.empty() || commands.back().type != StateCommandType) {
+			Command stateCommand;
+			memset(&stateCommand, 0, sizeof(Command));
+			stateCommand.type = StateCommandType;
+			commands.push_back(stateCommand);
+		}
+		
+		State state;
+		if(!module.send(commands) || !module.recv(state)) continue;
+		
+		const double now = Time::seconds();
+		forgetIdleClients(clients, now);
+		Client &client = clients[clientKey(from)];
+		client.lastSeen = now;
+		
+		const State *base = client.find(request->ackedState);
+		reply.base = base ? request->ackedState : 0;
+		if(!base) base = &zero;
+		
+		reply.seq = request->seq;
+		reply.state = client.add(state);
+		reply.length = StateDelta::encode(*base, state, reply.delta, sizeof(reply.delta));
+		reply.reserved = 0;
+		
+		const size_t replySize = bridgeReplySize(reply.length);
+		sendto(sock, reinterpret_cast<const char *>(&reply), replySize, 0, (sockaddr *)&from, fromLength);
+		
+		if(verbose) {
+			printf("%s: %u commands, state %u against %u, %lu bytes\n", inet_ntoa(from.sin_addr),
+				request->num, reply.state, reply.base, (unsigned long)replySize);
+		}
+	}
+	
+	return 0;
+}
@@ -0,0 +1,390 @@
+#include "kovan_command_p.hpp"
+#include "kovan_regs_p.hpp"
+#include "subscribe_p.hpp"
+
+#include <kovan/util.hpp>
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+// kovan-sim stands in for the Kovan daemon so libkovan programs can run on
+// a machine without the hardware. It keeps the register file, answers state
+// requests, and turns motor drive codes and PWM into back EMF counts.
+//
+//   kovan-sim [-p port] [-l latency_us] [-b battery] [-d drain] [-s ticks] [-v]
+//
+// -l delays every reply, to model the daemon and FPGA round trip. Replies
+// are delayed independently, so packets sent back to back overlap.
+// -b sets the battery reading and -d drains it by that much per second,
+// down to half. PWM motor speed is proportional to the battery.
+// -s puts a hard stop at +/- ticks on every motor, to provoke stalls.
+// -v prints every packet and when the motors start and stop.
+//
+// Subscribers get StatePush updates from a 1 ms tick, without reply latency.
+
+#define SIM_PORT 4628
+#define MAX_TICKS_PER_SECOND 1500.0
+#define FULL_PWM 2600.0
+#define SIM_TICK 0.001 // s
+
+using namespace Private;
+
+static volatile bool s_quit = false;
+
+static void quit(int)
+{
+	s_quit = true;
+}
+
+static const unsigned short bemfLow[4] = { BEMF_0_LOW, BEMF_1_LOW, BEMF_2_LOW, BEMF_3_LOW };
+static const unsigned short bemfHigh[4] = { BEMF_0_HIGH, BEMF_1_HIGH, BEMF_2_HIGH, BEMF_3_HIGH };
+static const unsigned short goalSpeedLow[4] = { GOAL_SPEED_0_LOW, GOAL_SPEED_1_LOW, GOAL_SPEED_2_LOW, GOAL_SPEED_3_LOW };
+static const unsigned short goalSpeedHigh[4] = { GOAL_SPEED_0_HIGH, GOAL_SPEED_1_HIGH, GOAL_SPEED_2_HIGH, GOAL_SPEED_3_HIGH };
+static const unsigned short goalPosLow[4] = { GOAL_POS_0_LOW, GOAL_POS_1_LOW, GOAL_POS_2_LOW, GOAL_POS_3_LOW };
+static const unsigned short goalPosHigh[4] = { GOAL_POS_0_HIGH, GOAL_POS_1_HIGH, GOAL_POS_2_HIGH, GOAL_POS_3_HIGH };
+
+class Simulator
+{
+public:
+	Simulator(const unsigned short battery, const double drain, const int hardStop)
+		: m_lastStep(Time::seconds()),
+		m_battery(battery),
+		m_fullBattery(battery),
+		m_drain(drain),
+		m_hardStop(hardStop)
+	{
+		memset(&m_state, 0, sizeof(State));
+		memset(m_position, 0, sizeof(m_position));
+		m_state.t[AN_IN_16] = battery;
+	}
+	
+	void write(const unsigned short addy, const unsigned short val)
+	{
+		if(addy < TOTAL_REGS) m_state.t[addy] = val;
+	}
+	
+	// Advances the motors to now. Returns true if any motor is moving.
+	bool step()
+	{
+		const double now = Time::seconds();
+		const double dt = now - m_lastStep;
+		m_lastStep = now;
+		
+		m_battery -= m_drain * dt;
+		if(m_battery < m_fullBattery / 2.0) m_battery = m_fullBattery / 2.0;
+		m_state.t[AN_IN_16] = (unsigned short)m_battery;
+		
+		bool moving = false;
+		for(int port = 0; port < 4; ++port) {
+			const unsigned short offset = (3 - port) << 1;
+			const unsigned mode = (m_state.t[PID_MODES] >> offset) & 0x3;
+			double speed = ticksPerSecond(port);
+			bool active = mode != 0;
+			
+			// Position modes drive toward the goal and stop there
+			if(mode == 1 || mode == 3) {
+				const double remaining = register32(goalPosLow[port], goalPosHigh[port]) - m_position[port];
+				if(speed == 0.0 || mode == 1) speed = MAX_TICKS_PER_SECOND;
+				speed = remaining < 0.0 ? -std::fabs(speed) : std::fabs(speed);
+				if(std::fabs(remaining) <= std::fabs(speed * dt)) {
+					speed = dt > 0.0 ? remaining / dt : 0.0;
+					active = false;
+				}
+			}
+			
+			moving |= speed != 0.0;
+			m_position[port] += speed * dt;
+			if(m_hardStop && m_position[port] > m_hardStop) m_position[port] = m_hardStop;
+			if(m_hardStop && m_position[port] < -m_hardStop) m_position[port] = -m_hardStop;
+			
+			if(active) m_state.t[PID_STATUS] |= 1 << (3 - port);
+			else m_state.t[PID_STATUS] &= ~(1 << (3 - port));
+			
+			const int ticks = (int)m_position[port];
+			m_state.t[bemfLow[port]] = ticks & 0xFFFF;
+			m_state.t[bemfHigh[port]] = (ticks >> 16) & 0xFFFF;
+		}
+		
+		for(int port = 0; port < 8; ++port) {
+			m_state.t[AN_IN_0 + port] = m_state.t[AN_PULLUPS] & (1 << port) ? 1023 : 0;
+		}
+		return moving;
+	}
+	
+	const State &state() const
+	{
+		return m_state;
+	}
+	
+private:
+	double ticksPerSecond(const int port) const
+	{
+		const unsigned short offset = (3 - port) << 1;
+		const unsigned mode = (m_state.t[PID_MODES] >> offset) & 0x3;
+		if(mode) return register32(goalSpeedLow[port], goalSpeedHigh[port]);
+		
+		const unsigned direction = (m_state.t[MOTOR_DRIVE_CODE_T] >> offset) & 0x3;
+		const double speed = m_state.t[MOTOR_PWM_0 + port] / FULL_PWM * MAX_TICKS_PER_SECOND
+			* m_battery / m_fullBattery;
+		if(direction == 2) return speed; // Forward
+		if(direction == 1) return -speed; // Reverse
+		return 0.0;
+	}
+	
+	int register32(const unsigned short low, const unsigned short high) const
+	{
+		return (int)((unsigned)m_state.t[high] << 16 | m_state.t[low]);
+	}
+	
+	State m_state;
+	double m_position[4];
+	double m_lastStep;
+	double m_battery;
+	double m_fullBattery;
+	double m_drain;
+	int m_hardStop;
+};
+
+struct Reply
+{
+	double due;
+	State state;
+	sockaddr_in to;
+	socklen_t toLength;
+};
+
+// Sends every reply that is due. Returns the seconds until the next one,
+// or -1 if there is none.
+static double sendReplies(const int sock, std::deque<Reply> &replies)
+{
+	while(!replies.empty()) {
+		const double wait = replies.front().due - Time::seconds();
+		if(wait > 0.0) return wait;
+		const Reply &reply = replies.front();
+		sendto(sock, &reply.state, sizeof(State), 0, (const sockaddr *)&reply.to, reply.toLength);
+		replies.pop_front();
+	}
+	return -1.0;
+}
+
+struct Subscriber
+{
+	sockaddr_in to;
+	socklen_t toLength;
+	SubscribeCommand subscription;
+	double lastPush;
+	double expires;
+	uint32_t seq;
+	State sent;
+};
+
+static bool sameAddress(const sockaddr_in &a, const sockaddr_in &b)
+{
+	return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+// Every subscribe, including a renewal, starts over with a full update
+static void subscribe(std::vector<Subscriber> &subscribers, const sockaddr_in &from,
+	const socklen_t fromLength, const SubscribeCommand &subscription)
+{
+	std::vector<Subscriber>::iterator it = subscribers.begin();
+	for(; it != subscribers.end() && !sameAddress(it->to, from); ++it);
+	if(!subscription.count || subscription.first + subscription.count > TOTAL_REGS) {
+		if(it != subscribers.end()) subscribers.erase(it);
+		return;
+	}
+	
+	if(it == subscribers.end()) it = subscribers.insert(subscribers.end(), Subscriber());
+	it->to = from;
+	it->toLength = fromLength;
+	it->subscription = subscription;
+	it->lastPush = 0.0;
+	it->expires = Time::seconds() + SUBSCRIBE_LEASE / 1000.0;
+	it->seq = 0;
+	memset(&it->sent, 0, sizeof(State));
+}
+
+// Returns the number of pushes sent
+static unsigned long push(const int sock, std::vector<Subscriber> &subscribers, const State &state)
+{
+	const double now = Time::seconds();
+	unsigned long pushes = 0;
+	
+	std::vector<Subscriber>::iterator it = subscribers.begin();
+	while(it != subscribers.end()) {
+		if(now > it->expires) {
+			it = subscribers.erase(it);
+			continue;
+		}
+		
+		const SubscribeCommand &subscription = it->subscription;
+		if(it->seq && now - it->lastPush < subscription.interval / 1000.0) {
+			++it;
+			continue;
+		}
+		
+		State current;
+		memset(&current, 0, sizeof(State));
+		memcpy(current.t + subscription.first, state.t + subscription.first,
+			subscription.count * sizeof(unsigned short));
+		if(it->seq && (subscription.flags & SubscribeChangesOnly)
+			&& !memcmp(&current, &it->sent, sizeof(State))) {
+			++it;
+			continue;
+		}
+		
+		State base;
+		if(it->seq) base = it->sent;
+		else memset(&base, 0, sizeof(State));
+		
+		StatePush update;
+		update.seq = ++it->seq;
+		update.reserved = 0;
+		update.length = StateDelta::encode(base, current, update.delta, sizeof(update.delta));
+		sendto(sock, &update, statePushSize(update.length), 0, (const sockaddr *)&it->to, it->toLength);
+		
+		it->sent = current;
+		it->lastPush = now;
+		++pushes;
+		++it;
+	}
+	return pushes;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned short port = SIM_PORT;
+	unsigned long latency = 0;
+	unsigned short battery = 800;
+	double drain = 0.0;
+	int hardStop = 0;
+	bool verbose = false;
+	for(int i = 1; i < argc; ++i) {
+		if(!strcmp(argv[i], "-p") && i + 1 < argc) port = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-l") && i + 1 < argc) latency = atol(argv[++i]);
+		else if(!strcmp(argv[i], "-b") && i + 1 < argc) battery = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-d") && i + 1 < argc) drain = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-s") && i + 1 < argc) hardStop = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-v")) verbose = true;
+		else {
+			fprintf(stderr, "usage: %s [-p port] [-l latency_us] [-b battery] [-d drain] [-s ticks] [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+	
+	const int sock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	addr.sin_port = htons(port);
+	if(sock < 0 || bind(sock, (sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("bind");
+		return 1;
+	}
+	
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = quit;
+	sigaction(SIGINT, &action, 0);
+	sigaction(SIGTERM, &action, 0);
+	
+	printf("kovan-sim listening on port %u\n", port);
+	
+	Simulator sim(battery, drain, hardStop);
+	unsigned char buffer[65536];
+	unsigned long packets = 0;
+	unsigned long writes = 0;
+	bool moving = false;
+	std::deque<Reply> replies;
+	std::vector<Subscriber> subscribers;
+	unsigned long pushes = 0;
+	
+	while(!s_quit) {
+		double wait = sendReplies(sock, replies);
+		if(!subscribers.empty() && (wait < 0.0 || wait > SIM_TICK)) wait = SIM_TICK;
+		if(wait > 0.0) {
+			fd_set readable;
+			FD_ZERO(&readable);
+			FD_SET(sock, &readable);
+			timeval tv;
+			tv.tv_sec = (long)wait;
+			tv.tv_usec = (long)((wait - tv.tv_sec) * 1000000.0) + 1;
+			if(select(sock + 1, &readable, 0, 0, &tv) <= 0) {
+				if(subscribers.empty()) continue;
+				sim.step();
+				pushes += push(sock, subscribers, sim.state());
+				continue;
+			}
+		}
+		
+		sockaddr_in from;
+		socklen_t fromLength = sizeof(from);
+		const ssize_t size = recvfrom(sock, buffer, sizeof(buffer), 0, (sockaddr *)&from, &fromLength);
+		if(size < 0) {
+			if(errno == EINTR) continue;
+			perror("recvfrom");
+			return 1;
+		}
+		
+		const Packet *const packet = reinterpret_cast<const Packet *>(buffer);
+		if((size_t)size < sizeof(Packet) || (size_t)size < sizeof(Packet) + (packet->num - 1) * sizeof(Command)) {
+			fprintf(stderr, "Dropping malformed packet\n");
+			continue;
+		}
+		++packets;
+		
+		// Motors run until the writes in this packet land
+		sim.step();
+		
+		bool wantsState = false;
+		unsigned packetWrites = 0;
+		for(unsigned short i = 0; i < packet->num; ++i) {
+			const Command &command = packet->commands[i];
+			if(command.type == StateCommandType) wantsState = true;
+			if(command.type == SubscribeCommandType) {
+				SubscribeCommand subscription;
+				memcpy(&subscription, command.data, sizeof(SubscribeCommand));
+				subscribe(subscribers, from, fromLength, subscription);
+				if(verbose) printf("%.6f subscribe %u registers from %u every %u ms\n", Time::seconds(),
+					subscription.count, subscription.first, subscription.interval);
+			}
+			if(command.type != WriteCommandType) continue;
+			WriteCommand write;
+			memcpy(&write, command.data, sizeof(WriteCommand));
+			sim.write(write.addy, write.val);
+			++packetWrites;
+		}
+		writes += packetWrites;
+		
+		const bool nowMoving = sim.step();
+		if(verbose) {
+			printf("%.6f packet %lu: %u commands, %u writes\n", Time::seconds(), packets, packet->num, packetWrites);
+			if(nowMoving != moving) printf("%.6f motors %s\n", Time::seconds(), nowMoving ? "started" : "stopped");
+		}
+		moving = nowMoving;
+		if(!subscribers.empty()) pushes += push(sock, subscribers, sim.state());
+		
+		if(!wantsState) continue;
+		Reply reply;
+		reply.due = Time::seconds() + latency / 1000000.0;
+		reply.state = sim.state();
+		reply.to = from;
+		reply.toLength = fromLength;
+		replies.push_back(reply);
+	}
+	
+	printf("%lu packets, %lu writes, %lu pushes\n", packets, writes, pushes);
+	return 0;
+}